@@ -39,8 +39,36 @@
 
 // #define ENABLE_MOTORS
 
+// #define ENABLE_STEP_TIMER
+
+// #define ENABLE_MOTION_QUEUE
+
+// #define ENABLE_COORDINATED_MOTION
+
+// #define ENABLE_SCURVE
+
+// #define ENABLE_INPUT_SHAPER
+
+// #define ENABLE_JOINT_COUPLING
+
+// #define ENABLE_PVT_STREAM
+
+// #define ENABLE_WRIST_TRANSFORM
+
+// #define ENABLE_KINEMATICS
+
+// #define ENABLE_LINEAR_MOVE
+
+// #define ENABLE_PS4_CARTESIAN
+
+// #define ENABLE_DRIVERS_BENCHMARK
+
 // #define ENABLE_LIMITS
 
+// #define ENABLE_LIMIT_LATCH
+
+// #define ENABLE_POSITION_JOURNAL
+
 // #define ENABLE_ESTOP
 
 // #define ENABLE_FEATURES_FLAGS
@@ -359,9 +387,385 @@
 #define M6_ACCEL DEFAULT_ACCEL
 #endif
 
+#if !defined(DEFAULT_JERK) 
+#define DEFAULT_JERK (DEFAULT_ACCEL * 4)
+#endif
+
+#if !defined(M1_JERK) 
+#define M1_JERK DEFAULT_JERK
+#endif
+
+#if !defined(M2_JERK) 
+#define M2_JERK DEFAULT_JERK
+#endif
+
+#if !defined(M3_JERK) 
+#define M3_JERK DEFAULT_JERK
+#endif
+
+#if !defined(M4_JERK) 
+#define M4_JERK DEFAULT_JERK
+#endif
+
+#if !defined(M5_JERK) 
+#define M5_JERK DEFAULT_JERK
+#endif
+
+#if !defined(M6_JERK) 
+#define M6_JERK DEFAULT_JERK
+#endif
+
+/**
+ * @brief Longest time step of the speed mode ramp, a late update does not jump the speed. [s]
+ *
+ */
+#define SPEED_RAMP_MAX_PERIOD 0.01F
+
 #endif			  // defined(ENABLE_MOTORS)
 #pragma endregion // Motors Parameters
 
+#pragma region Drivers Benchmark
+#if defined(ENABLE_DRIVERS_BENCHMARK)
+
+#if !defined(ENABLE_MOTORS)
+#error "ENABLE_DRIVERS_BENCHMARK requires ENABLE_MOTORS."
+#endif
+
+#if !defined(DRIVERS_BENCHMARK_COUNT)
+/**
+ * @brief Calls of update_drivers() per measurement.
+ *
+ */
+#define DRIVERS_BENCHMARK_COUNT 1000
+#endif
+
+#endif			  // defined(ENABLE_DRIVERS_BENCHMARK)
+#pragma endregion // Drivers Benchmark
+
+#pragma region Step Timer
+#if defined(ENABLE_STEP_TIMER)
+
+#if !defined(ENABLE_MOTORS)
+#error "ENABLE_STEP_TIMER requires ENABLE_MOTORS."
+#endif
+
+#if !defined(STEP_TIMER_ID)
+/**
+ * @brief Hardware timer used for the step generation.
+ *
+ */
+#define STEP_TIMER_ID 0
+#endif
+
+#if !defined(STEP_TIMER_PERIOD_US)
+/**
+ * @brief Step timer period, the shortest step interval. [us]
+ *
+ */
+#define STEP_TIMER_PERIOD_US 20
+#endif
+
+/**
+ * @brief Step timer frequency. [Hz]
+ *
+ */
+#define STEP_TIMER_FREQUENCY (1000000UL / STEP_TIMER_PERIOD_US)
+
+#endif			  // defined(ENABLE_STEP_TIMER)
+#pragma endregion // Step Timer
+
+#pragma region Motion Queue
+#if defined(ENABLE_MOTION_QUEUE)
+
+#if !defined(ENABLE_STEP_TIMER)
+#error "ENABLE_MOTION_QUEUE requires ENABLE_STEP_TIMER."
+#endif
+
+#if !defined(MOTION_QUEUE_SIZE)
+/**
+ * @brief Maximum number of queued segments.
+ *
+ */
+#define MOTION_QUEUE_SIZE 16
+#endif
+
+/**
+ * @brief SUPER operation code, queue one or more absolute segments.
+ *
+ */
+#define ENQUEUE_ABSOLUTE 22
+
+/**
+ * @brief SUPER operation code, read the motion queue depth.
+ *
+ */
+#define QUEUE_DEPTH 23
+
+#endif			  // defined(ENABLE_MOTION_QUEUE)
+#pragma endregion // Motion Queue
+
+#pragma region Coordinated Motion
+#if defined(ENABLE_COORDINATED_MOTION)
+
+#if !defined(ENABLE_STEP_TIMER)
+#error "ENABLE_COORDINATED_MOTION requires ENABLE_STEP_TIMER."
+#endif
+
+/**
+ * @brief SUPER operation code, coordinated absolute move of all axises.
+ *
+ */
+#define MOVE_COORDINATED 24
+
+#endif			  // defined(ENABLE_COORDINATED_MOTION)
+#pragma endregion // Coordinated Motion
+
+#pragma region S-Curve
+#if defined(ENABLE_SCURVE)
+
+#if !defined(ENABLE_STEP_TIMER)
+#error "ENABLE_SCURVE requires ENABLE_STEP_TIMER."
+#endif
+
+#if !defined(SCURVE_AXISES)
+/**
+ * @brief Axises bits with S-curve ramp after the start.
+ *
+ */
+#define SCURVE_AXISES 0x3F
+#endif
+
+/**
+ * @brief SUPER operation code, select the S-curve ramp of the axises.
+ *
+ */
+#define SET_PROFILE 25
+
+#endif			  // defined(ENABLE_SCURVE)
+#pragma endregion // S-Curve
+
+#pragma region Input Shaper
+#if defined(ENABLE_INPUT_SHAPER)
+
+#if !defined(ENABLE_STEP_TIMER)
+#error "ENABLE_INPUT_SHAPER requires ENABLE_STEP_TIMER."
+#endif
+
+/**
+ * @brief SUPER operation code, set the input shaper of one axis.
+ *
+ */
+#define SET_SHAPER 26
+
+#endif			  // defined(ENABLE_INPUT_SHAPER)
+#pragma endregion // Input Shaper
+
+#pragma region Joint Coupling
+#if defined(ENABLE_JOINT_COUPLING)
+
+#if !defined(ENABLE_STEP_TIMER)
+#error "ENABLE_JOINT_COUPLING requires ENABLE_STEP_TIMER."
+#endif
+
+#if !defined(COUPLING_RATIOS)
+/**
+ * @brief Couplings after the start, motor axis index, joint axis index and motor steps per joint step.
+ *
+ */
+#if defined(ENABLE_SHMR)
+// The gripper cable runs over q2 and q3, S6A2 and S6A3 are per degree.
+#define COUPLING_RATIOS {{Axis6_t::INDEX, Axis1_t::INDEX, S6A2 / S2}, {Axis6_t::INDEX, Axis2_t::INDEX, S6A3 / S3}}
+#else
+// The gripper turns back with the elbow.
+#define COUPLING_RATIOS {{Axis6_t::INDEX, Axis3_t::INDEX, -1.0F}}
+#endif // defined(ENABLE_SHMR)
+#endif // !defined(COUPLING_RATIOS)
+
+/**
+ * @brief SUPER operation code, read or set the coupling of one motor with one joint.
+ *
+ */
+#define SET_COUPLING 37
+
+#endif			  // defined(ENABLE_JOINT_COUPLING)
+#pragma endregion // Joint Coupling
+
+#pragma region PVT Stream
+#if defined(ENABLE_PVT_STREAM)
+
+#if !defined(ENABLE_STEP_TIMER)
+#error "ENABLE_PVT_STREAM requires ENABLE_STEP_TIMER."
+#endif
+
+/**
+ * @brief SUPER operation code, add position-velocity-time points to the stream.
+ *
+ */
+#define PVT_STREAM 27
+
+/**
+ * @brief SUPER operation code, set the latency window of the stream.
+ *
+ */
+#define PVT_LATENCY 28
+
+#endif			  // defined(ENABLE_PVT_STREAM)
+#pragma endregion // PVT Stream
+
+#pragma region Wrist Transform
+#if defined(ENABLE_WRIST_TRANSFORM)
+
+#if !defined(ENABLE_MOTORS)
+#error "ENABLE_WRIST_TRANSFORM requires ENABLE_MOTORS."
+#endif
+
+#endif			  // defined(ENABLE_WRIST_TRANSFORM)
+#pragma endregion // Wrist Transform
+
+#pragma region Kinematics
+#if defined(ENABLE_KINEMATICS)
+
+#if !defined(ENABLE_MOTORS)
+#error "ENABLE_KINEMATICS requires ENABLE_MOTORS."
+#endif
+
+/**
+ * @brief SUPER operation code, read the pose of the tool.
+ *
+ */
+#define READ_POSE 29
+
+#if !defined(KIN_BASE_HEIGHT)
+/**
+ * @brief Height of the shoulder axis over the base plate. [mm]
+ *
+ */
+#define KIN_BASE_HEIGHT 190.0F
+#endif
+
+#if !defined(KIN_UPPER_ARM)
+/**
+ * @brief Shoulder to the elbow axis. [mm]
+ *
+ */
+#define KIN_UPPER_ARM 178.0F
+#endif
+
+#if !defined(KIN_FOREARM)
+/**
+ * @brief Elbow to the wrist axis. [mm]
+ *
+ */
+#define KIN_FOREARM 178.0F
+#endif
+
+#if !defined(KIN_TOOL)
+/**
+ * @brief Wrist axis to the tool point. [mm]
+ *
+ */
+#define KIN_TOOL 100.0F
+#endif
+
+// Joint steps of one degree, the SHMR step scales. [steps/deg]
+
+#if !defined(KIN_BASE_STEPS)
+#define KIN_BASE_STEPS (-59800.0F / 90.0F)
+#endif
+
+#if !defined(KIN_SHOULDER_STEPS)
+#define KIN_SHOULDER_STEPS (59200.0F / 90.0F)
+#endif
+
+#if !defined(KIN_ELBOW_STEPS)
+#define KIN_ELBOW_STEPS (-36100.0F / 90.7F)
+#endif
+
+#if !defined(KIN_PITCH_STEPS)
+#define KIN_PITCH_STEPS (55000.0F / 90.0F)
+#endif
+
+#if !defined(KIN_ROLL_STEPS)
+#define KIN_ROLL_STEPS (55000.0F / 90.0F)
+#endif
+
+// Joint angles on the zero position. [deg]
+
+#if !defined(KIN_BASE_ZERO)
+#define KIN_BASE_ZERO 0.0F
+#endif
+
+#if !defined(KIN_SHOULDER_ZERO)
+#define KIN_SHOULDER_ZERO 90.0F
+#endif
+
+#if !defined(KIN_ELBOW_ZERO)
+#define KIN_ELBOW_ZERO -90.0F
+#endif
+
+#if !defined(KIN_PITCH_ZERO)
+#define KIN_PITCH_ZERO 0.0F
+#endif
+
+#if !defined(KIN_ROLL_ZERO)
+#define KIN_ROLL_ZERO 0.0F
+#endif
+
+#endif			  // defined(ENABLE_KINEMATICS)
+#pragma endregion // Kinematics
+
+#pragma region Linear Move
+#if defined(ENABLE_LINEAR_MOVE)
+
+#if !defined(ENABLE_KINEMATICS) || !defined(ENABLE_PVT_STREAM)
+#error "ENABLE_LINEAR_MOVE requires ENABLE_KINEMATICS and ENABLE_PVT_STREAM."
+#endif
+
+/**
+ * @brief SUPER operation code, move the tool on a straight line.
+ *
+ */
+#define MOVE_LINEAR 30
+
+/**
+ * @brief Time between the points of the line. [ms]
+ *
+ */
+#define LINEAR_PERIOD_MS 20
+
+/**
+ * @brief Time around a point for its joint speeds. [ms]
+ *
+ */
+#define LINEAR_VELOCITY_DELTA_MS 1
+
+/**
+ * @brief Acceleration of the tool point. [mm/s^2]
+ *
+ */
+#define LINEAR_ACCEL 200.0F
+
+/**
+ * @brief Turn speed of the tool. [deg/s]
+ *
+ */
+#define LINEAR_ANGULAR_SPEED 45.0F
+
+/**
+ * @brief Plans of the line before it is given up as too fast.
+ *
+ */
+#define LINEAR_PLAN_PASSES 3
+
+/**
+ * @brief Margin of the slowed down line over the fastest joint.
+ *
+ */
+#define LINEAR_SPEED_MARGIN 1.05F
+
+#endif			  // defined(ENABLE_LINEAR_MOVE)
+#pragma endregion // Linear Move
+
 #pragma region Limit Switches
 #if defined(ENABLE_LIMITS) || defined(ENABLE_ESTOP)
 /**
@@ -369,6 +773,42 @@
  *
  */
 #define DEBOUNCE_TIME_MS 100
+
+/**
+ * @brief Scan period of the inputs, they are debounced over four scans. [ms]
+ *
+ */
+#define INPUTS_SCAN_TIME_MS (DEBOUNCE_TIME_MS / 4)
+
+/**
+ * @brief Bit of the E-Stop in the inputs state.
+ *
+ */
+#define ESTOP_INPUT 3
+
+/**
+ * @brief Bit of the M1 limit switch in the inputs state.
+ *
+ */
+#define M1_LIMIT_INPUT 4
+
+/**
+ * @brief Bit of the M2 limit switch in the inputs state.
+ *
+ */
+#define M2_LIMIT_INPUT 5
+
+/**
+ * @brief Bit of the M3 limit switch in the inputs state.
+ *
+ */
+#define M3_LIMIT_INPUT 6
+
+/**
+ * @brief Bit of the M6 limit switch in the inputs state.
+ *
+ */
+#define M6_LIMIT_INPUT 7
 #endif
 
 #if defined(ENABLE_LIMITS)
@@ -432,9 +872,207 @@
  */
 #define M6_TIMEOUT_MS 17000
 
+// Homing of the axises: the speed to the switch, the switch state that
+// ends it, the speed back to the switch edge, the axises homed before it
+// (bit per axis index) and the position after the homing. An axis with a
+// known position runs with its approach speed to the window around its
+// last zero first. The window is the deceleration from the approach speed
+// with the acceleration of the axis, plus the margin. [steps/s], [steps]
+
+#if !defined(HOME_MARGIN)
+/**
+ * @brief Margin of the window around the known zero over the deceleration.
+ * It holds the steps of a main loop pass at the approach speed. [steps]
+ *
+ */
+#define HOME_MARGIN 100
+#endif
+
+#if !defined(M1_HOME_SPEED)
+#define M1_HOME_SPEED (-FAST_FORWARD_SPS)
+#endif
+
+#if !defined(M1_HOME_PRESSED)
+#define M1_HOME_PRESSED true
+#endif
+
+#if !defined(M1_HOME_BACK_SPEED)
+#define M1_HOME_BACK_SPEED SLOW_BACKWARD_SPS
+#endif
+
+#if !defined(M1_HOME_APPROACH_SPEED)
+#define M1_HOME_APPROACH_SPEED M1_MAX_SPEED
+#endif
+
+#if !defined(M1_HOME_MARGIN)
+#define M1_HOME_MARGIN HOME_MARGIN
+#endif
+
+#if !defined(M1_HOME_AFTER)
+#define M1_HOME_AFTER 0
+#endif
+
+#if !defined(M1_HOME_PARK)
+#define M1_HOME_PARK 0
+#endif
+
+#if !defined(M2_HOME_SPEED)
+#define M2_HOME_SPEED FAST_FORWARD_SPS
+#endif
+
+#if !defined(M2_HOME_PRESSED)
+#define M2_HOME_PRESSED true
+#endif
+
+#if !defined(M2_HOME_BACK_SPEED)
+#define M2_HOME_BACK_SPEED (-SLOW_BACKWARD_SPS)
+#endif
+
+#if !defined(M2_HOME_APPROACH_SPEED)
+#define M2_HOME_APPROACH_SPEED M2_MAX_SPEED
+#endif
+
+#if !defined(M2_HOME_MARGIN)
+#define M2_HOME_MARGIN HOME_MARGIN
+#endif
+
+#if !defined(M2_HOME_AFTER)
+#define M2_HOME_AFTER 0
+#endif
+
+#if !defined(M2_HOME_PARK)
+#define M2_HOME_PARK 0
+#endif
+
+#if !defined(M3_HOME_SPEED)
+#define M3_HOME_SPEED FAST_FORWARD_SPS
+#endif
+
+#if !defined(M3_HOME_PRESSED)
+#define M3_HOME_PRESSED false
+#endif
+
+#if !defined(M3_HOME_BACK_SPEED)
+#define M3_HOME_BACK_SPEED (-SLOW_BACKWARD_SPS)
+#endif
+
+#if !defined(M3_HOME_APPROACH_SPEED)
+#define M3_HOME_APPROACH_SPEED M3_MAX_SPEED
+#endif
+
+#if !defined(M3_HOME_MARGIN)
+#define M3_HOME_MARGIN HOME_MARGIN
+#endif
+
+#if !defined(M3_HOME_AFTER)
+#define M3_HOME_AFTER 0
+#endif
+
+#if !defined(M3_HOME_PARK)
+#define M3_HOME_PARK 0
+#endif
+
+#if !defined(M6_HOME_SPEED)
+#define M6_HOME_SPEED (-FAST_FORWARD_SPS)
+#endif
+
+#if !defined(M6_HOME_PRESSED)
+#define M6_HOME_PRESSED false
+#endif
+
+#if !defined(M6_HOME_BACK_SPEED)
+#define M6_HOME_BACK_SPEED SLOW_BACKWARD_SPS
+#endif
+
+#if !defined(M6_HOME_APPROACH_SPEED)
+#define M6_HOME_APPROACH_SPEED M6_MAX_SPEED
+#endif
+
+#if !defined(M6_HOME_MARGIN)
+#define M6_HOME_MARGIN HOME_MARGIN
+#endif
+
+#if !defined(M6_HOME_AFTER)
+/**
+ * @brief The gripper cable runs over the elbow, the gripper is homed after it.
+ *
+ */
+#define M6_HOME_AFTER (1U << 2)
+#endif
+
+#if !defined(M6_HOME_PARK)
+/**
+ * @brief Standard opening of the gripper.
+ *
+ */
+#define M6_HOME_PARK 300
+#endif
+
+#if defined(ENABLE_SUPER)
+/**
+ * @brief SUPER operation code, start the homing.
+ *
+ */
+#define HOME 31
+
+/**
+ * @brief SUPER operation code, read the progress of the homing.
+ *
+ */
+#define HOME_STATUS 32
+#endif // defined(ENABLE_SUPER)
+
 #endif			  // defined(ENABLE_LIMITS)
+
+#if defined(ENABLE_LIMIT_LATCH)
+
+#if !defined(ENABLE_LIMITS) || !defined(ENABLE_STEP_TIMER)
+#error "ENABLE_LIMIT_LATCH requires ENABLE_LIMITS and ENABLE_STEP_TIMER."
+#endif
+
+#if !defined(LIMIT_LATCH_LOCKOUT_US)
+/**
+ * @brief Time after a latched edge without latching, the switch bounces. [us]
+ *
+ */
+#define LIMIT_LATCH_LOCKOUT_US 2000
+#endif
+
+#if defined(ENABLE_SUPER)
+/**
+ * @brief SUPER operation code, read the positions latched on the limit switch edges.
+ *
+ */
+#define LIMIT_LATCH 33
+#endif // defined(ENABLE_SUPER)
+
+#endif // defined(ENABLE_LIMIT_LATCH)
 #pragma endregion // ENABLE_LIMITS
 
+#pragma region Position Journal
+#if defined(ENABLE_POSITION_JOURNAL)
+
+#if !defined(ENABLE_MOTORS)
+#error "ENABLE_POSITION_JOURNAL requires ENABLE_MOTORS."
+#endif
+
+/**
+ * @brief NVS namespace of the position journal, apart from the features flags.
+ *
+ */
+#define JOURNAL_NAME "journal"
+
+#if !defined(JOURNAL_INTERVAL_MS)
+/**
+ * @brief Shortest time between two records at rest, the motion marker stays meanwhile. [ms]
+ *
+ */
+#define JOURNAL_INTERVAL_MS 1000
+#endif // !defined(JOURNAL_INTERVAL_MS)
+
+#endif			  // defined(ENABLE_POSITION_JOURNAL)
+#pragma endregion // Position Journal
+
 #pragma region E-Stop
 #if defined(ENABLE_ESTOP)
 /**
@@ -442,6 +1080,14 @@
  *
  */
 #define ESTOP_TIME_MS 100
+
+#if defined(ENABLE_SUPER)
+/**
+ * @brief SUPER operation code, clear the E-Stop fault.
+ *
+ */
+#define ESTOP_RESET 34
+#endif // defined(ENABLE_SUPER)
 #endif // defined(ENABLE_ESTOP)
 #pragma endregion // E-Stop
 
@@ -624,7 +1270,7 @@ const char KEY_LEFT[3] = {0x1B, 0x5B, 0x44};
  * @brief Number of commands.
  * 
  */
-#define CMDS_COUNT 10
+#define CMDS_COUNT 12
 #endif // !defined(CMDS_COUNT)
 
 /**
@@ -639,6 +1285,14 @@ const char KEY_LEFT[3] = {0x1B, 0x5B, 0x44};
  */
 #define CMD_NAME_LENGTH 10
 
+#if !defined(RESPONSE_LENGTH)
+/**
+ * @brief Maximum ASCII bytes per response, the @READX line is the longest.
+ * 
+ */
+#define RESPONSE_LENGTH 192
+#endif // !defined(RESPONSE_LENGTH)
+
 /**
  * @brief Maximum ASCII bytes per argument.
  * 
@@ -657,6 +1311,12 @@ const char KEY_LEFT[3] = {0x1B, 0x5B, 0x44};
  */
 #define CMD_READ "@READ"
 
+/**
+ * @brief Extended telemetry variant of @READ.
+ * 
+ */
+#define CMD_READX "@READX"
+
 /**
  * @brief 
  * 
@@ -675,6 +1335,18 @@ const char KEY_LEFT[3] = {0x1B, 0x5B, 0x44};
  */
 #define CMD_STEP "@STEP"
 
+/**
+ * @brief Coordinated variant of @STEP.
+ * 
+ */
+#define CMD_STEPC "@STEPC"
+
+/**
+ * @brief Read the pose of the tool.
+ * 
+ */
+#define CMD_POSE "@POSE"
+
 /**
  * @brief 
  * 
@@ -687,6 +1359,18 @@ const char KEY_LEFT[3] = {0x1B, 0x5B, 0x44};
  */
 #define CMD_HOME "HOME"
 
+/**
+ * @brief Read the progress of the homing.
+ * 
+ */
+#define CMD_HOMING "@HOMING"
+
+/**
+ * @brief Clear the E-Stop fault.
+ * 
+ */
+#define CMD_ESTOP_RESET "@ESRESET"
+
 
 /**
  * @brief 
@@ -708,6 +1392,54 @@ const char KEY_LEFT[3] = {0x1B, 0x5B, 0x44};
 #endif // defined(ENABLE_TCM_COMMANDS)
 #pragma endregion // TCM Commands
 
+#pragma region Telemetry
+#if defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
+/**
+ * @brief Number of the joints in the extended telemetry.
+ *
+ */
+#define TELEMETRY_AXISES 6
+
+/**
+ * @brief Fraction bits of the speeds in the extended telemetry.
+ *
+ */
+#define TELEMETRY_SPEED_SHIFT 8
+
+/**
+ * @brief Telemetry flag, the drivers are enabled.
+ *
+ */
+#define TELEMETRY_FLAG_ENABLED 0x01
+
+/**
+ * @brief Telemetry flag, the E-Stop fault is latched.
+ *
+ */
+#define TELEMETRY_FLAG_ESTOP 0x02
+
+/**
+ * @brief Telemetry flag, the motion is stopped by the WDT.
+ *
+ */
+#define TELEMETRY_FLAG_WDT_STOP 0x04
+
+#if defined(ENABLE_SUPER)
+/**
+ * @brief SUPER operation code, read the extended telemetry.
+ *
+ */
+#define TELEMETRY 35
+
+/**
+ * @brief Length of the extended telemetry frame. [bytes]
+ *
+ */
+#define TELEMETRY_LENGTH 56
+#endif // defined(ENABLE_SUPER)
+#endif			  // defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
+#pragma endregion // Telemetry
+
 #pragma region Watchdog Timer
 #if defined(ENABLE_WDT)
 
@@ -719,6 +1451,13 @@ const char KEY_LEFT[3] = {0x1B, 0x5B, 0x44};
 #define WDT_TIMEOUT 3000
 #endif
 
+/**
+ * @brief Disable the drivers when the axises stopped after the WDT expiration.
+ * By default they stay enabled and hold the axises.
+ *
+ */
+// #define WDT_STOP_DISABLE
+
 #endif			  // defined(ENABLE_WDT)
 #pragma endregion // Watchdog Timer
 
@@ -778,6 +1517,10 @@ A0 A1 A2
 #pragma region SHMR
 #if defined(ENABLE_SHMR)
 
+#if !defined(ENABLE_LIMITS)
+#error "ENABLE_SHMR requires ENABLE_LIMITS, the gripper stops on its limit switch."
+#endif
+
 #define MOTOR_SPEED (2E+2)
 #define MOTOR_SLOW_SPEED (MOTOR_SPEED / 2)
 #define MOTOR_MAX_SPEED MOTOR_SPEED
@@ -797,6 +1540,12 @@ A0 A1 A2
 #define GRIPPER_UNGRIP 20
 #define GRIPPER_OPEN_TO_ABSOLUTE_DISTANCE 21
 
+/**
+ * @brief SUPER operation code, read the running gripper job and the result of the last one.
+ *
+ */
+#define GRIPPER_STATUS 36
+
 // коэффициенты преобразования углов в микрошаги
 const float S1 = -59800 / 90;
 const float S2 = 59200 / 90;
@@ -919,6 +1668,30 @@ const float S6A3 = (55000 / 90) * 0.7; // 0.7
 #endif
 #endif // defined(ENABLE_SLEEP_MODE)
 
+#if defined(ENABLE_PS4_CARTESIAN)
+
+#if !defined(ENABLE_KINEMATICS)
+#error "ENABLE_PS4_CARTESIAN requires ENABLE_KINEMATICS."
+#endif
+
+#if !defined(PS4_JOG_SPEED)
+/**
+ * @brief Tool speed of the full stick in the Cartesian jog. [mm/s]
+ *
+ */
+#define PS4_JOG_SPEED 50.0F
+#endif
+
+#if !defined(PS4_JOG_ANGULAR_SPEED)
+/**
+ * @brief Tool turn speed of the full stick in the Cartesian jog. [deg/s]
+ *
+ */
+#define PS4_JOG_ANGULAR_SPEED 30.0F
+#endif
+
+#endif // defined(ENABLE_PS4_CARTESIAN)
+
 #endif // defined(ENABLE_PS4)
 #pragma endregion // PS4
 
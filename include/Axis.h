@@ -0,0 +1,145 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _AXIS_h
+#define _AXIS_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+/**
+ * @brief Compile time description of one axis.
+ *
+ * @tparam Index Index of the stepper driver, 0 is stepper1.
+ * @tparam PinStep Step pin.
+ * @tparam PinDir Direction pin.
+ * @tparam DirInverted Direction pin polarity is inverted.
+ * @tparam MaxSpeed Maximum speed. [steps/s]
+ * @tparam Accel Acceleration. [steps/s^2]
+ * @tparam Jerk Jerk of the S-curve ramp, 0 for the trapezoidal ramp. [steps/s^3]
+ */
+template <uint8_t Index, uint8_t PinStep, uint8_t PinDir, bool DirInverted, uint32_t MaxSpeed, uint32_t Accel, uint32_t Jerk = 0>
+struct Axis
+{
+  static constexpr uint8_t INDEX = Index;
+  static constexpr uint8_t PIN_STEP = PinStep;
+  static constexpr uint8_t PIN_DIR = PinDir;
+  static constexpr bool DIR_INVERTED = DirInverted;
+  static constexpr uint32_t MAX_SPEED = MaxSpeed;
+  static constexpr uint32_t ACCEL = Accel;
+  static constexpr uint32_t JERK = Jerk;
+
+  /**
+   * @brief Bit of the axis in the motors state.
+   *
+   */
+  static constexpr uint8_t BIT = (1U << Index);
+
+  /**
+   * @brief Step pin bit over GPIO 0 - 39.
+   *
+   */
+  static constexpr uint64_t STEP_PIN_BIT = (1ULL << PinStep);
+
+  /**
+   * @brief Direction pin bit over GPIO 0 - 39.
+   *
+   */
+  static constexpr uint64_t DIR_PIN_BIT = (1ULL << PinDir);
+};
+
+/**
+ * @brief Compile time table of axises.
+ *
+ * each() calls action.apply<A>() for every axis A in the order of the table.
+ * The recursion is resolved by the compiler, so the result is the same
+ * straight code as the hand written version for every axis.
+ *
+ * @tparam Axises Axis descriptors.
+ */
+template <typename... Axises>
+struct AxisTable;
+
+/**
+ * @brief End of the axises table.
+ *
+ */
+template <>
+struct AxisTable<>
+{
+  static constexpr uint8_t COUNT = 0;
+  static constexpr uint8_t BITS = 0;
+  static constexpr uint64_t STEP_PINS = 0;
+  static constexpr uint64_t DIR_PINS = 0;
+
+  template <typename Action>
+  static inline void each(Action &action)
+  {
+    (void)action;
+  }
+};
+
+template <typename A, typename... Rest>
+struct AxisTable<A, Rest...>
+{
+  /**
+   * @brief Number of the axises.
+   *
+   */
+  static constexpr uint8_t COUNT = 1 + AxisTable<Rest...>::COUNT;
+
+  /**
+   * @brief Motors state bits of all axises.
+   *
+   */
+  static constexpr uint8_t BITS = A::BIT | AxisTable<Rest...>::BITS;
+
+  /**
+   * @brief Step pins of all axises.
+   *
+   */
+  static constexpr uint64_t STEP_PINS = A::STEP_PIN_BIT | AxisTable<Rest...>::STEP_PINS;
+
+  /**
+   * @brief Direction pins of all axises.
+   *
+   */
+  static constexpr uint64_t DIR_PINS = A::DIR_PIN_BIT | AxisTable<Rest...>::DIR_PINS;
+
+  /**
+   * @brief Apply the action on every axis.
+   *
+   * @tparam Action Type with template <typename A> void apply().
+   * @param action Action state.
+   */
+  template <typename Action>
+  static inline void each(Action &action)
+  {
+    action.template apply<A>();
+    AxisTable<Rest...>::each(action);
+  }
+};
+
+#endif // _AXIS_h
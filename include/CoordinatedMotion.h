@@ -0,0 +1,212 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _COORDINATEDMOTION_h
+#define _COORDINATEDMOTION_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#include "TimerStepper.h"
+
+#pragma region Definitions
+
+#if !defined(COORDINATED_MOTION_AXISES)
+/**
+ * @brief Maximum number of the coordinated axises.
+ *
+ */
+#define COORDINATED_MOTION_AXISES 6
+#endif // !defined(COORDINATED_MOTION_AXISES)
+
+#pragma endregion // Definitions
+
+/**
+ * @brief Move of several axises with one ramp, all of them start and stop together.
+ *
+ * The longest axis sets the pace. A lead TimerStepper without pins runs
+ * its distance with the group speed and acceleration, and every lead step
+ * is spread over the other axises with Bresenham, so the move is a straight
+ * line in joint space.
+ *
+ * The group speed and acceleration are the highest ones that keep every
+ * axis in its own limits.
+ */
+class CoordinatedMotion
+{
+public:
+  /**
+   * @brief Construct a new Coordinated Motion object.
+   *
+   */
+  CoordinatedMotion();
+
+  /**
+   * @brief Set the distance and the limits of one axis for the next move.
+   *
+   * @param index Axis index.
+   * @param distance Distance. [steps]
+   * @param maxSpeed Maximum speed of the axis. [steps/s]
+   * @param acceleration Acceleration of the axis. [steps/s^2]
+   */
+  void setAxis(uint8_t index, long distance, float maxSpeed, float acceleration);
+
+  /**
+   * @brief Start the move with the distances given by setAxis().
+   *
+   * @return true The move is started.
+   * @return false Nothing to move or a move is running.
+   */
+  bool start();
+
+  /**
+   * @brief Update the move, called from the main loop.
+   *
+   * @return true The move is running.
+   * @return false The move is done.
+   */
+  bool run();
+
+  /**
+   * @brief Stop on the path with the group acceleration.
+   *
+   */
+  void stop();
+
+  /**
+   * @brief Drop the move at once.
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Check if the move is running.
+   *
+   * @return true Running.
+   * @return false Done.
+   */
+  bool isRunning();
+
+  /**
+   * @brief Check if the axis takes part in the move.
+   *
+   * @param index Axis index.
+   * @return true The axis moves.
+   * @return false The axis stands.
+   */
+  bool moves(uint8_t index) const;
+
+  /**
+   * @brief Direction of the axis.
+   *
+   * @param index Axis index.
+   * @return true Forward.
+   * @return false Backward.
+   */
+  bool forward(uint8_t index) const;
+
+  /**
+   * @brief Planned duration of the move.
+   *
+   * @return float Duration. [s]
+   */
+  float duration();
+
+  /**
+   * @brief Advance the lead axis with one timer period.
+   *
+   * @note Called from the step timer interrupt, before follow().
+   * @return true The lead axis steps in this period.
+   * @return false No step.
+   */
+  bool tick();
+
+  /**
+   * @brief Bresenham decision for the axis on a lead step.
+   *
+   * @note Called from the step timer interrupt, only when tick() is true.
+   * @param index Axis index.
+   * @return true The axis steps.
+   * @return false No step.
+   */
+  bool follow(uint8_t index);
+
+private:
+  /**
+   * @brief Absolute distance of the axises. [steps]
+   *
+   */
+  long m_distance[COORDINATED_MOTION_AXISES];
+
+  /**
+   * @brief Direction of the axises.
+   *
+   */
+  bool m_forward[COORDINATED_MOTION_AXISES];
+
+  /**
+   * @brief Bresenham error of the axises. [steps]
+   *
+   */
+  long m_error[COORDINATED_MOTION_AXISES];
+
+  /**
+   * @brief Maximum speed of the axises. [steps/s]
+   *
+   */
+  float m_maxSpeed[COORDINATED_MOTION_AXISES];
+
+  /**
+   * @brief Acceleration of the axises. [steps/s^2]
+   *
+   */
+  float m_acceleration[COORDINATED_MOTION_AXISES];
+
+  /**
+   * @brief Distance of the lead axis, the longest one. [steps]
+   *
+   */
+  long m_steps;
+
+  /**
+   * @brief The move waits one timer period, the directions go to the pins.
+   *
+   */
+  volatile bool m_armed;
+
+  /**
+   * @brief The move is running.
+   *
+   */
+  volatile bool m_running;
+
+  /**
+   * @brief Lead axis, it has no pins.
+   *
+   */
+  TimerStepper m_lead;
+};
+
+#endif // _COORDINATEDMOTION_h
@@ -0,0 +1,141 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _ESTOP_h
+#define _ESTOP_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#if !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif // !defined(IRAM_ATTR)
+
+#pragma region Definitions
+
+/**
+ * @brief Pin of an unused output.
+ *
+ */
+#define ESTOP_NO_PIN 0xFF
+
+#pragma endregion // Definitions
+
+/**
+ * @brief Latch of the E-Stop fault, the gate of the step timer.
+ *
+ * The switch is normally closed, the input goes HIGH on the stop and on
+ * a broken wire. trip() is called from the interrupt of the edge, it reads
+ * the input again to drop a glitch, latches the fault and disables the
+ * drivers without waiting for the loop. The step timer interrupt makes no
+ * step while latched(). The fault stays until reset() with the switch closed.
+ */
+class EStop
+{
+public:
+  /**
+   * @brief Construct a new E-Stop object, not latched.
+   *
+   */
+  EStop();
+
+  /**
+   * @brief Set the pins, before the interrupt is attached.
+   *
+   * @param pinInput E-Stop input, HIGH on the stop.
+   * @param pinEnable Drivers enable output, HIGH disables, ESTOP_NO_PIN for none.
+   */
+  void begin(uint8_t pinInput, uint8_t pinEnable);
+
+  /**
+   * @brief Latch the fault and disable the drivers, called from the interrupt of the edge.
+   *
+   */
+  void trip();
+
+  /**
+   * @brief Clear the fault, the drivers stay disabled until enabled again.
+   *
+   * @return true Cleared.
+   * @return false The E-Stop is still active.
+   */
+  bool reset();
+
+  /**
+   * @brief Check the fault, called from the step timer interrupt.
+   *
+   * @return true The fault is latched, no steps.
+   * @return false No fault.
+   */
+  inline bool IRAM_ATTR latched() const
+  {
+    return m_latched != 0;
+  }
+
+#if !defined(ARDUINO)
+  /**
+   * @brief Level of the E-Stop input, host backend only.
+   *
+   * @return uint8_t& Level.
+   */
+  static uint8_t &inputLevel();
+
+  /**
+   * @brief Level of the drivers enable output, host backend only.
+   *
+   * @return uint8_t& Level.
+   */
+  static uint8_t &enableLevel();
+#endif // !defined(ARDUINO)
+
+private:
+  /**
+   * @brief Read the E-Stop input.
+   *
+   * @return true The switch is open.
+   * @return false The switch is closed.
+   */
+  bool open() const;
+
+  /**
+   * @brief E-Stop input.
+   *
+   */
+  uint8_t m_pinInput;
+
+  /**
+   * @brief Drivers enable output.
+   *
+   */
+  uint8_t m_pinEnable;
+
+  /**
+   * @brief Fault latch.
+   *
+   */
+  volatile uint8_t m_latched;
+};
+
+#endif // _ESTOP_h
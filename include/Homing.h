@@ -0,0 +1,342 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _HOMING_h
+#define _HOMING_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#pragma region Definitions
+
+#if !defined(HOMING_AXISES)
+/**
+ * @brief Number of the axises.
+ *
+ */
+#define HOMING_AXISES 6
+#endif // !defined(HOMING_AXISES)
+
+#pragma endregion // Definitions
+
+/**
+ * @brief Homing of all axises with a limit switch at once.
+ *
+ * Every axis runs with its seek speed until its switch comes to the seek
+ * state, then back with its back speed until the switch leaves that state.
+ * The edge of the switch is the zero of the axis. An axis starts only after
+ * the axises it depends on are homed.
+ *
+ * An axis with a known position is homed in two phases. It runs with its
+ * approach speed until it is in the window around its last zero, then
+ * with the back speed towards the switch, so the edge is found at the same
+ * slow speed as in a full search. The window is the distance to slow down
+ * from the approach speed to the back speed plus a margin. When the switch is not found inside the
+ * window the axis falls back to the full search with its seek speed.
+ *
+ * Nothing here blocks, update() is called from the main loop with the
+ * switches, the positions and the time, it gives the speeds of the axises
+ * and the axises to zero. A phase that does not end in the timeout of its
+ * axis fails the homing and stops all axises.
+ */
+class Homing
+{
+public:
+  /**
+   * @brief States of the homing.
+   *
+   */
+  typedef enum
+  {
+    IDLE = 0,    ///< Not started.
+    RUNNING = 1, ///< Axises are homed.
+    HOMED = 2,   ///< All axises are homed.
+    FAILED = 3,  ///< An axis is out of time, or the homing is stopped.
+  } State;
+
+  /**
+   * @brief Construct a new Homing object.
+   *
+   */
+  Homing();
+
+  /**
+   * @brief Set the homing of an axis.
+   *
+   * @param index Axis index.
+   * @param seekSpeed Speed to the switch. [steps/s]
+   * @param seekPressed State of the switch that ends the seek.
+   * @param backSpeed Speed back to the edge of the switch. [steps/s]
+   * @param after Axises homed before this one, bit per axis index.
+   * @param timeout Time of each phase. [ms]
+   */
+  void setAxis(uint8_t index, float seekSpeed, bool seekPressed, float backSpeed, uint8_t after, uint32_t timeout);
+
+  /**
+   * @brief Set the approach of an axis with a known position.
+   *
+   * @param index Axis index.
+   * @param speed Speed to the window, the direction of the seek is used. [steps/s]
+   * @param margin Distance of the window over the deceleration. [steps]
+   */
+  void setApproach(uint8_t index, float speed, long margin);
+
+  /**
+   * @brief Set the acceleration of an axis, the window holds its deceleration.
+   *
+   * @param index Axis index.
+   * @param acceleration Acceleration, 0 is a window of the margin only. [steps/s^2]
+   */
+  void setAcceleration(uint8_t index, float acceleration);
+
+  /**
+   * @brief Window around the known zero of an axis.
+   *
+   * @param index Axis index.
+   * @return long Deceleration from the approach speed to the back speed plus the margin. [steps]
+   */
+  long window(uint8_t index) const;
+
+  /**
+   * @brief Start the homing.
+   *
+   * @param axises Axises to home, bit per axis index. Axises without setAxis() are left out.
+   * @param known Axises with a valid position to the last zero, bit per axis index.
+   * @param now Time. [ms]
+   * @return true Started.
+   * @return false Nothing to home.
+   */
+  bool begin(uint8_t axises, uint8_t known, uint32_t now);
+
+  /**
+   * @brief Advance the homing.
+   *
+   * @param pressed Switches, bit per axis index.
+   * @param positions Positions of the axises. [steps]
+   * @param now Time. [ms]
+   * @return uint8_t Axises on their zero now, bit per axis index.
+   */
+  uint8_t update(uint8_t pressed, const long *positions, uint32_t now);
+
+  /**
+   * @brief Stop the homing, the homed axises stay homed.
+   *
+   */
+  void stop();
+
+  /**
+   * @brief State of the switch on the zero edge of an axis.
+   *
+   * @param index Axis index.
+   * @return true The zero is the edge to pressed.
+   * @return false The zero is the edge to released.
+   */
+  bool zeroPressed(uint8_t index) const;
+
+  /**
+   * @brief Speed of an axis.
+   *
+   * @param index Axis index.
+   * @return float Speed. [steps/s]
+   */
+  float speed(uint8_t index) const;
+
+  /**
+   * @brief Get the state.
+   *
+   * @return State State.
+   */
+  State state() const;
+
+  /**
+   * @brief Check if the axises are moved.
+   *
+   * @return true Running.
+   * @return false Idle, homed or failed.
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief Axises of the homing.
+   *
+   * @return uint8_t Bit per axis index.
+   */
+  uint8_t axises() const;
+
+  /**
+   * @brief Homed axises.
+   *
+   * @return uint8_t Bit per axis index.
+   */
+  uint8_t homed() const;
+
+  /**
+   * @brief Axises out of time.
+   *
+   * @return uint8_t Bit per axis index.
+   */
+  uint8_t failed() const;
+
+  /**
+   * @brief Axises with a known position that fell back to the full search.
+   *
+   * @return uint8_t Bit per axis index.
+   */
+  uint8_t missed() const;
+
+private:
+  /**
+   * @brief Phases of an axis.
+   *
+   */
+  typedef enum
+  {
+    WAIT = 0,     ///< Waits for the axises before it.
+    APPROACH = 1, ///< Runs to the window of the known zero.
+    CREEP = 2,    ///< Runs slow to the switch inside the window.
+    SEEK = 3,     ///< Runs to the switch.
+    RELEASE = 4,  ///< Runs back to the edge of the switch.
+    DONE = 5,     ///< Homed.
+  } Phase;
+
+  /**
+   * @brief Start a phase of an axis.
+   *
+   * @param index Axis index.
+   * @param phase Phase.
+   * @param now Time. [ms]
+   */
+  void enter(uint8_t index, Phase phase, uint32_t now);
+
+  /**
+   * @brief Speed to the switch. [steps/s]
+   *
+   */
+  float m_seekSpeed[HOMING_AXISES];
+
+  /**
+   * @brief Speed back to the edge. [steps/s]
+   *
+   */
+  float m_backSpeed[HOMING_AXISES];
+
+  /**
+   * @brief Speed to the window of the known zero. [steps/s]
+   *
+   */
+  float m_approachSpeed[HOMING_AXISES];
+
+  /**
+   * @brief Window around the known zero over the deceleration. [steps]
+   *
+   */
+  long m_margin[HOMING_AXISES];
+
+  /**
+   * @brief Acceleration. [steps/s^2]
+   *
+   */
+  float m_acceleration[HOMING_AXISES];
+
+  /**
+   * @brief Window around the known zero. [steps]
+   *
+   */
+  long m_window[HOMING_AXISES];
+
+  /**
+   * @brief Switch states that end the seek, bit per axis index.
+   *
+   */
+  uint8_t m_seekPressed;
+
+  /**
+   * @brief Axises before every axis, bit per axis index.
+   *
+   */
+  uint8_t m_after[HOMING_AXISES];
+
+  /**
+   * @brief Time of a phase. [ms]
+   *
+   */
+  uint32_t m_timeout[HOMING_AXISES];
+
+  /**
+   * @brief Axises with a set homing, bit per axis index.
+   *
+   */
+  uint8_t m_configured;
+
+  /**
+   * @brief Phase of the axises.
+   *
+   */
+  Phase m_phase[HOMING_AXISES];
+
+  /**
+   * @brief Start of the phase of the axises. [ms]
+   *
+   */
+  uint32_t m_start[HOMING_AXISES];
+
+  /**
+   * @brief Axises of the homing, bit per axis index.
+   *
+   */
+  uint8_t m_axises;
+
+  /**
+   * @brief Axises with a known position, bit per axis index.
+   *
+   */
+  uint8_t m_known;
+
+  /**
+   * @brief Homed axises, bit per axis index.
+   *
+   */
+  uint8_t m_homed;
+
+  /**
+   * @brief Axises out of time, bit per axis index.
+   *
+   */
+  uint8_t m_failed;
+
+  /**
+   * @brief Axises that fell back to the full search, bit per axis index.
+   *
+   */
+  uint8_t m_missed;
+
+  /**
+   * @brief State.
+   *
+   */
+  State m_state;
+};
+
+#endif // _HOMING_h
@@ -0,0 +1,143 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef _INPUTSCANNER_h
+#define _INPUTSCANNER_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "soc/gpio_struct.h"
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+#pragma region Definitions
+
+/**
+ * @brief Number of the scanned inputs, one bit each.
+ *
+ */
+#define INPUT_SCANNER_INPUTS 8
+
+/**
+ * @brief Pin of an unused input.
+ *
+ */
+#define INPUT_SCANNER_NO_PIN 0xFF
+
+#pragma endregion // Definitions
+
+/**
+ * @brief Scanner of the active low inputs, all of them in one pass.
+ *
+ * The GPIO input registers are read once per scan and every input takes
+ * its bit. The bits are debounced together with a two bit vertical
+ * counter per input: an input changes its state after four scans in a row
+ * with the new level, a scan with the old level starts the count again.
+ * So every input has the same latency of four scan periods.
+ *
+ * The state is one byte written once per scan, a reader always gets a
+ * whole snapshot.
+ */
+class InputScanner
+{
+public:
+  /**
+   * @brief Construct a new Input Scanner object.
+   *
+   */
+  InputScanner();
+
+  /**
+   * @brief Set the pin of an input.
+   *
+   * @param index Bit of the input in the state.
+   * @param pin GPIO pin, active low.
+   */
+  void setInput(uint8_t index, uint8_t pin);
+
+  /**
+   * @brief Take the state from one scan, without the debounce.
+   *
+   */
+  void begin();
+
+  /**
+   * @brief Read the inputs.
+   *
+   * @return uint8_t Active inputs, bit per input.
+   */
+  uint8_t sample() const;
+
+  /**
+   * @brief Debounce one sample of the inputs.
+   *
+   * @param sample Active inputs, bit per input.
+   * @return uint8_t Inputs changed by this sample, bit per input.
+   */
+  uint8_t update(uint8_t sample);
+
+  /**
+   * @brief Read and debounce the inputs, called at a fixed rate.
+   *
+   * @return uint8_t Inputs changed by this scan, bit per input.
+   */
+  uint8_t scan();
+
+  /**
+   * @brief Debounced state of the inputs.
+   *
+   * @return uint8_t Active inputs, bit per input.
+   */
+  uint8_t state() const;
+
+private:
+  /**
+   * @brief Pins of the inputs.
+   *
+   */
+  uint8_t m_pins[INPUT_SCANNER_INPUTS];
+
+  /**
+   * @brief Low bit of the vertical counters.
+   *
+   */
+  uint8_t m_count0;
+
+  /**
+   * @brief High bit of the vertical counters.
+   *
+   */
+  uint8_t m_count1;
+
+  /**
+   * @brief Debounced state.
+   *
+   */
+  volatile uint8_t m_state;
+};
+
+#endif // _INPUTSCANNER_h
@@ -0,0 +1,213 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _INPUTSHAPER_h
+#define _INPUTSHAPER_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#if !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif // !defined(IRAM_ATTR)
+
+#pragma region Definitions
+
+#if !defined(SHAPER_BUFFER_SIZE)
+/**
+ * @brief Number of the planned steps kept for the delayed impulses,
+ * it has to hold the steps of the longest shaper delay.
+ *
+ */
+#define SHAPER_BUFFER_SIZE 256
+#endif // !defined(SHAPER_BUFFER_SIZE)
+
+/**
+ * @brief Maximum number of the shaper impulses.
+ *
+ */
+#define SHAPER_IMPULSES 3
+
+/**
+ * @brief Fraction bits of the impulse amplitudes.
+ *
+ */
+#define SHAPER_AMPLITUDE_SHIFT 15
+
+#pragma endregion // Definitions
+
+/**
+ * @brief ZV / ZVD input shaper of the planned steps of one axis.
+ *
+ * The output position is the sum of the planned position delayed by every
+ * impulse and weighted with its amplitude, so the move excites the joint
+ * resonance less. The amplitudes are in Q15 and their sum is exactly one,
+ * the output ends on the planned position.
+ *
+ * The planned steps are kept with their time in a ring, every delayed
+ * impulse reads the ring with its own index. The interrupt work is a few
+ * integer additions per axis.
+ */
+class InputShaper
+{
+public:
+  /**
+   * @brief Shaper types.
+   *
+   */
+  typedef enum
+  {
+    NONE = 0, ///< The steps pass through.
+    ZV = 1,   ///< Zero vibration, two impulses, half period delay.
+    ZVD = 2,  ///< Zero vibration and derivative, three impulses, one period delay.
+  } Type;
+
+  /**
+   * @brief Construct a new Input Shaper object.
+   *
+   */
+  InputShaper();
+
+  /**
+   * @brief Set the shaper, the pending output is dropped.
+   *
+   * @param type Shaper type.
+   * @param frequency Resonance frequency of the joint. [Hz]
+   * @param damping Damping ratio of the joint, 0 to 1.
+   * @param timerFrequency Step timer frequency. [Hz]
+   * @return true The shaper is set.
+   * @return false Wrong parameters, the shaper is not changed.
+   */
+  bool set(Type type, float frequency, float damping, uint32_t timerFrequency);
+
+  /**
+   * @brief Get the shaper type.
+   *
+   * @return Type Shaper type.
+   */
+  Type type() const;
+
+  /**
+   * @brief Drop the pending output, the output takes the planned position.
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Check if the output is behind the planned position.
+   *
+   * @return true Shaped steps are pending.
+   * @return false The output is on the planned position.
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief Shape the planned step of one timer period.
+   *
+   * @note Called from the step timer interrupt.
+   * @param step The planner steps in this period.
+   * @param dirLevel Direction pin level of the planned step, HIGH is positive.
+   * @return true Step pulse is due.
+   * @return false No step pulse.
+   */
+  bool shape(bool step, bool dirLevel);
+
+  /**
+   * @brief Level of the direction pin of the shaped output.
+   *
+   * @return true HIGH.
+   * @return false LOW.
+   */
+  bool dirLevel() const;
+
+private:
+  /**
+   * @brief Planned steps, time in the upper 31 bits and the level in bit 0.
+   *
+   */
+  uint32_t m_events[SHAPER_BUFFER_SIZE];
+
+  /**
+   * @brief Write index of the planned steps.
+   *
+   */
+  uint16_t m_head;
+
+  /**
+   * @brief Read index of the delayed impulses.
+   *
+   */
+  uint16_t m_tail[SHAPER_IMPULSES];
+
+  /**
+   * @brief Delay of the impulses. [ticks]
+   *
+   */
+  uint32_t m_delay[SHAPER_IMPULSES];
+
+  /**
+   * @brief Amplitude of the impulses. [Q15]
+   *
+   */
+  int32_t m_amplitude[SHAPER_IMPULSES];
+
+  /**
+   * @brief Planned position seen by the impulses. [steps]
+   *
+   */
+  int32_t m_position[SHAPER_IMPULSES];
+
+  /**
+   * @brief Output position. [steps]
+   *
+   */
+  int32_t m_output;
+
+  /**
+   * @brief Number of the impulses.
+   *
+   */
+  uint8_t m_count;
+
+  /**
+   * @brief Timer periods since the shaper is set. [ticks]
+   *
+   */
+  uint32_t m_now;
+
+  /**
+   * @brief Direction level of the output.
+   *
+   */
+  bool m_level;
+
+  /**
+   * @brief Shaper type.
+   *
+   */
+  volatile Type m_type;
+};
+
+#endif // _INPUTSHAPER_h
@@ -0,0 +1,194 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _JOINTCOUPLING_h
+#define _JOINTCOUPLING_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#if !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif // !defined(IRAM_ATTR)
+
+#pragma region Definitions
+
+#if !defined(COUPLING_AXISES)
+/**
+ * @brief Number of the coupled axises.
+ *
+ */
+#define COUPLING_AXISES 6
+#endif // !defined(COUPLING_AXISES)
+
+/**
+ * @brief Fraction bits of the ratios and the pending steps.
+ *
+ */
+#define COUPLING_RATIO_SHIFT 16
+
+#pragma endregion // Definitions
+
+#pragma region Types
+
+/**
+ * @brief Coupling of one motor with one joint.
+ *
+ */
+struct CouplingRatio
+{
+  uint8_t Axis;  ///< Axis index of the motor.
+  uint8_t Joint; ///< Axis index of the joint.
+  float Ratio;   ///< Motor steps per joint step.
+};
+
+#pragma endregion // Types
+
+/**
+ * @brief Mechanical coupling of the joints, compensated on the motor steps.
+ *
+ * A joint of the arm can turn the motor of another joint, as the elbow
+ * turns the gripper cable. The ratio of the motor and the joint tells
+ * how many motor steps compensate one step of the joint, so the planned
+ * positions stay the joint positions and the motors take the sum.
+ *
+ * The interrupt adds the planned steps of all joints first, then every
+ * motor follows its own step and the compensation in the same period.
+ * The ratios and the pending steps are in Q16.16, a motor gives at most
+ * one step per period and the rest waits for the next periods.
+ *
+ * The compensation follows the steps only, setting the position of a
+ * joint does not move the coupled motors.
+ */
+class JointCoupling
+{
+public:
+  /**
+   * @brief Axis outputs of one timer period.
+   *
+   */
+  typedef enum
+  {
+    NONE = 0, ///< Nothing to do.
+    TURN = 1, ///< Set the direction, the step comes on the next period.
+    STEP = 2, ///< Step in the current direction.
+  } Output;
+
+  /**
+   * @brief Construct a new Joint Coupling object, without coupling.
+   *
+   */
+  JointCoupling();
+
+  /**
+   * @brief Set the coupling of the motor with the joint.
+   *
+   * @param axis Axis index of the motor.
+   * @param joint Axis index of the joint.
+   * @param ratio Motor steps per joint step, zero for no coupling.
+   * @return true Set.
+   * @return false Wrong axis, the axis is the joint or the ratio is out of range.
+   */
+  bool set(uint8_t axis, uint8_t joint, float ratio);
+
+  /**
+   * @brief Get the coupling of the motor with the joint.
+   *
+   * @param axis Axis index of the motor.
+   * @param joint Axis index of the joint.
+   * @return float Motor steps per joint step.
+   */
+  float ratio(uint8_t axis, uint8_t joint) const;
+
+  /**
+   * @brief Remove all couplings.
+   *
+   */
+  void clear();
+
+  /**
+   * @brief Drop the pending steps of all motors.
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Check if the motor has pending steps.
+   *
+   * @param axis Axis index.
+   * @return true The motor has to step.
+   * @return false The motor is on its position.
+   */
+  bool isRunning(uint8_t axis) const;
+
+  /**
+   * @brief Add the planned step of the joint to its motor and to the coupled motors.
+   *
+   * @note Called from the step timer interrupt for all joints, before follow().
+   * @param joint Axis index of the joint.
+   * @param step The joint steps in this period.
+   * @param forward Direction of the joint.
+   */
+  void add(uint8_t joint, bool step, bool forward);
+
+  /**
+   * @brief Output of the motor in this timer period.
+   *
+   * @note Called from the step timer interrupt.
+   * @param axis Axis index.
+   * @return Output Axis output.
+   */
+  Output follow(uint8_t axis);
+
+  /**
+   * @brief Direction of the motor.
+   *
+   * @param axis Axis index.
+   * @return true Forward.
+   * @return false Backward.
+   */
+  bool forward(uint8_t axis) const;
+
+private:
+  /**
+   * @brief Motor steps per joint step, by motor and joint. [Q16.16]
+   *
+   */
+  volatile int32_t m_ratio[COUPLING_AXISES][COUPLING_AXISES];
+
+  /**
+   * @brief Steps the motor has to output. [steps, Q16.16]
+   *
+   */
+  volatile int32_t m_pending[COUPLING_AXISES];
+
+  /**
+   * @brief Output direction.
+   *
+   */
+  bool m_forward[COUPLING_AXISES];
+};
+
+#endif // _JOINTCOUPLING_h
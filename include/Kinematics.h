@@ -0,0 +1,234 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _KINEMATICS_h
+#define _KINEMATICS_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#pragma region Definitions
+
+/**
+ * @brief Number of the arm joints, base, shoulder, elbow, wrist pitch and wrist roll.
+ *
+ */
+#define KINEMATICS_JOINTS 5
+
+#if !defined(KINEMATICS_DAMPING)
+/**
+ * @brief Damping of the joint rates near the singular poses. [mm]
+ *
+ */
+#define KINEMATICS_DAMPING 10.0F
+#endif // !defined(KINEMATICS_DAMPING)
+
+#pragma endregion // Definitions
+
+#pragma region Types
+
+/**
+ * @brief Pose of the tool.
+ *
+ */
+struct KinematicsPose
+{
+  float X;     ///< Forward of the base. [mm]
+  float Y;     ///< Left of the base. [mm]
+  float Z;     ///< Up from the base plate. [mm]
+  float Pitch; ///< Tool angle over the horizontal. [deg]
+  float Roll;  ///< Tool angle around its axis. [deg]
+};
+
+#pragma endregion // Types
+
+/**
+ * @brief Kinematics of the Robko 01 arm.
+ *
+ * The base turns around the vertical axis, the shoulder, the elbow and the
+ * wrist pitch turn in the vertical plane of the arm. The shoulder angle is
+ * over the horizontal, the elbow and the wrist pitch angles are to the
+ * previous link, so the tool pitch is the sum of the three. The wrist roll
+ * turns the tool around its axis and does not move the tool point.
+ *
+ * The joint angles are the joint steps less the zero steps over the steps
+ * per degree. The wrist joints are the pitch and the roll, not the motors
+ * of the differential.
+ *
+ * The pose is kept with the steps it is computed from, it is computed
+ * again only when the steps change.
+ *
+ * The inverse solution takes the base angle toward the tool point and the
+ * elbow on the side of the given angles, so a path solved point by point
+ * does not jump between the two elbow solutions.
+ *
+ * The joint rates of a tool velocity are the damped least squares
+ * solution of the Jacobian, so they stay bounded over the base axis and
+ * with the arm stretched, where the tool can not move in every direction.
+ */
+class Kinematics
+{
+public:
+  /**
+   * @brief Construct a new Kinematics object.
+   *
+   */
+  Kinematics();
+
+  /**
+   * @brief Set the lengths of the links.
+   *
+   * @param base Height of the shoulder axis over the base plate. [mm]
+   * @param upperArm Shoulder to the elbow axis. [mm]
+   * @param forearm Elbow to the wrist axis. [mm]
+   * @param tool Wrist axis to the tool point. [mm]
+   */
+  void setLinks(float base, float upperArm, float forearm, float tool);
+
+  /**
+   * @brief Set the calibration of a joint.
+   *
+   * @param index Joint index.
+   * @param stepsPerDegree Joint steps of one degree, the sign is the direction. [steps/deg]
+   * @param zero Joint angle on zero steps. [deg]
+   */
+  void setJoint(uint8_t index, float stepsPerDegree, float zero);
+
+  /**
+   * @brief Joint angles of the joint steps.
+   *
+   * @param steps Joint positions. [steps]
+   * @param angles Joint angles. [deg]
+   */
+  void angles(const long *steps, float *angles) const;
+
+  /**
+   * @brief Joint steps of the joint angles.
+   *
+   * @param angles Joint angles. [deg]
+   * @param steps Joint positions. [steps]
+   */
+  void steps(const float *angles, long *steps) const;
+
+  /**
+   * @brief Pose of the joint angles.
+   *
+   * @param angles Joint angles. [deg]
+   * @param pose Tool pose.
+   */
+  void forward(const float *angles, KinematicsPose &pose) const;
+
+  /**
+   * @brief Joint angles of the pose.
+   *
+   * @param pose Tool pose.
+   * @param angles Joint angles near the solution in, the solution out. [deg]
+   * @return true Solved.
+   * @return false The pose is out of reach, the angles are not changed.
+   */
+  bool inverse(const KinematicsPose &pose, float *angles) const;
+
+  /**
+   * @brief Joint rates of a tool velocity.
+   *
+   * @param angles Joint angles. [deg]
+   * @param velocity Tool velocity. [mm/s, deg/s]
+   * @param rates Joint rates. [deg/s]
+   */
+  void inverseRate(const float *angles, const KinematicsPose &velocity, float *rates) const;
+
+  /**
+   * @brief Joint step rates of the joint rates.
+   *
+   * @param rates Joint rates. [deg/s]
+   * @param stepRates Joint step rates. [steps/s]
+   */
+  void stepRates(const float *rates, float *stepRates) const;
+
+  /**
+   * @brief Pose of the joint steps, computed only when the steps change.
+   *
+   * @param steps Joint positions. [steps]
+   * @return const KinematicsPose& Tool pose.
+   */
+  const KinematicsPose &pose(const long *steps);
+
+private:
+  /**
+   * @brief Height of the shoulder axis. [mm]
+   *
+   */
+  float m_base;
+
+  /**
+   * @brief Length of the upper arm. [mm]
+   *
+   */
+  float m_upperArm;
+
+  /**
+   * @brief Length of the forearm. [mm]
+   *
+   */
+  float m_forearm;
+
+  /**
+   * @brief Length of the tool. [mm]
+   *
+   */
+  float m_tool;
+
+  /**
+   * @brief Joint steps of one degree. [steps/deg]
+   *
+   */
+  float m_stepsPerDegree[KINEMATICS_JOINTS];
+
+  /**
+   * @brief Joint angles on zero steps. [deg]
+   *
+   */
+  float m_zero[KINEMATICS_JOINTS];
+
+  /**
+   * @brief Joint steps of the kept pose. [steps]
+   *
+   */
+  long m_steps[KINEMATICS_JOINTS];
+
+  /**
+   * @brief Kept pose.
+   *
+   */
+  KinematicsPose m_pose;
+
+  /**
+   * @brief The kept pose is computed with the current calibration.
+   *
+   */
+  bool m_valid;
+};
+
+#endif // _KINEMATICS_h
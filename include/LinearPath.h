@@ -0,0 +1,195 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _LINEARPATH_h
+#define _LINEARPATH_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#include "Kinematics.h"
+
+/**
+ * @brief Straight line of the tool between two poses.
+ *
+ * The tool point moves on the line and the pitch and the roll turn with
+ * it, all on one trapezoidal profile. The length of the profile is the
+ * line length, or the turn over the angular speed when the turn is
+ * longer, so a pure turn of the tool moves too.
+ *
+ * The path is cut in points one period apart, the last point is on the
+ * target. The points are taken in order with next().
+ */
+class LinearPath
+{
+public:
+  /**
+   * @brief Construct a new Linear Path object.
+   *
+   */
+  LinearPath();
+
+  /**
+   * @brief Plan the path.
+   *
+   * @param from Start pose.
+   * @param to Target pose.
+   * @param speed Tool point speed. [mm/s]
+   * @param accel Tool point acceleration. [mm/s^2]
+   * @param angularSpeed Tool turn speed. [deg/s]
+   * @param period Time between the points. [s]
+   * @return true The path is planned, the first point is next.
+   * @return false Nothing to move or wrong parameters.
+   */
+  bool begin(const KinematicsPose &from, const KinematicsPose &to, float speed, float accel, float angularSpeed, float period);
+
+  /**
+   * @brief Time of the path.
+   *
+   * @return float Duration. [s]
+   */
+  float duration() const;
+
+  /**
+   * @brief Number of the points.
+   *
+   * @return uint16_t Points count.
+   */
+  uint16_t points() const;
+
+  /**
+   * @brief Time of a point.
+   *
+   * @param point Point, 0 is the start, points() is the target.
+   * @return float Time from the start. [s]
+   */
+  float time(uint16_t point) const;
+
+  /**
+   * @brief Pose on the path.
+   *
+   * @param time Time from the start. [s]
+   * @param pose Tool pose.
+   */
+  void sample(float time, KinematicsPose &pose) const;
+
+  /**
+   * @brief Next point to take.
+   *
+   * @return uint16_t Point.
+   */
+  uint16_t next() const;
+
+  /**
+   * @brief Take the next point.
+   *
+   */
+  void advance();
+
+  /**
+   * @brief Drop the points left.
+   *
+   */
+  void stop();
+
+  /**
+   * @brief Check if points are left.
+   *
+   * @return true Points are left.
+   * @return false The path is taken or stopped.
+   */
+  bool isRunning() const;
+
+private:
+  /**
+   * @brief Distance on the profile at the time.
+   *
+   * @param time Time from the start. [s]
+   * @return float Distance. [mm]
+   */
+  float distance(float time) const;
+
+  /**
+   * @brief Start pose.
+   *
+   */
+  KinematicsPose m_from;
+
+  /**
+   * @brief Target pose.
+   *
+   */
+  KinematicsPose m_to;
+
+  /**
+   * @brief Length of the profile. [mm]
+   *
+   */
+  float m_length;
+
+  /**
+   * @brief Cruise speed. [mm/s]
+   *
+   */
+  float m_speed;
+
+  /**
+   * @brief Acceleration. [mm/s^2]
+   *
+   */
+  float m_accel;
+
+  /**
+   * @brief Acceleration time. [s]
+   *
+   */
+  float m_accelTime;
+
+  /**
+   * @brief Time of the path. [s]
+   *
+   */
+  float m_duration;
+
+  /**
+   * @brief Time between the points. [s]
+   *
+   */
+  float m_period;
+
+  /**
+   * @brief Number of the points.
+   *
+   */
+  uint16_t m_points;
+
+  /**
+   * @brief Next point, 0 when stopped.
+   *
+   */
+  uint16_t m_next;
+};
+
+#endif // _LINEARPATH_h
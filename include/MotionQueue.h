@@ -0,0 +1,165 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _MOTIONQUEUE_h
+#define _MOTIONQUEUE_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+/**
+ * @brief Ring buffer of motion segments.
+ *
+ * @note Not interrupt safe, it is used from the main loop only.
+ * @tparam T Segment type.
+ * @tparam Capacity Maximum number of segments.
+ */
+template <typename T, uint8_t Capacity>
+class MotionQueue
+{
+public:
+  /**
+   * @brief Construct a new Motion Queue object.
+   *
+   */
+  MotionQueue()
+    : m_head(0), m_count(0)
+  {
+  }
+
+  /**
+   * @brief Add segment at the end.
+   *
+   * @param segment Segment.
+   * @return true Added.
+   * @return false The queue is full.
+   */
+  bool push(const T &segment)
+  {
+    if (m_count >= Capacity)
+    {
+      return false;
+    }
+    m_segments[(m_head + m_count) % Capacity] = segment;
+    m_count++;
+
+    return true;
+  }
+
+  /**
+   * @brief Remove the first segment.
+   *
+   */
+  void pop()
+  {
+    if (m_count == 0)
+    {
+      return;
+    }
+    m_head = (m_head + 1) % Capacity;
+    m_count--;
+  }
+
+  /**
+   * @brief First segment.
+   *
+   * @return const T& Segment, valid while count() > 0.
+   */
+  const T &front() const
+  {
+    return m_segments[m_head];
+  }
+
+  /**
+   * @brief Last segment.
+   *
+   * @return const T& Segment, valid while count() > 0.
+   */
+  const T &back() const
+  {
+    return m_segments[(m_head + m_count + Capacity - 1) % Capacity];
+  }
+
+  /**
+   * @brief Remove all segments.
+   *
+   */
+  void clear()
+  {
+    m_head = 0;
+    m_count = 0;
+  }
+
+  /**
+   * @brief Number of the segments.
+   *
+   * @return uint8_t Segments count.
+   */
+  uint8_t count() const
+  {
+    return m_count;
+  }
+
+  /**
+   * @brief Number of the free places.
+   *
+   * @return uint8_t Free places count.
+   */
+  uint8_t available() const
+  {
+    return Capacity - m_count;
+  }
+
+  /**
+   * @brief Maximum number of segments.
+   *
+   * @return uint8_t Capacity.
+   */
+  static uint8_t capacity()
+  {
+    return Capacity;
+  }
+
+private:
+  /**
+   * @brief Segments storage.
+   *
+   */
+  T m_segments[Capacity];
+
+  /**
+   * @brief Index of the first segment.
+   *
+   */
+  uint8_t m_head;
+
+  /**
+   * @brief Number of the segments.
+   *
+   */
+  uint8_t m_count;
+};
+
+#endif // _MOTIONQUEUE_h
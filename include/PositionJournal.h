@@ -0,0 +1,190 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _POSITIONJOURNAL_h
+#define _POSITIONJOURNAL_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Preferences.h>
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+#pragma region Definitions
+
+#if !defined(JOURNAL_AXISES)
+/**
+ * @brief Number of the journaled axises.
+ *
+ */
+#define JOURNAL_AXISES 6
+#endif // !defined(JOURNAL_AXISES)
+
+#if !defined(JOURNAL_SLOTS)
+/**
+ * @brief Number of the record slots, the writes go round them.
+ *
+ */
+#define JOURNAL_SLOTS 8
+#endif // !defined(JOURNAL_SLOTS)
+
+#pragma endregion // Definitions
+
+#pragma region Types
+
+/**
+ * @brief Journal record, the positions of all axises at one time.
+ *
+ */
+struct JournalRecord
+{
+  uint32_t Sequence;                ///< Number of the record, one more than the previous.
+  int32_t Position[JOURNAL_AXISES]; ///< Positions. [steps]
+  uint8_t Valid;                    ///< Axises with a homed position, bit per axis.
+  uint8_t Moving;                   ///< Written on the start of a motion.
+  uint16_t Crc;                     ///< CRC-16/CCITT of the fields before it.
+};
+
+#pragma endregion // Types
+
+/**
+ * @brief Append only journal of the axis positions in the flash.
+ *
+ * The records go round JOURNAL_SLOTS slots of the NVS namespace, every new
+ * record has the next sequence number and overwrites the oldest one. The
+ * NVS spreads the writes over its pages, and a record lost in a power
+ * failure leaves the previous one in its slot.
+ *
+ * A record is written when the motion stops, or when the positions or the
+ * valid axises change at rest. One more record marks the start of a motion,
+ * so after a reset in the motion the journal knows the positions are lost.
+ *
+ * On the boot the newest record with a good CRC and slot gives the
+ * positions back, unless it marks a motion.
+ */
+class PositionJournal
+{
+public:
+  /**
+   * @brief Construct a new Position Journal object.
+   *
+   */
+  PositionJournal();
+
+  /**
+   * @brief Open the journal and find the newest record.
+   *
+   * @param name NVS namespace.
+   * @return true A record is found.
+   * @return false The journal is empty.
+   */
+  bool begin(const char *name);
+
+  /**
+   * @brief Positions of the newest record.
+   *
+   * @param positions Positions of the axises. [steps]
+   * @param valid Axises with a homed position, bit per axis.
+   * @return true The positions are restored.
+   * @return false No record, or the last record marks a motion.
+   */
+  bool restore(long *positions, uint8_t &valid) const;
+
+  /**
+   * @brief Append a record, when it differs from the last one.
+   *
+   * @param positions Positions of the axises. [steps]
+   * @param valid Axises with a homed position, bit per axis.
+   * @param moving The axises start to move.
+   * @return true Written.
+   * @return false Nothing new, or the write failed.
+   */
+  bool write(const long *positions, uint8_t valid, bool moving);
+
+  /**
+   * @brief Sequence number of the newest record.
+   *
+   * @return uint32_t Sequence, 0 without records.
+   */
+  uint32_t sequence() const;
+
+  /**
+   * @brief CRC-16/CCITT of the data.
+   *
+   * @param data Data.
+   * @param length Length of the data.
+   * @return uint16_t CRC.
+   */
+  static uint16_t crc(const uint8_t *data, size_t length);
+
+private:
+  /**
+   * @brief Read the record of the slot.
+   *
+   * @param slot Slot.
+   * @param record Record.
+   * @return true A good record of this slot.
+   * @return false Empty or broken slot.
+   */
+  bool read(uint8_t slot, JournalRecord &record);
+
+  /**
+   * @brief Write the record in its slot.
+   *
+   * @param record Record.
+   * @return true Written.
+   * @return false The write failed.
+   */
+  bool store(const JournalRecord &record);
+
+#if defined(ARDUINO_ARCH_ESP32)
+  /**
+   * @brief NVS namespace of the journal.
+   *
+   */
+  Preferences m_preferences;
+#else
+  /**
+   * @brief Slots in the RAM, without a flash.
+   *
+   */
+  JournalRecord m_slots[JOURNAL_SLOTS];
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+  /**
+   * @brief Newest record.
+   *
+   */
+  JournalRecord m_last;
+
+  /**
+   * @brief The newest record is found or written.
+   *
+   */
+  bool m_hasLast;
+};
+
+#endif // _POSITIONJOURNAL_h
@@ -0,0 +1,443 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _PVTSTREAM_h
+#define _PVTSTREAM_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#if !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif // !defined(IRAM_ATTR)
+
+#pragma region Definitions
+
+#if !defined(PVT_AXISES)
+/**
+ * @brief Number of the streamed axises.
+ *
+ */
+#define PVT_AXISES 6
+#endif // !defined(PVT_AXISES)
+
+#if !defined(PVT_BUFFER_SIZE)
+/**
+ * @brief Number of the buffered points.
+ *
+ */
+#define PVT_BUFFER_SIZE 32
+#endif // !defined(PVT_BUFFER_SIZE)
+
+#if !defined(PVT_LATENCY_MS)
+/**
+ * @brief Default latency window. [ms]
+ *
+ */
+#define PVT_LATENCY_MS 100
+#endif // !defined(PVT_LATENCY_MS)
+
+#if !defined(PVT_POINT_PERIOD_MS)
+/**
+ * @brief Nominal time between the points of the host. [ms]
+ *
+ */
+#define PVT_POINT_PERIOD_MS 20
+#endif // !defined(PVT_POINT_PERIOD_MS)
+
+#if !defined(PVT_LATENCY_MAX_MS)
+/**
+ * @brief Longest latency window, the buffer holds it with a place for the next point. [ms]
+ *
+ */
+#define PVT_LATENCY_MAX_MS ((PVT_BUFFER_SIZE - 1) * PVT_POINT_PERIOD_MS)
+#endif // !defined(PVT_LATENCY_MAX_MS)
+
+/**
+ * @brief Rate of the interpolated positions. [Hz]
+ *
+ */
+#define PVT_SAMPLE_FREQUENCY 1000UL
+
+#pragma endregion // Definitions
+
+#pragma region Types
+
+/**
+ * @brief Position, velocity and time point of all axises.
+ *
+ */
+struct PvtPoint
+{
+  int32_t Position[PVT_AXISES]; ///< Absolute position. [steps]
+  int32_t Velocity[PVT_AXISES]; ///< Velocity at the point. [steps/s]
+  uint16_t Duration;            ///< Time from the previous point. [ms]
+};
+
+#pragma endregion // Types
+
+/**
+ * @brief Streaming of host planned position-velocity-time points.
+ *
+ * The points are buffered until they cover the latency window, then they
+ * are played back with cubic Hermite interpolation between them. A late
+ * point does not stop the motion as long as the buffer holds, so the
+ * jitter of the link does not reach the motion.
+ *
+ * The segments are prepared in the main loop as forward differences in
+ * Q32.32. The interrupt advances them at PVT_SAMPLE_FREQUENCY with integer
+ * additions only, and spreads the steps of every sample over its timer
+ * periods.
+ *
+ * When the buffer runs empty while the last point still has velocity,
+ * the axises hold on that point and an underrun is counted. The stream
+ * waits for the latency window again before it continues.
+ *
+ * A stop leaves the path, every axis ramps its velocity down to zero with
+ * its own acceleration.
+ */
+class PvtStream
+{
+public:
+  /**
+   * @brief States of the stream.
+   *
+   */
+  typedef enum
+  {
+    IDLE = 0,      ///< No stream.
+    BUFFERING = 1, ///< Waiting for the latency window.
+    PLAYING = 2,   ///< Points are played.
+  } State;
+
+  /**
+   * @brief Axis outputs of one timer period.
+   *
+   */
+  typedef enum
+  {
+    NONE = 0, ///< Nothing to do.
+    TURN = 1, ///< Set the direction, the step comes on the next period.
+    STEP = 2, ///< Step in the current direction.
+  } Output;
+
+  /**
+   * @brief Construct a new Pvt Stream object.
+   *
+   */
+  PvtStream();
+
+  /**
+   * @brief Start the stream from the current positions.
+   *
+   * @param positions Current positions of the axises. [steps]
+   * @param timerFrequency Step timer frequency. [Hz]
+   */
+  void begin(const long *positions, uint32_t timerFrequency);
+
+  /**
+   * @brief Add point at the end of the buffer.
+   *
+   * @param point Point.
+   * @return true Added.
+   * @return false The buffer is full or the stream stops.
+   */
+  bool push(const PvtPoint &point);
+
+  /**
+   * @brief Prepare the next segment for the interrupt, called from the main loop.
+   *
+   */
+  void update();
+
+  /**
+   * @brief Set the acceleration of the axis for the stop.
+   *
+   * @param index Axis index.
+   * @param acceleration Acceleration, 0 stops at once. [steps/s^2]
+   */
+  void setAcceleration(uint8_t index, float acceleration);
+
+  /**
+   * @brief Drop the points and ramp the axises down to a stand still.
+   *
+   */
+  void stop();
+
+  /**
+   * @brief Drop the stream at once, the axises hold.
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Set the latency window.
+   *
+   * @param latency Buffered time before the playback. [ms]
+   * @return true Set.
+   * @return false Longer than PVT_LATENCY_MAX_MS.
+   */
+  bool setLatency(uint16_t latency);
+
+  /**
+   * @brief Get the latency window.
+   *
+   * @return uint16_t Latency. [ms]
+   */
+  uint16_t latency() const;
+
+  /**
+   * @brief Get the state.
+   *
+   * @return State State.
+   */
+  State state() const;
+
+  /**
+   * @brief Check if the stream moves the axises.
+   *
+   * @return true Buffering or playing.
+   * @return false Idle.
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief Number of the buffered points.
+   *
+   * @return uint8_t Points count.
+   */
+  uint8_t count() const;
+
+  /**
+   * @brief Number of the free places in the buffer.
+   *
+   * @return uint8_t Free places count.
+   */
+  uint8_t available() const;
+
+  /**
+   * @brief Buffered time.
+   *
+   * @return uint32_t Time of the buffered points. [ms]
+   */
+  uint32_t buffered() const;
+
+  /**
+   * @brief Number of the underruns since begin().
+   *
+   * @return uint16_t Underruns count.
+   */
+  uint16_t underruns() const;
+
+  /**
+   * @brief Advance the stream with one timer period.
+   *
+   * @note Called from the step timer interrupt, before follow().
+   * @return true The stream drives the axises.
+   * @return false No stream.
+   */
+  bool tick();
+
+  /**
+   * @brief Output of the axis in this timer period.
+   *
+   * @note Called from the step timer interrupt, only when tick() is true.
+   * @param index Axis index.
+   * @return Output Axis output.
+   */
+  Output follow(uint8_t index);
+
+  /**
+   * @brief Direction of the axis.
+   *
+   * @param index Axis index.
+   * @return true Forward.
+   * @return false Backward.
+   */
+  bool forward(uint8_t index) const;
+
+private:
+  /**
+   * @brief Interpolation segment, cubic forward differences in Q32.32.
+   *
+   */
+  struct Segment
+  {
+    int64_t Position[PVT_AXISES];     ///< Position. [steps, Q32.32]
+    int64_t Delta1[PVT_AXISES];       ///< First difference. [steps/sample, Q32.32]
+    int64_t Delta2[PVT_AXISES];       ///< Second difference. [Q32.32]
+    int64_t Delta3[PVT_AXISES];       ///< Third difference. [Q32.32]
+    int32_t End[PVT_AXISES];          ///< Position at the end. [steps]
+    uint32_t Samples;                 ///< Length of the segment. [samples]
+    bool Moving;                      ///< The end point has velocity.
+  };
+
+  /**
+   * @brief Build the segment to the first buffered point.
+   *
+   * @param segment Segment.
+   */
+  void prepare(Segment &segment);
+
+  /**
+   * @brief Buffered points.
+   *
+   */
+  PvtPoint m_points[PVT_BUFFER_SIZE];
+
+  /**
+   * @brief Index of the first point.
+   *
+   */
+  uint8_t m_head;
+
+  /**
+   * @brief Number of the points.
+   *
+   */
+  uint8_t m_count;
+
+  /**
+   * @brief Time of the buffered points. [ms]
+   *
+   */
+  uint32_t m_buffered;
+
+  /**
+   * @brief Latency window. [ms]
+   *
+   */
+  uint16_t m_latency;
+
+  /**
+   * @brief End position of the last prepared segment. [steps]
+   *
+   */
+  int32_t m_lastPosition[PVT_AXISES];
+
+  /**
+   * @brief End velocity of the last prepared segment. [steps/s]
+   *
+   */
+  int32_t m_lastVelocity[PVT_AXISES];
+
+  /**
+   * @brief Segment played by the interrupt.
+   *
+   */
+  Segment m_current;
+
+  /**
+   * @brief Segment prepared for the interrupt.
+   *
+   */
+  Segment m_next;
+
+  /**
+   * @brief The next segment is ready.
+   *
+   */
+  volatile bool m_nextReady;
+
+  /**
+   * @brief The current segment is played.
+   *
+   */
+  volatile bool m_playing;
+
+  /**
+   * @brief Samples left of the current segment.
+   *
+   */
+  uint32_t m_samples;
+
+  /**
+   * @brief Timer periods per sample.
+   *
+   */
+  uint32_t m_ticksPerSample;
+
+  /**
+   * @brief Timer periods left of the current sample.
+   *
+   */
+  uint32_t m_ticks;
+
+  /**
+   * @brief The axises ramp down to a stand still.
+   *
+   */
+  volatile bool m_stopping;
+
+  /**
+   * @brief Velocity change per sample on the stop. [steps/sample^2, Q32.32]
+   *
+   */
+  int64_t m_deceleration[PVT_AXISES];
+
+  /**
+   * @brief Velocity of the last sample. [steps/sample, Q32.32]
+   *
+   */
+  int64_t m_velocity[PVT_AXISES];
+
+  /**
+   * @brief Interpolated position inside the sample. [steps, Q32.32]
+   *
+   */
+  int64_t m_target[PVT_AXISES];
+
+  /**
+   * @brief Position change per timer period. [steps, Q32.32]
+   *
+   */
+  int64_t m_increment[PVT_AXISES];
+
+  /**
+   * @brief Output position. [steps]
+   *
+   */
+  int32_t m_output[PVT_AXISES];
+
+  /**
+   * @brief Output direction.
+   *
+   */
+  bool m_forward[PVT_AXISES];
+
+  /**
+   * @brief Underruns count.
+   *
+   */
+  volatile uint16_t m_underruns;
+
+  /**
+   * @brief State.
+   *
+   */
+  volatile State m_state;
+};
+
+#endif // _PVTSTREAM_h
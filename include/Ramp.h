@@ -0,0 +1,181 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _RAMP_h
+#define _RAMP_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#pragma region Definitions
+
+#if !defined(RAMP_TABLE_SIZE)
+/**
+ * @brief Number of the ramp steps with exact intervals,
+ * after them the intervals are computed incrementally.
+ *
+ */
+#define RAMP_TABLE_SIZE 64
+#endif // !defined(RAMP_TABLE_SIZE)
+
+#if !defined(RAMP_SCURVE_SIZE)
+/**
+ * @brief Number of the intervals of the jerk limited ramp,
+ * the whole ramp up to the cruise speed has to fit in.
+ *
+ */
+#define RAMP_SCURVE_SIZE 256
+#endif // !defined(RAMP_SCURVE_SIZE)
+
+/**
+ * @brief Fraction bits of the step intervals.
+ *
+ */
+#define RAMP_INTERVAL_SHIFT 8
+
+/**
+ * @brief One timer tick in the fixed point step intervals.
+ *
+ */
+#define RAMP_TICK (1UL << RAMP_INTERVAL_SHIFT)
+
+#pragma endregion // Definitions
+
+#pragma region Types
+
+/**
+ * @brief Step intervals of the acceleration ramp.
+ *
+ */
+struct RampTable
+{
+  uint32_t Frequency;                  ///< Step timer frequency of the intervals. [Hz]
+  float Acceleration;                  ///< Acceleration of the ramp. [steps/s^2]
+  uint32_t Intervals[RAMP_TABLE_SIZE]; ///< Interval after ramp step n. [ticks, Q8]
+};
+
+/**
+ * @brief Step intervals of the jerk limited (S-curve) ramp.
+ *
+ * The table holds the ramp from the stand still up to the cruise speed,
+ * the last interval is the cruise interval.
+ */
+struct SCurveTable
+{
+  uint32_t Frequency;                   ///< Step timer frequency of the intervals. [Hz]
+  float Acceleration;                   ///< Maximum acceleration of the ramp. [steps/s^2]
+  float Jerk;                           ///< Jerk of the ramp. [steps/s^3]
+  float MaxSpeed;                       ///< Requested cruise speed. [steps/s]
+  uint16_t Count;                       ///< Number of the valid intervals.
+  uint32_t Intervals[RAMP_SCURVE_SIZE]; ///< Interval after ramp step n. [ticks, Q8]
+};
+
+/**
+ * @brief Compile time indexes of the ramp table.
+ *
+ */
+template <uint32_t... I>
+struct RampIndexes
+{
+};
+
+template <uint32_t N, uint32_t... I>
+struct RampIndexesMake : RampIndexesMake<N - 1, N - 1, I...>
+{
+};
+
+template <uint32_t... I>
+struct RampIndexesMake<0, I...>
+{
+  typedef RampIndexes<I...> Type;
+};
+
+#pragma endregion // Types
+
+#pragma region Functions
+
+/**
+ * @brief Newton iterations of the square root.
+ *
+ * @param x Value.
+ * @param guess Current guess.
+ * @param count Iterations left.
+ * @return constexpr double Square root.
+ */
+constexpr double ramp_sqrt_iterate(double x, double guess, uint8_t count)
+{
+  return (count == 0) ? guess : ramp_sqrt_iterate(x, 0.5 * (guess + x / guess), count - 1);
+}
+
+/**
+ * @brief Square root usable by the compiler.
+ *
+ * @param x Value.
+ * @return constexpr double Square root.
+ */
+constexpr double ramp_sqrt(double x)
+{
+  return (x <= 0.0) ? 0.0 : ramp_sqrt_iterate(x, (x > 1.0) ? x : 1.0, 48);
+}
+
+/**
+ * @brief Interval after ramp step n, t(n) = sqrt(2 * n / a).
+ *
+ * The first interval has the 0.676 correction of AccelStepper.
+ *
+ * @param frequency Step timer frequency. [Hz]
+ * @param acceleration Acceleration. [steps/s^2]
+ * @param n Ramp step.
+ * @return constexpr uint32_t Interval. [ticks, Q8]
+ */
+constexpr uint32_t ramp_interval(uint32_t frequency, double acceleration, uint32_t n)
+{
+  return (uint32_t)((double)RAMP_TICK * frequency * ramp_sqrt(2.0 / acceleration) *
+                        ((n == 0) ? 0.676 : (ramp_sqrt(n + 1.0) - ramp_sqrt(n))) +
+                    0.5);
+}
+
+template <uint32_t Frequency, uint32_t Acceleration, uint32_t... I>
+constexpr RampTable ramp_table(RampIndexes<I...>)
+{
+  return {Frequency, (float)Acceleration, {ramp_interval(Frequency, Acceleration, I)...}};
+}
+
+/**
+ * @brief Ramp table built by the compiler.
+ *
+ * @tparam Frequency Step timer frequency. [Hz]
+ * @tparam Acceleration Acceleration. [steps/s^2]
+ * @return constexpr RampTable Ramp table.
+ */
+template <uint32_t Frequency, uint32_t Acceleration>
+constexpr RampTable ramp_table()
+{
+  return ramp_table<Frequency, Acceleration>(typename RampIndexesMake<RAMP_TABLE_SIZE>::Type());
+}
+
+#pragma endregion // Functions
+
+#endif // _RAMP_h
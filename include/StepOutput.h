@@ -0,0 +1,252 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _STEPOUTPUT_h
+#define _STEPOUTPUT_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "soc/gpio_struct.h"
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+#if !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif // !defined(IRAM_ATTR)
+
+#pragma region Definitions
+
+#if !defined(ARDUINO_ARCH_ESP32)
+/**
+ * @brief Number of register writes kept by the host backend.
+ *
+ */
+#define STEP_OUTPUT_RECORDS 256
+#endif // !defined(ARDUINO_ARCH_ESP32)
+
+#pragma endregion // Definitions
+
+#pragma region Types
+
+/**
+ * @brief Pins mask over the two ESP32 GPIO output banks.
+ *
+ */
+struct StepOutputMask
+{
+  uint32_t Low;  ///< GPIO 0 - 31.
+  uint32_t High; ///< GPIO 32 - 39.
+};
+
+#if !defined(ARDUINO_ARCH_ESP32)
+/**
+ * @brief One output of the step timer period, host backend only.
+ *
+ */
+struct StepOutputRecord
+{
+  StepOutputMask DirSet;   ///< Direction pins driven HIGH.
+  StepOutputMask DirClear; ///< Direction pins driven LOW.
+  StepOutputMask Step;     ///< Step pins pulsed.
+};
+#endif // !defined(ARDUINO_ARCH_ESP32)
+
+#pragma endregion // Types
+
+#pragma region Functions
+
+/**
+ * @brief Mask of one GPIO pin.
+ *
+ * @param pin GPIO pin.
+ * @return constexpr StepOutputMask Mask.
+ */
+constexpr StepOutputMask step_output_mask(uint8_t pin)
+{
+  return {
+    (pin < 32) ? (1U << pin) : 0U,
+    (pin < 32) ? 0U : (1U << (pin - 32))};
+}
+
+/**
+ * @brief Mask of pins given as bits over GPIO 0 - 39.
+ *
+ * @param pins Pins bits.
+ * @return constexpr StepOutputMask Mask.
+ */
+constexpr StepOutputMask step_output_pins(uint64_t pins)
+{
+  return {(uint32_t)(pins & 0xFFFFFFFFULL), (uint32_t)(pins >> 32)};
+}
+
+/**
+ * @brief Join two masks.
+ *
+ * @param a First mask.
+ * @param b Second mask.
+ * @return constexpr StepOutputMask Mask of the both.
+ */
+constexpr StepOutputMask step_output_join(StepOutputMask a, StepOutputMask b)
+{
+  return {a.Low | b.Low, a.High | b.High};
+}
+
+#pragma endregion // Functions
+
+/**
+ * @brief Step and direction output of all axises.
+ *
+ * The step timer interrupt adds the state of every axis and writes the
+ * result with one register access per bank: the direction pins first,
+ * then the due step pulses. The pulses end with clear() at the beginning
+ * of the next period, so all axises step on the same edge.
+ *
+ * On any other target than ESP32 the writes are recorded, so the output
+ * of the step engine can be checked on the host.
+ */
+class StepOutput
+{
+public:
+  /**
+   * @brief Construct a new Step Output object.
+   *
+   */
+  StepOutput()
+    : m_dirSet{0, 0}, m_dirClear{0, 0}, m_step{0, 0}
+  {
+  }
+
+  /**
+   * @brief Add the state of one axis.
+   *
+   * @param step Step pulse is due.
+   * @param dirLevel Level of the direction pin.
+   * @param stepMask Mask of the step pin.
+   * @param dirMask Mask of the direction pin.
+   */
+  inline void IRAM_ATTR add(bool step, bool dirLevel, const StepOutputMask &stepMask, const StepOutputMask &dirMask)
+  {
+    if (dirLevel)
+    {
+      m_dirSet = step_output_join(m_dirSet, dirMask);
+    }
+    else
+    {
+      m_dirClear = step_output_join(m_dirClear, dirMask);
+    }
+
+    if (step)
+    {
+      m_step = step_output_join(m_step, stepMask);
+    }
+  }
+
+  /**
+   * @brief Write the collected direction levels and step pulses.
+   *
+   */
+  inline void IRAM_ATTR write()
+  {
+#if defined(ARDUINO_ARCH_ESP32)
+    GPIO.out_w1ts = m_dirSet.Low;
+    GPIO.out1_w1ts.val = m_dirSet.High;
+    GPIO.out_w1tc = m_dirClear.Low;
+    GPIO.out1_w1tc.val = m_dirClear.High;
+
+    if ((m_step.Low | m_step.High) != 0)
+    {
+      GPIO.out_w1ts = m_step.Low;
+      GPIO.out1_w1ts.val = m_step.High;
+    }
+#else
+    StepOutputRecord *RecordL = &records()[recordsCount() % STEP_OUTPUT_RECORDS];
+    RecordL->DirSet = m_dirSet;
+    RecordL->DirClear = m_dirClear;
+    RecordL->Step = m_step;
+    recordsCount()++;
+#endif // defined(ARDUINO_ARCH_ESP32)
+  }
+
+  /**
+   * @brief End the step pulses.
+   *
+   * @param stepMask Mask of all step pins.
+   */
+  static inline void IRAM_ATTR clear(const StepOutputMask &stepMask)
+  {
+#if defined(ARDUINO_ARCH_ESP32)
+    GPIO.out_w1tc = stepMask.Low;
+    GPIO.out1_w1tc.val = stepMask.High;
+#else
+    (void)stepMask;
+#endif // defined(ARDUINO_ARCH_ESP32)
+  }
+
+#if !defined(ARDUINO_ARCH_ESP32)
+  /**
+   * @brief Recorded writes, host backend only.
+   *
+   * @return StepOutputRecord* Ring of the last STEP_OUTPUT_RECORDS writes.
+   */
+  static StepOutputRecord *records()
+  {
+    static StepOutputRecord RecordsL[STEP_OUTPUT_RECORDS];
+    return RecordsL;
+  }
+
+  /**
+   * @brief Number of writes since the start, host backend only.
+   *
+   * @return uint32_t& Writes count.
+   */
+  static uint32_t &recordsCount()
+  {
+    static uint32_t CountL = 0;
+    return CountL;
+  }
+#endif // !defined(ARDUINO_ARCH_ESP32)
+
+private:
+  /**
+   * @brief Direction pins to set.
+   *
+   */
+  StepOutputMask m_dirSet;
+
+  /**
+   * @brief Direction pins to clear.
+   *
+   */
+  StepOutputMask m_dirClear;
+
+  /**
+   * @brief Step pins to pulse.
+   *
+   */
+  StepOutputMask m_step;
+};
+
+#endif // _STEPOUTPUT_h
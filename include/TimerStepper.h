@@ -0,0 +1,718 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _TIMERSTEPPER_h
+#define _TIMERSTEPPER_h
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif // defined(ARDUINO)
+
+#include "Ramp.h"
+
+#if !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif // !defined(IRAM_ATTR)
+
+/**
+ * @brief Periodic timer that clocks the step engine.
+ *
+ * On ESP32 it is a hardware timer interrupt. On any other target it is a
+ * simulated timer, the host advances it with simulate() so the step timing
+ * can be checked without the robot.
+ */
+class StepTimer
+{
+public:
+  /**
+   * @brief Start the timer.
+   *
+   * @param id Hardware timer index.
+   * @param periodUs Timer period. [us]
+   * @param callback Function called on every timer period.
+   */
+  static void begin(uint8_t id, uint32_t periodUs, void (*callback)());
+
+  /**
+   * @brief Stop the timer.
+   *
+   */
+  static void end();
+
+  /**
+   * @brief Number of timer periods since begin().
+   *
+   * @return uint32_t Ticks count.
+   */
+  static uint32_t ticks();
+
+  /**
+   * @brief Timer frequency.
+   *
+   * @return uint32_t Ticks per second, 0 before begin().
+   */
+  static uint32_t frequency();
+
+#if !defined(ARDUINO_ARCH_ESP32)
+  /**
+   * @brief Run the timer callback synchronously, host backend only.
+   *
+   * @param count Number of timer periods to simulate.
+   */
+  static void simulate(uint32_t count);
+#endif // !defined(ARDUINO_ARCH_ESP32)
+};
+
+/**
+ * @brief Stepper driver with timer interrupt driven step generation.
+ *
+ * The interface follows AccelStepper, so the rest of the firmware can use
+ * it as a drop in replacement. The pulse timing is owned by tick(), which is
+ * called from the step timer interrupt. run() and runSpeed() only select the
+ * mode of the axis and never produce a step by themselves.
+ *
+ * The trapezoidal ramp is planned in the interrupt after every step with
+ * integer math only. It follows the ramp of AccelStepper, the first
+ * RAMP_TABLE_SIZE intervals come from a RampTable and the next ones from
+ * the integer form of c(n) = c(n - 1) - 2 * c(n - 1) / (4 * n + 1).
+ * The intervals of the table are scaled with sqrt(a_table / a) to another
+ * acceleration, so the table is not built again at run time.
+ */
+class TimerStepper
+{
+public:
+  /**
+   * @brief Supported motor interfaces.
+   *
+   */
+  typedef enum
+  {
+    FUNCTION = 0,
+    DRIVER = 1,
+  } MotorInterfaceType;
+
+  /**
+   * @brief Construct a new Timer Stepper object.
+   *
+   * @param interface Motor interface, only DRIVER is supported.
+   * @param pinStep Step pin.
+   * @param pinDir Direction pin.
+   */
+  TimerStepper(uint8_t interface = DRIVER, uint8_t pinStep = 0xFF, uint8_t pinDir = 0xFF);
+
+  /**
+   * @brief The interrupt reads the ramp table through a pointer to the own
+   * table, a copy would point into its source.
+   *
+   */
+  TimerStepper(const TimerStepper &) = delete;
+  TimerStepper &operator=(const TimerStepper &) = delete;
+
+  /**
+   * @brief Reset the stepper in place to a new one.
+   *
+   * @param interface Motor interface, only DRIVER is supported.
+   * @param pinStep Step pin.
+   * @param pinDir Direction pin.
+   */
+  void init(uint8_t interface = DRIVER, uint8_t pinStep = 0xFF, uint8_t pinDir = 0xFF);
+
+  /**
+   * @brief Set the absolute target position, the queued target is dropped.
+   *
+   * @param absolute Target position. [steps]
+   */
+  void moveTo(long absolute);
+
+  /**
+   * @brief Queue the target position after the current one.
+   *
+   * The axis does not stop on the current target when the queued one
+   * is in the same direction, it takes the queued target on the way.
+   *
+   * @param absolute Target position. [steps]
+   * @return true Queued.
+   * @return false There is a queued target already.
+   */
+  bool queueTo(long absolute);
+
+  /**
+   * @brief Queue the target position with its own limits.
+   *
+   * The interrupt takes the limits together with the target, so the axis
+   * runs the current target with the current limits to its end.
+   *
+   * @param absolute Target position. [steps]
+   * @param maxSpeed Maximum speed of the target. [steps/s]
+   * @param acceleration Acceleration of the target. [steps/s^2]
+   * @return true Queued.
+   * @return false There is a queued target already.
+   */
+  bool queueTo(long absolute, float maxSpeed, float acceleration);
+
+  /**
+   * @brief Check for a queued target position.
+   *
+   * @return true The queued target is not taken yet.
+   * @return false No queued target.
+   */
+  bool hasNext();
+
+  /**
+   * @brief Last commanded target position, the queued one if any.
+   *
+   * @return long Target position. [steps]
+   */
+  long finalPosition();
+
+  /**
+   * @brief Set the target position relative to the current position.
+   *
+   * @param relative Distance. [steps]
+   */
+  void move(long relative);
+
+  /**
+   * @brief Run the axis towards the target position.
+   *
+   * @return true The axis is still moving.
+   * @return false The target position is reached.
+   */
+  bool run();
+
+  /**
+   * @brief Run the axis with the constant speed set by setSpeed().
+   *
+   * The speed ramps to the commanded one with the acceleration,
+   * on a reversal it goes through zero first.
+   *
+   * @return true The axis is moving.
+   * @return false The axis stands and the speed is zero.
+   */
+  bool runSpeed();
+
+  /**
+   * @brief Set the maximum speed.
+   *
+   * @note A moving axis ramps down to the lower maximum speed.
+   * @param speed Maximum speed. [steps/s]
+   */
+  void setMaxSpeed(float speed);
+
+  /**
+   * @brief Get the maximum speed.
+   *
+   * @return float Maximum speed. [steps/s]
+   */
+  float maxSpeed();
+
+  /**
+   * @brief Set the acceleration.
+   *
+   * @note A moving axis keeps its speed and ramps on with the new acceleration.
+   * @param acceleration Acceleration. [steps/s^2]
+   */
+  void setAcceleration(float acceleration);
+
+  /**
+   * @brief Get the acceleration.
+   *
+   * @return float Acceleration. [steps/s^2]
+   */
+  float acceleration();
+
+  /**
+   * @brief Set the maximum speed and the acceleration together.
+   *
+   * @note A moving axis takes both of them in one go.
+   * @param maxSpeed Maximum speed. [steps/s]
+   * @param acceleration Acceleration. [steps/s^2]
+   */
+  void setLimits(float maxSpeed, float acceleration);
+
+  /**
+   * @brief Use a ramp table built at compile time, it sets the acceleration.
+   *
+   * @note The table is read from the interrupt, it has to be in DRAM.
+   * @param table Ramp table.
+   */
+  void setRamp(const RampTable *table);
+
+  /**
+   * @brief Use the jerk limited (S-curve) ramp instead of the trapezoidal one.
+   *
+   * The table is built in the given storage from the acceleration, the jerk
+   * and the maximum speed. A moving axis takes the new ramp, and the new
+   * acceleration of the jerk limited ramp, when it stands again.
+   *
+   * @param table Storage of the ramp, NULL for the trapezoidal ramp.
+   * @param jerk Jerk, 0 for the trapezoidal ramp. [steps/s^3]
+   */
+  void setSCurve(SCurveTable *table, float jerk);
+
+  /**
+   * @brief Check if the jerk limited ramp is used.
+   *
+   * @return true S-curve ramp.
+   * @return false Trapezoidal ramp.
+   */
+  bool isSCurve() const;
+
+  /**
+   * @brief Set the commanded speed of runSpeed().
+   *
+   * @param speed Speed. [steps/s]
+   */
+  void setSpeed(float speed);
+
+  /**
+   * @brief Get the current speed.
+   *
+   * @return float Speed. [steps/s]
+   */
+  float speed();
+
+  /**
+   * @brief Distance to the target position.
+   *
+   * @return long Distance. [steps]
+   */
+  long distanceToGo();
+
+  /**
+   * @brief Get the target position.
+   *
+   * @return long Target position. [steps]
+   */
+  long targetPosition();
+
+  /**
+   * @brief Get the current position.
+   *
+   * @note Also read from the limit switch interrupts.
+   * @return long Current position. [steps]
+   */
+  long currentPosition();
+
+  /**
+   * @brief Reset the current position, the axis is stopped.
+   *
+   * @param position New current position. [steps]
+   */
+  void setCurrentPosition(long position);
+
+  /**
+   * @brief Move the origin of the axis, a moving axis keeps moving.
+   *
+   * @param offset New origin in the current coordinates. [steps]
+   */
+  void shiftPosition(long offset);
+
+  /**
+   * @brief Block until the target position is reached.
+   *
+   */
+  void runToPosition();
+
+  /**
+   * @brief Block until the new target position is reached.
+   *
+   * @param position Target position. [steps]
+   */
+  void runToNewPosition(long position);
+
+  /**
+   * @brief Stop as fast as possible with the current acceleration.
+   *
+   */
+  void stop();
+
+  /**
+   * @brief Enable the driver outputs.
+   *
+   */
+  void enableOutputs();
+
+  /**
+   * @brief Disable the driver outputs.
+   *
+   */
+  void disableOutputs();
+
+  /**
+   * @brief Set the pins polarity.
+   *
+   * @param directionInvert Invert the direction pin.
+   * @param stepInvert Invert the step pin.
+   * @param enableInvert Not used, the enable pin is common for all axises.
+   */
+  void setPinsInverted(bool directionInvert = false, bool stepInvert = false, bool enableInvert = false);
+
+  /**
+   * @brief Check if the axis is moving.
+   *
+   * @return true Moving.
+   * @return false Stopped.
+   */
+  bool isRunning();
+
+  /**
+   * @brief Advance the step engine with one timer period.
+   *
+   * @note Called from the step timer interrupt. The pins are not touched,
+   * the caller outputs the due pulses of all axises together.
+   * A step is delayed by one period after a direction change,
+   * this gives the driver the direction setup time.
+   * @return true Step pulse is due.
+   * @return false No step pulse.
+   */
+  bool tick();
+
+  /**
+   * @brief Level of the direction pin for the current direction.
+   *
+   * @return true HIGH.
+   * @return false LOW.
+   */
+  bool dirLevel() const;
+
+  /**
+   * @brief Hand the standing axis to an external planner.
+   *
+   * The axis drops its targets and takes the steps given by step().
+   * The direction is set now, so it is on the pin before the first step.
+   *
+   * @param forward Direction of the next steps.
+   */
+  void follow(bool forward);
+
+  /**
+   * @brief Take one step given by the external planner.
+   *
+   * @note Called from the step timer interrupt, the axis has to follow().
+   */
+  void step();
+
+  /**
+   * @brief Change the direction given by the external planner.
+   *
+   * @note Called from the step timer interrupt, the axis has to follow().
+   * The caller gives the next step one period later.
+   * @param forward Direction of the next steps.
+   */
+  void turn(bool forward);
+
+private:
+  /**
+   * @brief Plan the next step interval and direction.
+   *
+   * @note Called from the step timer interrupt.
+   * @return true The axis moves.
+   * @return false The axis stops.
+   */
+  bool plan();
+
+  /**
+   * @brief Plan the next step interval of the speed mode.
+   *
+   * @note Called from the step timer interrupt.
+   * @param cmin Interval of the maximum speed. [ticks, Q8]
+   * @return true The axis moves.
+   * @return false The axis stands.
+   */
+  bool planSpeed(uint32_t cmin);
+
+  /**
+   * @brief Step interval on the ramp.
+   *
+   * @note Called from the step timer interrupt.
+   * @param n Ramp step, negative on the deceleration.
+   * @param cn Previous interval. [ticks, Q8]
+   * @return uint32_t Interval. [ticks, Q8]
+   */
+  uint32_t interval(int32_t n, uint32_t cn);
+
+  /**
+   * @brief Check that the interrupt does not move the axis.
+   *
+   * @return true Stands and has nothing to do.
+   * @return false Moves or starts on the next period.
+   */
+  bool isStanding();
+
+  /**
+   * @brief Table interval scaled to the acceleration.
+   *
+   * @note Called from the step timer interrupt.
+   * @param interval Interval of the table. [ticks, Q8]
+   * @return uint32_t Interval. [ticks, Q8]
+   */
+  uint32_t scaled(uint32_t interval);
+
+  /**
+   * @brief Recalculate the fixed point values from the float parameters.
+   *
+   * The new values are prepared aside and handed to the interrupt together,
+   * so they can change while the axis moves.
+   */
+  void refresh();
+
+  /**
+   * @brief Prepare the fixed point values of the queued limits.
+   *
+   */
+  void prepareNext();
+
+  /**
+   * @brief Take over the queued limits, when the interrupt took their target.
+   *
+   */
+  void takeNext();
+
+  /**
+   * @brief Convert speed to step interval.
+   *
+   * @param speed Speed. [steps/s]
+   * @return uint32_t Interval, 0 for stop. [ticks, Q8]
+   */
+  uint32_t intervalOf(float speed);
+
+  /**
+   * @brief Step pin.
+   *
+   */
+  uint8_t m_pinStep;
+
+  /**
+   * @brief Direction pin.
+   *
+   */
+  uint8_t m_pinDir;
+
+  /**
+   * @brief Direction pin polarity.
+   *
+   */
+  bool m_dirInverted;
+
+  /**
+   * @brief Step pin polarity.
+   *
+   */
+  bool m_stepInverted;
+
+  /**
+   * @brief Direction of the last step.
+   *
+   */
+  bool m_forward;
+
+  /**
+   * @brief Direction of the next step.
+   *
+   */
+  bool m_planForward;
+
+  /**
+   * @brief Current position. [steps]
+   *
+   */
+  volatile long m_currentPos;
+
+  /**
+   * @brief Target position. [steps]
+   *
+   */
+  volatile long m_targetPos;
+
+  /**
+   * @brief Queued target position. [steps]
+   *
+   */
+  volatile long m_nextPos;
+
+  /**
+   * @brief The queued target position is valid.
+   *
+   */
+  volatile bool m_hasNext;
+
+  /**
+   * @brief The queued target has its own limits.
+   *
+   */
+  volatile bool m_nextLimits;
+
+  /**
+   * @brief The interrupt took the queued limits, the float values follow them.
+   *
+   */
+  volatile bool m_nextTaken;
+
+  /**
+   * @brief Step interval at the maximum speed of the queued target. [ticks, Q8]
+   *
+   */
+  volatile uint32_t m_nextCmin;
+
+  /**
+   * @brief Ramp scale of the queued target. [Q16]
+   *
+   */
+  volatile uint32_t m_nextScale;
+
+  /**
+   * @brief Ramp step scale to the acceleration of the queued target. [Q16]
+   *
+   */
+  volatile uint32_t m_nextRatio;
+
+  /**
+   * @brief Maximum speed of the queued target. [steps/s]
+   *
+   */
+  float m_nextMaxSpeed;
+
+  /**
+   * @brief Acceleration of the queued target. [steps/s^2]
+   *
+   */
+  float m_nextAcceleration;
+
+  /**
+   * @brief Run to the target position, else run with constant speed.
+   *
+   */
+  volatile bool m_toTarget;
+
+  /**
+   * @brief Ramp step, negative while decelerating, same as _n of AccelStepper.
+   *
+   */
+  volatile int32_t m_n;
+
+  /**
+   * @brief Current step interval, 0 is stop. [ticks, Q8]
+   *
+   */
+  volatile uint32_t m_cn;
+
+  /**
+   * @brief Time since the last step. [ticks, Q8]
+   *
+   */
+  uint32_t m_phase;
+
+  /**
+   * @brief Step interval at the maximum speed. [ticks, Q8]
+   *
+   */
+  volatile uint32_t m_cmin;
+
+  /**
+   * @brief Step interval of the commanded speed, the sign is the direction. [ticks, Q8]
+   *
+   */
+  volatile int32_t m_constantInterval;
+
+  /**
+   * @brief Step timer frequency of the fixed point values. [Hz]
+   *
+   */
+  uint32_t m_frequency;
+
+  /**
+   * @brief Constant speed for runSpeed(). [steps/s]
+   *
+   */
+  float m_constantSpeed;
+
+  /**
+   * @brief Maximum speed. [steps/s]
+   *
+   */
+  float m_maxSpeed;
+
+  /**
+   * @brief Acceleration. [steps/s^2]
+   *
+   */
+  float m_acceleration;
+
+  /**
+   * @brief Ramp table built at compile time.
+   *
+   */
+  const RampTable *m_rampRom;
+
+  /**
+   * @brief Ramp table built at run time, when the timer frequency is not the one of the table.
+   *
+   */
+  RampTable m_rampRam;
+
+  /**
+   * @brief Ramp table read by the interrupt.
+   *
+   */
+  const RampTable *volatile m_ramp;
+
+  /**
+   * @brief Scale of the table intervals to the acceleration. [Q16]
+   *
+   */
+  volatile uint32_t m_rampScale;
+
+  /**
+   * @brief Acceleration of the ramp read by the interrupt. [steps/s^2]
+   *
+   */
+  float m_rampAcceleration;
+
+  /**
+   * @brief Jerk limited ramp read by the interrupt, NULL for the trapezoidal ramp.
+   *
+   */
+  const SCurveTable *volatile m_scurve;
+
+  /**
+   * @brief Storage of the jerk limited ramp.
+   *
+   */
+  SCurveTable *m_scurveTable;
+
+  /**
+   * @brief The jerk limited ramp is built again when the axis stands.
+   *
+   */
+  bool m_scurvePending;
+
+  /**
+   * @brief Jerk. [steps/s^3]
+   *
+   */
+  float m_jerk;
+};
+
+#endif // _TIMERSTEPPER_h
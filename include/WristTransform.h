@@ -0,0 +1,119 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef _WRISTTRANSFORM_h
+#define _WRISTTRANSFORM_h
+
+/**
+ * @brief Differential wrist, the pitch and the roll to the motors and back.
+ *
+ * The left motor turns with the sum of the pitch and the roll, the right
+ * motor with the roll less the pitch. The joint values of the motor values
+ * are their half sum and half difference, so the motor values of a joint
+ * value are exact and the joint values of an odd motor sum round down.
+ *
+ * The same mixing is used for the positions and the speeds.
+ */
+
+/**
+ * @brief Half of the value rounded down.
+ *
+ * @param value Value.
+ * @return long Half.
+ */
+inline long wrist_half(long value)
+{
+  return (value >= 0) ? (value / 2) : -((1 - value) / 2);
+}
+
+/**
+ * @brief Left motor value of the wrist.
+ *
+ * @param pitch Pitch. [steps]
+ * @param roll Roll. [steps]
+ * @return long Left motor. [steps]
+ */
+inline long wrist_left(long pitch, long roll)
+{
+  return pitch + roll;
+}
+
+/**
+ * @brief Right motor value of the wrist.
+ *
+ * @param pitch Pitch. [steps]
+ * @param roll Roll. [steps]
+ * @return long Right motor. [steps]
+ */
+inline long wrist_right(long pitch, long roll)
+{
+  return roll - pitch;
+}
+
+/**
+ * @brief Left motor value of the wrist for fractional values.
+ *
+ * @param pitch Pitch. [steps/s]
+ * @param roll Roll. [steps/s]
+ * @return float Left motor. [steps/s]
+ */
+inline float wrist_left(float pitch, float roll)
+{
+  return pitch + roll;
+}
+
+/**
+ * @brief Right motor value of the wrist for fractional values.
+ *
+ * @param pitch Pitch. [steps/s]
+ * @param roll Roll. [steps/s]
+ * @return float Right motor. [steps/s]
+ */
+inline float wrist_right(float pitch, float roll)
+{
+  return roll - pitch;
+}
+
+/**
+ * @brief Pitch of the wrist.
+ *
+ * @param left Left motor. [steps]
+ * @param right Right motor. [steps]
+ * @return long Pitch. [steps]
+ */
+inline long wrist_pitch(long left, long right)
+{
+  return wrist_half(left - right);
+}
+
+/**
+ * @brief Roll of the wrist.
+ *
+ * @param left Left motor. [steps]
+ * @param right Right motor. [steps]
+ * @return long Roll. [steps]
+ */
+inline long wrist_roll(long left, long right)
+{
+  return wrist_half(left + right);
+}
+
+#endif // _WRISTTRANSFORM_h
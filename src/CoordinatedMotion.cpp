@@ -0,0 +1,229 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CoordinatedMotion.h"
+
+#include <math.h>
+
+#pragma region Coordinated Motion
+
+CoordinatedMotion::CoordinatedMotion()
+{
+  for (uint8_t index = 0; index < COORDINATED_MOTION_AXISES; index++)
+  {
+    m_distance[index] = 0;
+    m_forward[index] = true;
+    m_error[index] = 0;
+    m_maxSpeed[index] = 1.0F;
+    m_acceleration[index] = 1.0F;
+  }
+  m_steps = 0;
+  m_armed = false;
+  m_running = false;
+}
+
+void CoordinatedMotion::setAxis(uint8_t index, long distance, float maxSpeed, float acceleration)
+{
+  if ((index >= COORDINATED_MOTION_AXISES) || m_running)
+  {
+    return;
+  }
+
+  m_forward[index] = (distance >= 0);
+  m_distance[index] = (distance < 0) ? -distance : distance;
+  m_maxSpeed[index] = fabsf(maxSpeed);
+  m_acceleration[index] = fabsf(acceleration);
+}
+
+bool CoordinatedMotion::start()
+{
+  if (m_running)
+  {
+    return false;
+  }
+
+  long StepsL = 0;
+  for (uint8_t index = 0; index < COORDINATED_MOTION_AXISES; index++)
+  {
+    if (m_distance[index] > StepsL)
+    {
+      StepsL = m_distance[index];
+    }
+  }
+  if (StepsL == 0)
+  {
+    return false;
+  }
+
+  // The axis i runs d(i) / L of the lead speed and acceleration,
+  // so the slowest axis in relation to its distance limits the group.
+  float SpeedL = 0.0F;
+  float AccelerationL = 0.0F;
+  for (uint8_t index = 0; index < COORDINATED_MOTION_AXISES; index++)
+  {
+    if (m_distance[index] == 0)
+    {
+      continue;
+    }
+    float RatioL = (float)StepsL / (float)m_distance[index];
+    float AxisSpeedL = m_maxSpeed[index] * RatioL;
+    float AxisAccelerationL = m_acceleration[index] * RatioL;
+    if ((SpeedL == 0.0F) || (AxisSpeedL < SpeedL))
+    {
+      SpeedL = AxisSpeedL;
+    }
+    if ((AccelerationL == 0.0F) || (AxisAccelerationL < AccelerationL))
+    {
+      AccelerationL = AxisAccelerationL;
+    }
+    // Half a step ahead, the steps of the axis are centered on the lead steps.
+    m_error[index] = StepsL / 2;
+  }
+  if ((SpeedL == 0.0F) || (AccelerationL == 0.0F))
+  {
+    return false;
+  }
+
+  m_steps = StepsL;
+  m_lead.setCurrentPosition(0);
+  m_lead.setMaxSpeed(SpeedL);
+  m_lead.setAcceleration(AccelerationL);
+  m_lead.moveTo(StepsL);
+  m_lead.run();
+
+  m_armed = true;
+  m_running = true;
+
+  return true;
+}
+
+bool CoordinatedMotion::run()
+{
+  if (!m_running)
+  {
+    return false;
+  }
+
+  if (!m_lead.run() && !m_armed)
+  {
+    m_running = false;
+  }
+
+  return m_running;
+}
+
+void CoordinatedMotion::stop()
+{
+  if (!m_running)
+  {
+    return;
+  }
+
+  if (m_lead.speed() == 0.0F)
+  {
+    // Not started yet.
+    reset();
+    return;
+  }
+
+  // The other axises follow the lead, they stop on the path too.
+  m_lead.stop();
+}
+
+void CoordinatedMotion::reset()
+{
+  m_running = false;
+  m_armed = false;
+  m_lead.setCurrentPosition(0);
+}
+
+bool CoordinatedMotion::isRunning()
+{
+  return m_running;
+}
+
+bool CoordinatedMotion::moves(uint8_t index) const
+{
+  return (index < COORDINATED_MOTION_AXISES) && (m_distance[index] != 0);
+}
+
+bool CoordinatedMotion::forward(uint8_t index) const
+{
+  return (index < COORDINATED_MOTION_AXISES) && m_forward[index];
+}
+
+float CoordinatedMotion::duration()
+{
+  float SpeedL = m_lead.maxSpeed();
+  float AccelerationL = m_lead.acceleration();
+  float StepsL = (float)m_steps;
+  if ((StepsL == 0.0F) || (SpeedL == 0.0F) || (AccelerationL == 0.0F))
+  {
+    return 0.0F;
+  }
+
+  if (StepsL >= (SpeedL * SpeedL / AccelerationL))
+  {
+    // Trapezoid, it reaches the group speed.
+    return (StepsL / SpeedL) + (SpeedL / AccelerationL);
+  }
+
+  // Triangle.
+  return 2.0F * sqrtf(StepsL / AccelerationL);
+}
+
+bool IRAM_ATTR CoordinatedMotion::tick()
+{
+  if (!m_running)
+  {
+    return false;
+  }
+
+  if (m_armed)
+  {
+    // The directions of the axises are written in this period.
+    m_armed = false;
+    return false;
+  }
+
+  return m_lead.tick();
+}
+
+bool IRAM_ATTR CoordinatedMotion::follow(uint8_t index)
+{
+  long DistanceL = m_distance[index];
+  if (DistanceL == 0)
+  {
+    return false;
+  }
+
+  long ErrorL = m_error[index] + DistanceL;
+  if (ErrorL >= m_steps)
+  {
+    m_error[index] = ErrorL - m_steps;
+    return true;
+  }
+  m_error[index] = ErrorL;
+
+  return false;
+}
+
+#pragma endregion // Coordinated Motion
@@ -0,0 +1,96 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "EStop.h"
+
+#pragma region E-Stop
+
+EStop::EStop()
+{
+  m_pinInput = ESTOP_NO_PIN;
+  m_pinEnable = ESTOP_NO_PIN;
+  m_latched = 0;
+}
+
+void EStop::begin(uint8_t pinInput, uint8_t pinEnable)
+{
+  m_pinInput = pinInput;
+  m_pinEnable = pinEnable;
+  m_latched = 0;
+}
+
+void IRAM_ATTR EStop::trip()
+{
+  if (!open())
+  {
+    // A glitch, the switch is closed.
+    return;
+  }
+
+  m_latched = 1;
+
+  if (m_pinEnable != ESTOP_NO_PIN)
+  {
+#if defined(ARDUINO)
+    digitalWrite(m_pinEnable, HIGH);
+#else
+    enableLevel() = 1;
+#endif // defined(ARDUINO)
+  }
+}
+
+bool EStop::reset()
+{
+  if (open())
+  {
+    return false;
+  }
+
+  m_latched = 0;
+
+  return true;
+}
+
+bool IRAM_ATTR EStop::open() const
+{
+#if defined(ARDUINO)
+  return digitalRead(m_pinInput) == HIGH;
+#else
+  return inputLevel() != 0;
+#endif // defined(ARDUINO)
+}
+
+#if !defined(ARDUINO)
+uint8_t &EStop::inputLevel()
+{
+  static uint8_t LevelL = 0;
+  return LevelL;
+}
+
+uint8_t &EStop::enableLevel()
+{
+  static uint8_t LevelL = 0;
+  return LevelL;
+}
+#endif // !defined(ARDUINO)
+
+#pragma endregion // E-Stop
@@ -0,0 +1,311 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Homing.h"
+
+#include <math.h>
+
+#pragma region Homing
+
+Homing::Homing()
+{
+  m_seekPressed = 0;
+  m_configured = 0;
+  m_axises = 0;
+  m_known = 0;
+  m_homed = 0;
+  m_failed = 0;
+  m_missed = 0;
+  m_state = IDLE;
+  for (uint8_t index = 0; index < HOMING_AXISES; index++)
+  {
+    m_seekSpeed[index] = 0.0F;
+    m_backSpeed[index] = 0.0F;
+    m_approachSpeed[index] = 0.0F;
+    m_margin[index] = 0;
+    m_acceleration[index] = 0.0F;
+    m_window[index] = 0;
+    m_after[index] = 0;
+    m_timeout[index] = 0;
+    m_phase[index] = DONE;
+    m_start[index] = 0;
+  }
+}
+
+void Homing::setAxis(uint8_t index, float seekSpeed, bool seekPressed, float backSpeed, uint8_t after, uint32_t timeout)
+{
+  if (index >= HOMING_AXISES)
+  {
+    return;
+  }
+
+  m_seekSpeed[index] = seekSpeed;
+  m_backSpeed[index] = backSpeed;
+  m_after[index] = after & ~(1U << index);
+  m_timeout[index] = timeout;
+  if (seekPressed)
+  {
+    m_seekPressed |= (1U << index);
+  }
+  else
+  {
+    m_seekPressed &= ~(1U << index);
+  }
+  m_configured |= (1U << index);
+  m_window[index] = window(index);
+}
+
+void Homing::setApproach(uint8_t index, float speed, long margin)
+{
+  if (index >= HOMING_AXISES)
+  {
+    return;
+  }
+
+  m_approachSpeed[index] = (speed < 0.0F) ? -speed : speed;
+  m_margin[index] = (margin < 0) ? -margin : margin;
+  m_window[index] = window(index);
+}
+
+void Homing::setAcceleration(uint8_t index, float acceleration)
+{
+  if (index >= HOMING_AXISES)
+  {
+    return;
+  }
+
+  m_acceleration[index] = (acceleration < 0.0F) ? -acceleration : acceleration;
+  m_window[index] = window(index);
+}
+
+long Homing::window(uint8_t index) const
+{
+  if (index >= HOMING_AXISES)
+  {
+    return 0;
+  }
+
+  long WindowL = m_margin[index];
+  float BackL = fabsf(m_backSpeed[index]);
+  if ((m_acceleration[index] > 0.0F) && (m_approachSpeed[index] > BackL))
+  {
+    // (v^2 - vb^2) / 2a, from the approach speed down to the creep.
+    float SpeedL = m_approachSpeed[index];
+    WindowL += (long)ceilf(((SpeedL * SpeedL) - (BackL * BackL)) / (2.0F * m_acceleration[index]));
+  }
+
+  return WindowL;
+}
+
+bool Homing::begin(uint8_t axises, uint8_t known, uint32_t now)
+{
+  m_axises = axises & m_configured;
+  m_known = known;
+  m_homed = 0;
+  m_failed = 0;
+  m_missed = 0;
+  if (m_axises == 0)
+  {
+    m_state = IDLE;
+    return false;
+  }
+
+  for (uint8_t index = 0; index < HOMING_AXISES; index++)
+  {
+    enter(index, (m_axises & (1U << index)) ? WAIT : DONE, now);
+  }
+  m_state = RUNNING;
+
+  return true;
+}
+
+uint8_t Homing::update(uint8_t pressed, const long *positions, uint32_t now)
+{
+  if (m_state != RUNNING)
+  {
+    return 0;
+  }
+
+  uint8_t ZeroL = 0;
+  for (uint8_t index = 0; index < HOMING_AXISES; index++)
+  {
+    uint8_t BitL = (1U << index);
+    bool SeekStateL = ((pressed & BitL) != 0) == ((m_seekPressed & BitL) != 0);
+
+    // Distance to the known zero in the direction of the seek.
+    long DistanceL = (m_seekSpeed[index] < 0.0F) ? positions[index] : -positions[index];
+
+    if (m_phase[index] == WAIT)
+    {
+      // The axises before it are homed, or not homed at all.
+      if ((m_after[index] & m_axises & ~m_homed) == 0)
+      {
+        bool KnownL = ((m_known & BitL) != 0) && (m_approachSpeed[index] > 0.0F);
+        enter(index, KnownL ? APPROACH : SEEK, now);
+      }
+    }
+
+    if (m_phase[index] == APPROACH)
+    {
+      if (SeekStateL)
+      {
+        // The switch is before the window, its edge is found on the way back.
+        enter(index, RELEASE, now);
+      }
+      else if (DistanceL <= m_window[index])
+      {
+        enter(index, CREEP, now);
+      }
+    }
+
+    if (m_phase[index] == CREEP)
+    {
+      if (SeekStateL)
+      {
+        enter(index, RELEASE, now);
+      }
+      else if (DistanceL < -m_window[index])
+      {
+        // The switch is not where it was, search for it.
+        m_missed |= BitL;
+        enter(index, SEEK, now);
+      }
+    }
+    else if (m_phase[index] == SEEK)
+    {
+      if (SeekStateL)
+      {
+        enter(index, RELEASE, now);
+      }
+    }
+    else if (m_phase[index] == RELEASE)
+    {
+      if (!SeekStateL)
+      {
+        enter(index, DONE, now);
+        m_homed |= BitL;
+        ZeroL |= BitL;
+      }
+    }
+
+    if ((m_phase[index] != WAIT) && (m_phase[index] != DONE) && ((now - m_start[index]) >= m_timeout[index]))
+    {
+      m_failed |= BitL;
+    }
+  }
+
+  if (m_failed != 0)
+  {
+    stop();
+  }
+  else if (m_homed == m_axises)
+  {
+    m_state = HOMED;
+  }
+
+  return ZeroL;
+}
+
+void Homing::stop()
+{
+  if (m_state != RUNNING)
+  {
+    return;
+  }
+
+  for (uint8_t index = 0; index < HOMING_AXISES; index++)
+  {
+    m_phase[index] = DONE;
+  }
+  m_state = FAILED;
+}
+
+bool Homing::zeroPressed(uint8_t index) const
+{
+  // The back run ends when the switch leaves the seek state.
+  return ((m_seekPressed & (1U << index)) == 0);
+}
+
+float Homing::speed(uint8_t index) const
+{
+  if ((index >= HOMING_AXISES) || (m_state != RUNNING))
+  {
+    return 0.0F;
+  }
+
+  if (m_phase[index] == APPROACH)
+  {
+    return (m_seekSpeed[index] < 0.0F) ? -m_approachSpeed[index] : m_approachSpeed[index];
+  }
+  if (m_phase[index] == CREEP)
+  {
+    // The back speed towards the switch.
+    return (m_seekSpeed[index] < 0.0F) ? -fabsf(m_backSpeed[index]) : fabsf(m_backSpeed[index]);
+  }
+  if (m_phase[index] == SEEK)
+  {
+    return m_seekSpeed[index];
+  }
+  if (m_phase[index] == RELEASE)
+  {
+    return m_backSpeed[index];
+  }
+
+  return 0.0F;
+}
+
+Homing::State Homing::state() const
+{
+  return m_state;
+}
+
+bool Homing::isRunning() const
+{
+  return (m_state == RUNNING);
+}
+
+uint8_t Homing::axises() const
+{
+  return m_axises;
+}
+
+uint8_t Homing::homed() const
+{
+  return m_homed;
+}
+
+uint8_t Homing::failed() const
+{
+  return m_failed;
+}
+
+uint8_t Homing::missed() const
+{
+  return m_missed;
+}
+
+void Homing::enter(uint8_t index, Phase phase, uint32_t now)
+{
+  m_phase[index] = phase;
+  m_start[index] = now;
+}
+
+#pragma endregion // Homing
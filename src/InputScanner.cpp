@@ -0,0 +1,111 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "InputScanner.h"
+
+#pragma region Input Scanner
+
+InputScanner::InputScanner()
+{
+  m_count0 = 0;
+  m_count1 = 0;
+  m_state = 0;
+  for (uint8_t index = 0; index < INPUT_SCANNER_INPUTS; index++)
+  {
+    m_pins[index] = INPUT_SCANNER_NO_PIN;
+  }
+}
+
+void InputScanner::setInput(uint8_t index, uint8_t pin)
+{
+  if (index >= INPUT_SCANNER_INPUTS)
+  {
+    return;
+  }
+
+  m_pins[index] = pin;
+}
+
+void InputScanner::begin()
+{
+  m_count0 = 0;
+  m_count1 = 0;
+  m_state = sample();
+}
+
+uint8_t InputScanner::sample() const
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  // Both input banks at once.
+  uint32_t LowL = GPIO.in;
+  uint32_t HighL = GPIO.in1.data;
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+  uint8_t SampleL = 0;
+  for (uint8_t index = 0; index < INPUT_SCANNER_INPUTS; index++)
+  {
+    uint8_t PinL = m_pins[index];
+    if (PinL == INPUT_SCANNER_NO_PIN)
+    {
+      continue;
+    }
+
+#if defined(ARDUINO_ARCH_ESP32)
+    uint32_t LevelL = (PinL < 32) ? ((LowL >> PinL) & 1U) : ((HighL >> (PinL - 32)) & 1U);
+#elif defined(ARDUINO)
+    uint32_t LevelL = (digitalRead(PinL) == HIGH) ? 1U : 0U;
+#else
+    uint32_t LevelL = 1U;
+#endif // defined(ARDUINO_ARCH_ESP32)
+    if (LevelL == 0)
+    {
+      SampleL |= (1U << index);
+    }
+  }
+
+  return SampleL;
+}
+
+uint8_t InputScanner::update(uint8_t sample)
+{
+  // Count the samples that differ from the state, from 0 to 3 and over.
+  uint8_t DeltaL = sample ^ m_state;
+  m_count1 = (m_count1 ^ m_count0) & DeltaL;
+  m_count0 = ~m_count0 & DeltaL;
+  uint8_t ToggleL = DeltaL & ~(m_count0 | m_count1);
+
+  m_state = m_state ^ ToggleL;
+
+  return ToggleL;
+}
+
+uint8_t InputScanner::scan()
+{
+  return update(sample());
+}
+
+uint8_t InputScanner::state() const
+{
+  return m_state;
+}
+
+#pragma endregion // Input Scanner
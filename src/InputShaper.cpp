@@ -0,0 +1,238 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "InputShaper.h"
+
+#include <math.h>
+
+#pragma region Definitions
+
+/**
+ * @brief Amplitude of one. [Q15]
+ *
+ */
+#define SHAPER_ONE (1L << SHAPER_AMPLITUDE_SHIFT)
+
+/**
+ * @brief Mask of the 31 bit event time.
+ *
+ */
+#define SHAPER_TIME_MASK 0x7FFFFFFFUL
+
+#pragma endregion // Definitions
+
+#pragma region Input Shaper
+
+InputShaper::InputShaper()
+{
+  m_head = 0;
+  m_output = 0;
+  m_count = 1;
+  m_now = 0;
+  m_level = false;
+  m_type = NONE;
+  for (uint8_t index = 0; index < SHAPER_IMPULSES; index++)
+  {
+    m_tail[index] = 0;
+    m_delay[index] = 0;
+    m_amplitude[index] = 0;
+    m_position[index] = 0;
+  }
+  m_amplitude[0] = SHAPER_ONE;
+}
+
+bool InputShaper::set(Type type, float frequency, float damping, uint32_t timerFrequency)
+{
+  if ((type != NONE) && ((frequency <= 0.0F) || (damping < 0.0F) || (damping >= 1.0F) || (timerFrequency == 0)))
+  {
+    return false;
+  }
+
+  // The interrupt passes the steps through while the shaper is changed.
+  m_type = NONE;
+
+  uint32_t DelayL[SHAPER_IMPULSES] = {0, 0, 0};
+  float AmplitudeL[SHAPER_IMPULSES] = {1.0F, 0.0F, 0.0F};
+  uint8_t CountL = 1;
+
+  if (type != NONE)
+  {
+    // Damped period and the decay of the half period.
+    float RootL = sqrtf(1.0F - damping * damping);
+    float PeriodL = 1.0F / (frequency * RootL);
+    float K = expf(-damping * (float)M_PI / RootL);
+    uint32_t HalfL = (uint32_t)(PeriodL / 2.0F * (float)timerFrequency + 0.5F);
+
+    if (type == ZV)
+    {
+      AmplitudeL[0] = 1.0F / (1.0F + K);
+      AmplitudeL[1] = K / (1.0F + K);
+      DelayL[1] = HalfL;
+      CountL = 2;
+    }
+    else
+    {
+      float NormL = (1.0F + K) * (1.0F + K);
+      AmplitudeL[0] = 1.0F / NormL;
+      AmplitudeL[1] = 2.0F * K / NormL;
+      AmplitudeL[2] = K * K / NormL;
+      DelayL[1] = HalfL;
+      DelayL[2] = 2 * HalfL;
+      CountL = 3;
+    }
+  }
+
+  // The last amplitude takes the rounding, the sum is exactly one.
+  int32_t SumL = 0;
+  for (uint8_t index = 0; index < SHAPER_IMPULSES; index++)
+  {
+    m_delay[index] = DelayL[index];
+    m_amplitude[index] = 0;
+    if (index < CountL - 1)
+    {
+      m_amplitude[index] = (int32_t)(AmplitudeL[index] * (float)SHAPER_ONE + 0.5F);
+      SumL += m_amplitude[index];
+    }
+    else if (index == CountL - 1)
+    {
+      m_amplitude[index] = SHAPER_ONE - SumL;
+    }
+  }
+  m_count = CountL;
+
+  reset();
+  m_type = type;
+
+  return true;
+}
+
+InputShaper::Type InputShaper::type() const
+{
+  return m_type;
+}
+
+void InputShaper::reset()
+{
+  Type TypeL = m_type;
+  m_type = NONE;
+
+  m_head = 0;
+  m_now = 0;
+  m_output = 0;
+  for (uint8_t index = 0; index < SHAPER_IMPULSES; index++)
+  {
+    m_tail[index] = 0;
+    m_position[index] = 0;
+  }
+
+  m_type = TypeL;
+}
+
+bool InputShaper::isRunning() const
+{
+  if (m_type == NONE)
+  {
+    return false;
+  }
+
+  for (uint8_t index = 1; index < m_count; index++)
+  {
+    if (m_tail[index] != m_head)
+    {
+      return true;
+    }
+  }
+
+  return (m_output != m_position[0]);
+}
+
+bool IRAM_ATTR InputShaper::shape(bool step, bool dirLevel)
+{
+  if (m_type == NONE)
+  {
+    m_level = dirLevel;
+    return step;
+  }
+
+  m_now++;
+
+  if (step)
+  {
+    // The first impulse has no delay, it is the planned position.
+    m_position[0] += dirLevel ? 1 : -1;
+
+    uint16_t NextL = (m_head + 1) % SHAPER_BUFFER_SIZE;
+    for (uint8_t index = 1; index < m_count; index++)
+    {
+      if (m_tail[index] == NextL)
+      {
+        // The ring is full, the oldest step is taken early.
+        m_position[index] += (m_events[NextL] & 1) ? 1 : -1;
+        m_tail[index] = (NextL + 1) % SHAPER_BUFFER_SIZE;
+      }
+    }
+    m_events[m_head] = ((m_now & SHAPER_TIME_MASK) << 1) | (dirLevel ? 1 : 0);
+    m_head = NextL;
+  }
+
+  int64_t ShapedL = (int64_t)m_amplitude[0] * m_position[0];
+  for (uint8_t index = 1; index < m_count; index++)
+  {
+    uint16_t TailL = m_tail[index];
+    while (TailL != m_head)
+    {
+      uint32_t EventL = m_events[TailL];
+      if (((m_now - (EventL >> 1)) & SHAPER_TIME_MASK) < m_delay[index])
+      {
+        break;
+      }
+      m_position[index] += (EventL & 1) ? 1 : -1;
+      TailL = (TailL + 1) % SHAPER_BUFFER_SIZE;
+    }
+    m_tail[index] = TailL;
+    ShapedL += (int64_t)m_amplitude[index] * m_position[index];
+  }
+
+  int32_t TargetL = (int32_t)((ShapedL + (SHAPER_ONE / 2)) >> SHAPER_AMPLITUDE_SHIFT);
+  if (TargetL == m_output)
+  {
+    return false;
+  }
+
+  bool LevelL = (TargetL > m_output);
+  if (LevelL != m_level)
+  {
+    // Output the new direction now and the step on the next period.
+    m_level = LevelL;
+    return false;
+  }
+
+  m_output += LevelL ? 1 : -1;
+
+  return true;
+}
+
+bool IRAM_ATTR InputShaper::dirLevel() const
+{
+  return m_level;
+}
+
+#pragma endregion // Input Shaper
@@ -0,0 +1,157 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "JointCoupling.h"
+
+#pragma region Definitions
+
+/**
+ * @brief One step. [Q16.16]
+ *
+ */
+#define COUPLING_ONE (1L << COUPLING_RATIO_SHIFT)
+
+/**
+ * @brief Half step, for the rounding. [Q16.16]
+ *
+ */
+#define COUPLING_HALF (COUPLING_ONE / 2)
+
+/**
+ * @brief Largest ratio, the pending steps stay far from the overflow.
+ *
+ */
+#define COUPLING_RATIO_MAX 64.0F
+
+#pragma endregion // Definitions
+
+#pragma region Joint Coupling
+
+JointCoupling::JointCoupling()
+{
+  clear();
+  for (uint8_t index = 0; index < COUPLING_AXISES; index++)
+  {
+    m_pending[index] = 0;
+    m_forward[index] = true;
+  }
+}
+
+bool JointCoupling::set(uint8_t axis, uint8_t joint, float ratio)
+{
+  if ((axis >= COUPLING_AXISES) || (joint >= COUPLING_AXISES) || (axis == joint))
+  {
+    return false;
+  }
+
+  if ((ratio > COUPLING_RATIO_MAX) || (ratio < -COUPLING_RATIO_MAX))
+  {
+    return false;
+  }
+
+  float ScaledL = ratio * (float)COUPLING_ONE;
+  m_ratio[axis][joint] = (int32_t)((ScaledL >= 0.0F) ? (ScaledL + 0.5F) : (ScaledL - 0.5F));
+
+  return true;
+}
+
+float JointCoupling::ratio(uint8_t axis, uint8_t joint) const
+{
+  if ((axis >= COUPLING_AXISES) || (joint >= COUPLING_AXISES))
+  {
+    return 0.0F;
+  }
+
+  return (float)m_ratio[axis][joint] / (float)COUPLING_ONE;
+}
+
+void JointCoupling::clear()
+{
+  for (uint8_t axis = 0; axis < COUPLING_AXISES; axis++)
+  {
+    for (uint8_t joint = 0; joint < COUPLING_AXISES; joint++)
+    {
+      m_ratio[axis][joint] = 0;
+    }
+  }
+}
+
+void JointCoupling::reset()
+{
+  for (uint8_t index = 0; index < COUPLING_AXISES; index++)
+  {
+    m_pending[index] = 0;
+  }
+}
+
+bool JointCoupling::isRunning(uint8_t axis) const
+{
+  int32_t PendingL = m_pending[axis];
+
+  return (PendingL >= COUPLING_HALF) || (PendingL < -COUPLING_HALF);
+}
+
+void IRAM_ATTR JointCoupling::add(uint8_t joint, bool step, bool forward)
+{
+  if (!step)
+  {
+    return;
+  }
+
+  m_pending[joint] += forward ? COUPLING_ONE : -COUPLING_ONE;
+  for (uint8_t axis = 0; axis < COUPLING_AXISES; axis++)
+  {
+    int32_t RatioL = m_ratio[axis][joint];
+    if (RatioL != 0)
+    {
+      m_pending[axis] += forward ? RatioL : -RatioL;
+    }
+  }
+}
+
+JointCoupling::Output IRAM_ATTR JointCoupling::follow(uint8_t axis)
+{
+  // The half step goes forward and comes back only past the half, no dither.
+  int32_t PendingL = m_pending[axis];
+  if ((PendingL < COUPLING_HALF) && (PendingL >= -COUPLING_HALF))
+  {
+    return NONE;
+  }
+
+  bool ForwardL = (PendingL > 0);
+  if (ForwardL != m_forward[axis])
+  {
+    // Output the new direction now and the step on the next period.
+    m_forward[axis] = ForwardL;
+    return TURN;
+  }
+
+  m_pending[axis] = PendingL - (ForwardL ? COUPLING_ONE : -COUPLING_ONE);
+
+  return STEP;
+}
+
+bool IRAM_ATTR JointCoupling::forward(uint8_t axis) const
+{
+  return m_forward[axis];
+}
+
+#pragma endregion // Joint Coupling
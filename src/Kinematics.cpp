@@ -0,0 +1,239 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Kinematics.h"
+
+#include <math.h>
+
+#pragma region Definitions
+
+/**
+ * @brief Radians of one degree.
+ *
+ */
+#define KINEMATICS_RAD ((float)M_PI / 180.0F)
+
+/**
+ * @brief Reach under which the tool point is over the base axis. [mm]
+ *
+ */
+#define KINEMATICS_EPSILON 0.001F
+
+#pragma endregion // Definitions
+
+#pragma region Kinematics
+
+Kinematics::Kinematics()
+{
+  m_base = 0.0F;
+  m_upperArm = 0.0F;
+  m_forearm = 0.0F;
+  m_tool = 0.0F;
+  for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+  {
+    m_stepsPerDegree[index] = 1.0F;
+    m_zero[index] = 0.0F;
+    m_steps[index] = 0;
+  }
+  m_valid = false;
+}
+
+void Kinematics::setLinks(float base, float upperArm, float forearm, float tool)
+{
+  m_base = base;
+  m_upperArm = upperArm;
+  m_forearm = forearm;
+  m_tool = tool;
+  m_valid = false;
+}
+
+void Kinematics::setJoint(uint8_t index, float stepsPerDegree, float zero)
+{
+  if ((index >= KINEMATICS_JOINTS) || (stepsPerDegree == 0.0F))
+  {
+    return;
+  }
+
+  m_stepsPerDegree[index] = stepsPerDegree;
+  m_zero[index] = zero;
+  m_valid = false;
+}
+
+void Kinematics::angles(const long *steps, float *angles) const
+{
+  for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+  {
+    angles[index] = m_zero[index] + (float)steps[index] / m_stepsPerDegree[index];
+  }
+}
+
+void Kinematics::steps(const float *angles, long *steps) const
+{
+  for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+  {
+    steps[index] = lroundf((angles[index] - m_zero[index]) * m_stepsPerDegree[index]);
+  }
+}
+
+void Kinematics::forward(const float *angles, KinematicsPose &pose) const
+{
+  // Angles of the links over the horizontal.
+  float UpperArmL = angles[1] * KINEMATICS_RAD;
+  float ForearmL = UpperArmL + angles[2] * KINEMATICS_RAD;
+  float ToolL = ForearmL + angles[3] * KINEMATICS_RAD;
+  float BaseL = angles[0] * KINEMATICS_RAD;
+
+  // Reach and height in the plane of the arm.
+  float ReachL = m_upperArm * cosf(UpperArmL) + m_forearm * cosf(ForearmL) + m_tool * cosf(ToolL);
+  float HeightL = m_base + m_upperArm * sinf(UpperArmL) + m_forearm * sinf(ForearmL) + m_tool * sinf(ToolL);
+
+  pose.X = ReachL * cosf(BaseL);
+  pose.Y = ReachL * sinf(BaseL);
+  pose.Z = HeightL;
+  pose.Pitch = angles[1] + angles[2] + angles[3];
+  pose.Roll = angles[4];
+}
+
+bool Kinematics::inverse(const KinematicsPose &pose, float *angles) const
+{
+  float ReachL = sqrtf(pose.X * pose.X + pose.Y * pose.Y);
+
+  // Over the base axis the base angle is free, it stays.
+  float BaseL = angles[0];
+  if (ReachL > KINEMATICS_EPSILON)
+  {
+    BaseL = atan2f(pose.Y, pose.X) / KINEMATICS_RAD;
+
+    // The turn nearest to the given angle.
+    while ((BaseL - angles[0]) > 180.0F)
+    {
+      BaseL -= 360.0F;
+    }
+    while ((BaseL - angles[0]) < -180.0F)
+    {
+      BaseL += 360.0F;
+    }
+  }
+
+  // Wrist axis in the plane of the arm.
+  float ToolL = pose.Pitch * KINEMATICS_RAD;
+  float WristReachL = ReachL - m_tool * cosf(ToolL);
+  float WristHeightL = pose.Z - m_base - m_tool * sinf(ToolL);
+
+  // Elbow angle of the wrist distance, law of cosines.
+  float DistanceL = WristReachL * WristReachL + WristHeightL * WristHeightL;
+  float CosL = (DistanceL - m_upperArm * m_upperArm - m_forearm * m_forearm) / (2.0F * m_upperArm * m_forearm);
+  if ((CosL > 1.0F) || (CosL < -1.0F))
+  {
+    return false;
+  }
+  float ElbowL = acosf(CosL);
+  if (angles[2] < 0.0F)
+  {
+    ElbowL = -ElbowL;
+  }
+
+  float ShoulderL = atan2f(WristHeightL, WristReachL) - atan2f(m_forearm * sinf(ElbowL), m_upperArm + m_forearm * cosf(ElbowL));
+
+  angles[0] = BaseL;
+  angles[1] = ShoulderL / KINEMATICS_RAD;
+  angles[2] = ElbowL / KINEMATICS_RAD;
+  angles[3] = pose.Pitch - angles[1] - angles[2];
+  angles[4] = pose.Roll;
+
+  return true;
+}
+
+void Kinematics::inverseRate(const float *angles, const KinematicsPose &velocity, float *rates) const
+{
+  float BaseL = angles[0] * KINEMATICS_RAD;
+  float UpperArmL = angles[1] * KINEMATICS_RAD;
+  float ForearmL = UpperArmL + angles[2] * KINEMATICS_RAD;
+  float ToolL = ForearmL + angles[3] * KINEMATICS_RAD;
+  const float DampingL = KINEMATICS_DAMPING * KINEMATICS_DAMPING;
+
+  // Velocity along the reach and across it.
+  float ReachL = m_upperArm * cosf(UpperArmL) + m_forearm * cosf(ForearmL) + m_tool * cosf(ToolL);
+  float RadialL = cosf(BaseL) * velocity.X + sinf(BaseL) * velocity.Y;
+  float TangentL = -sinf(BaseL) * velocity.X + cosf(BaseL) * velocity.Y;
+  float BaseRateL = TangentL * ReachL / (ReachL * ReachL + DampingL);
+
+  // Velocity of the wrist axis, the tool turns with the pitch rate.
+  float PitchRateL = velocity.Pitch * KINEMATICS_RAD;
+  float WristRadialL = RadialL + m_tool * sinf(ToolL) * PitchRateL;
+  float WristUpL = velocity.Z - m_tool * cosf(ToolL) * PitchRateL;
+
+  // Jacobian of the wrist axis on the shoulder and the elbow.
+  float J11 = -m_upperArm * sinf(UpperArmL) - m_forearm * sinf(ForearmL);
+  float J12 = -m_forearm * sinf(ForearmL);
+  float J21 = m_upperArm * cosf(UpperArmL) + m_forearm * cosf(ForearmL);
+  float J22 = m_forearm * cosf(ForearmL);
+
+  // Rates = J' (J J' + d^2 I)^-1 v.
+  float A11 = J11 * J11 + J12 * J12 + DampingL;
+  float A12 = J11 * J21 + J12 * J22;
+  float A22 = J21 * J21 + J22 * J22 + DampingL;
+  float DetL = A11 * A22 - A12 * A12;
+  float W1 = (A22 * WristRadialL - A12 * WristUpL) / DetL;
+  float W2 = (A11 * WristUpL - A12 * WristRadialL) / DetL;
+  float ShoulderRateL = J11 * W1 + J21 * W2;
+  float ElbowRateL = J12 * W1 + J22 * W2;
+
+  rates[0] = BaseRateL / KINEMATICS_RAD;
+  rates[1] = ShoulderRateL / KINEMATICS_RAD;
+  rates[2] = ElbowRateL / KINEMATICS_RAD;
+  rates[3] = velocity.Pitch - rates[1] - rates[2];
+  rates[4] = velocity.Roll;
+}
+
+void Kinematics::stepRates(const float *rates, float *stepRates) const
+{
+  for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+  {
+    stepRates[index] = rates[index] * m_stepsPerDegree[index];
+  }
+}
+
+const KinematicsPose &Kinematics::pose(const long *steps)
+{
+  bool ChangedL = !m_valid;
+  for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+  {
+    ChangedL = ChangedL || (steps[index] != m_steps[index]);
+  }
+  if (!ChangedL)
+  {
+    return m_pose;
+  }
+
+  float AnglesL[KINEMATICS_JOINTS];
+  angles(steps, AnglesL);
+  forward(AnglesL, m_pose);
+  for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+  {
+    m_steps[index] = steps[index];
+  }
+  m_valid = true;
+
+  return m_pose;
+}
+
+#pragma endregion // Kinematics
@@ -0,0 +1,164 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LinearPath.h"
+
+#include <math.h>
+
+#pragma region Linear Path
+
+LinearPath::LinearPath()
+{
+  m_from = KinematicsPose();
+  m_to = KinematicsPose();
+  m_length = 0.0F;
+  m_speed = 0.0F;
+  m_accel = 0.0F;
+  m_accelTime = 0.0F;
+  m_duration = 0.0F;
+  m_period = 0.0F;
+  m_points = 0;
+  m_next = 0;
+}
+
+bool LinearPath::begin(const KinematicsPose &from, const KinematicsPose &to, float speed, float accel, float angularSpeed, float period)
+{
+  m_next = 0;
+  if ((speed <= 0.0F) || (accel <= 0.0F) || (angularSpeed <= 0.0F) || (period <= 0.0F))
+  {
+    return false;
+  }
+
+  float DXL = to.X - from.X;
+  float DYL = to.Y - from.Y;
+  float DZL = to.Z - from.Z;
+  float LengthL = sqrtf(DXL * DXL + DYL * DYL + DZL * DZL);
+
+  // The turn as the line length of the same time.
+  float TurnL = fmaxf(fabsf(to.Pitch - from.Pitch), fabsf(to.Roll - from.Roll));
+  LengthL = fmaxf(LengthL, TurnL * speed / angularSpeed);
+  if (LengthL <= 0.0F)
+  {
+    return false;
+  }
+
+  m_from = from;
+  m_to = to;
+  m_length = LengthL;
+  m_accel = accel;
+  m_speed = speed;
+  if ((speed * speed / accel) > LengthL)
+  {
+    // Triangle, the cruise speed is not reached.
+    m_speed = sqrtf(accel * LengthL);
+  }
+  m_accelTime = m_speed / accel;
+  m_duration = LengthL / m_speed + m_accelTime;
+  m_period = period;
+  m_points = (uint16_t)ceilf(m_duration / period);
+  if (m_points == 0)
+  {
+    m_points = 1;
+  }
+  m_next = 1;
+
+  return true;
+}
+
+float LinearPath::duration() const
+{
+  return m_duration;
+}
+
+uint16_t LinearPath::points() const
+{
+  return m_points;
+}
+
+float LinearPath::time(uint16_t point) const
+{
+  if (point >= m_points)
+  {
+    return m_duration;
+  }
+
+  return (float)point * m_period;
+}
+
+void LinearPath::sample(float time, KinematicsPose &pose) const
+{
+  float RatioL = distance(time) / m_length;
+
+  pose.X = m_from.X + (m_to.X - m_from.X) * RatioL;
+  pose.Y = m_from.Y + (m_to.Y - m_from.Y) * RatioL;
+  pose.Z = m_from.Z + (m_to.Z - m_from.Z) * RatioL;
+  pose.Pitch = m_from.Pitch + (m_to.Pitch - m_from.Pitch) * RatioL;
+  pose.Roll = m_from.Roll + (m_to.Roll - m_from.Roll) * RatioL;
+}
+
+uint16_t LinearPath::next() const
+{
+  return m_next;
+}
+
+void LinearPath::advance()
+{
+  if (isRunning())
+  {
+    m_next++;
+  }
+}
+
+void LinearPath::stop()
+{
+  m_next = 0;
+}
+
+bool LinearPath::isRunning() const
+{
+  return (m_next != 0) && (m_next <= m_points);
+}
+
+float LinearPath::distance(float time) const
+{
+  if (time <= 0.0F)
+  {
+    return 0.0F;
+  }
+  if (time >= m_duration)
+  {
+    return m_length;
+  }
+  if (time < m_accelTime)
+  {
+    return 0.5F * m_accel * time * time;
+  }
+
+  float LeftL = m_duration - time;
+  if (LeftL < m_accelTime)
+  {
+    return m_length - 0.5F * m_accel * LeftL * LeftL;
+  }
+
+  return 0.5F * m_speed * m_accelTime + m_speed * (time - m_accelTime);
+}
+
+#pragma endregion // Linear Path
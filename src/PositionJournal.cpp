@@ -0,0 +1,188 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "PositionJournal.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Length of the record covered with the CRC.
+ *
+ */
+#define JOURNAL_CRC_LENGTH offsetof(JournalRecord, Crc)
+
+#pragma endregion // Definitions
+
+#pragma region Position Journal
+
+PositionJournal::PositionJournal()
+{
+  m_hasLast = false;
+  m_last.Sequence = 0;
+  m_last.Valid = 0;
+  m_last.Moving = 0;
+  m_last.Crc = 0;
+  for (uint8_t index = 0; index < JOURNAL_AXISES; index++)
+  {
+    m_last.Position[index] = 0;
+  }
+
+#if !defined(ARDUINO_ARCH_ESP32)
+  for (uint8_t slot = 0; slot < JOURNAL_SLOTS; slot++)
+  {
+    m_slots[slot] = m_last;
+    m_slots[slot].Crc = (uint16_t)~crc((const uint8_t *)&m_last, JOURNAL_CRC_LENGTH);
+  }
+#endif // !defined(ARDUINO_ARCH_ESP32)
+}
+
+bool PositionJournal::begin(const char *name)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  m_preferences.begin(name, false);
+#else
+  (void)name;
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+  m_hasLast = false;
+  for (uint8_t slot = 0; slot < JOURNAL_SLOTS; slot++)
+  {
+    JournalRecord RecordL;
+    if (!read(slot, RecordL))
+    {
+      continue;
+    }
+
+    // The sequence can wrap, the newer one is ahead in the half range.
+    if (!m_hasLast || ((int32_t)(RecordL.Sequence - m_last.Sequence) > 0))
+    {
+      m_last = RecordL;
+      m_hasLast = true;
+    }
+  }
+
+  return m_hasLast;
+}
+
+bool PositionJournal::restore(long *positions, uint8_t &valid) const
+{
+  if (!m_hasLast || m_last.Moving)
+  {
+    return false;
+  }
+
+  for (uint8_t index = 0; index < JOURNAL_AXISES; index++)
+  {
+    positions[index] = m_last.Position[index];
+  }
+  valid = m_last.Valid;
+
+  return true;
+}
+
+bool PositionJournal::write(const long *positions, uint8_t valid, bool moving)
+{
+  if (m_hasLast && (m_last.Valid == valid) && ((m_last.Moving != 0) == moving))
+  {
+    // In the motion the start is enough, at rest only a change is written.
+    bool SameL = true;
+    for (uint8_t index = 0; index < JOURNAL_AXISES; index++)
+    {
+      SameL = SameL && (m_last.Position[index] == (int32_t)positions[index]);
+    }
+    if (moving || SameL)
+    {
+      return false;
+    }
+  }
+
+  JournalRecord RecordL;
+  RecordL.Sequence = m_last.Sequence + 1;
+  for (uint8_t index = 0; index < JOURNAL_AXISES; index++)
+  {
+    RecordL.Position[index] = (int32_t)positions[index];
+  }
+  RecordL.Valid = valid;
+  RecordL.Moving = moving ? 1 : 0;
+  RecordL.Crc = crc((const uint8_t *)&RecordL, JOURNAL_CRC_LENGTH);
+
+  if (!store(RecordL))
+  {
+    return false;
+  }
+
+  m_last = RecordL;
+  m_hasLast = true;
+
+  return true;
+}
+
+uint32_t PositionJournal::sequence() const
+{
+  return m_hasLast ? m_last.Sequence : 0;
+}
+
+uint16_t PositionJournal::crc(const uint8_t *data, size_t length)
+{
+  uint16_t CrcL = 0xFFFF;
+  for (size_t index = 0; index < length; index++)
+  {
+    CrcL ^= (uint16_t)data[index] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      CrcL = (CrcL & 0x8000) ? (uint16_t)((CrcL << 1) ^ 0x1021) : (uint16_t)(CrcL << 1);
+    }
+  }
+
+  return CrcL;
+}
+
+bool PositionJournal::read(uint8_t slot, JournalRecord &record)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  char KeyL[4] = {'r', (char)('0' + slot), '\0', '\0'};
+  if (m_preferences.getBytes(KeyL, &record, sizeof(record)) != sizeof(record))
+  {
+    return false;
+  }
+#else
+  record = m_slots[slot];
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+  // A record of an other slot is an old one, copied or torn.
+  return (record.Crc == crc((const uint8_t *)&record, JOURNAL_CRC_LENGTH)) &&
+         ((record.Sequence % JOURNAL_SLOTS) == slot);
+}
+
+bool PositionJournal::store(const JournalRecord &record)
+{
+  uint8_t SlotL = (uint8_t)(record.Sequence % JOURNAL_SLOTS);
+
+#if defined(ARDUINO_ARCH_ESP32)
+  char KeyL[4] = {'r', (char)('0' + SlotL), '\0', '\0'};
+  return (m_preferences.putBytes(KeyL, &record, sizeof(record)) == sizeof(record));
+#else
+  m_slots[SlotL] = record;
+  return true;
+#endif // defined(ARDUINO_ARCH_ESP32)
+}
+
+#pragma endregion // Position Journal
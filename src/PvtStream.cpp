@@ -0,0 +1,409 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "PvtStream.h"
+
+#pragma region Definitions
+
+/**
+ * @brief One in Q32.32.
+ *
+ */
+#define PVT_ONE 4294967296.0
+
+/**
+ * @brief Half step in Q32.32, for the rounding.
+ *
+ */
+#define PVT_HALF (1LL << 31)
+
+#pragma endregion // Definitions
+
+#pragma region Pvt Stream
+
+PvtStream::PvtStream()
+{
+  m_head = 0;
+  m_count = 0;
+  m_buffered = 0;
+  m_latency = PVT_LATENCY_MS;
+  m_nextReady = false;
+  m_playing = false;
+  m_stopping = false;
+  m_samples = 0;
+  m_ticksPerSample = 1;
+  m_ticks = 0;
+  m_underruns = 0;
+  m_state = IDLE;
+  for (uint8_t index = 0; index < PVT_AXISES; index++)
+  {
+    m_lastPosition[index] = 0;
+    m_lastVelocity[index] = 0;
+    m_deceleration[index] = 0;
+    m_velocity[index] = 0;
+    m_target[index] = 0;
+    m_increment[index] = 0;
+    m_output[index] = 0;
+    m_forward[index] = true;
+  }
+}
+
+void PvtStream::begin(const long *positions, uint32_t timerFrequency)
+{
+  reset();
+
+  m_ticksPerSample = timerFrequency / PVT_SAMPLE_FREQUENCY;
+  if (m_ticksPerSample == 0)
+  {
+    m_ticksPerSample = 1;
+  }
+  m_ticks = 0;
+  m_underruns = 0;
+  for (uint8_t index = 0; index < PVT_AXISES; index++)
+  {
+    m_lastPosition[index] = positions[index];
+    m_lastVelocity[index] = 0;
+    m_output[index] = positions[index];
+    m_target[index] = (int64_t)positions[index] << 32;
+    m_increment[index] = 0;
+    m_velocity[index] = 0;
+  }
+
+  m_state = BUFFERING;
+}
+
+bool PvtStream::push(const PvtPoint &point)
+{
+  if ((m_count >= PVT_BUFFER_SIZE) || m_stopping)
+  {
+    return false;
+  }
+
+  m_points[(m_head + m_count) % PVT_BUFFER_SIZE] = point;
+  m_count++;
+  m_buffered += point.Duration;
+
+  return true;
+}
+
+void PvtStream::update()
+{
+  if (m_state == IDLE)
+  {
+    return;
+  }
+
+  if (!m_playing && !m_nextReady)
+  {
+    // After the start or an underrun the next segment starts from rest.
+    for (uint8_t index = 0; index < PVT_AXISES; index++)
+    {
+      m_lastVelocity[index] = 0;
+    }
+  }
+
+  if (m_state == BUFFERING)
+  {
+    bool EndL = false;
+    if (m_count > 0)
+    {
+      // The path ends on a point without velocity, it does not wait.
+      const PvtPoint &LastL = m_points[(m_head + m_count - 1) % PVT_BUFFER_SIZE];
+      EndL = true;
+      for (uint8_t index = 0; index < PVT_AXISES; index++)
+      {
+        EndL = EndL && (LastL.Velocity[index] == 0);
+      }
+    }
+    if ((m_buffered >= m_latency) || (m_count >= PVT_BUFFER_SIZE) || EndL)
+    {
+      m_state = PLAYING;
+    }
+  }
+
+  if (m_state != PLAYING)
+  {
+    return;
+  }
+
+  if (!m_nextReady && (m_count > 0))
+  {
+    prepare(m_next);
+    m_nextReady = true;
+  }
+  else if (!m_nextReady && !m_playing)
+  {
+    // Played to the end.
+    m_state = IDLE;
+  }
+}
+
+void PvtStream::setAcceleration(uint8_t index, float acceleration)
+{
+  if (index >= PVT_AXISES)
+  {
+    return;
+  }
+
+  double DecelerationL = (double)acceleration / ((double)PVT_SAMPLE_FREQUENCY * (double)PVT_SAMPLE_FREQUENCY);
+  m_deceleration[index] = (int64_t)(DecelerationL * PVT_ONE);
+}
+
+void PvtStream::stop()
+{
+  if (m_state != PLAYING)
+  {
+    // Buffering, the axises stand.
+    reset();
+    return;
+  }
+
+  m_count = 0;
+  m_buffered = 0;
+  m_nextReady = false;
+
+  // The interrupt ramps down from the velocity of its last sample.
+  m_stopping = true;
+}
+
+void PvtStream::reset()
+{
+  m_state = IDLE;
+  m_playing = false;
+  m_stopping = false;
+  m_nextReady = false;
+  m_count = 0;
+  m_buffered = 0;
+  for (uint8_t index = 0; index < PVT_AXISES; index++)
+  {
+    m_increment[index] = 0;
+  }
+}
+
+bool PvtStream::setLatency(uint16_t latency)
+{
+  if (latency > PVT_LATENCY_MAX_MS)
+  {
+    return false;
+  }
+
+  m_latency = latency;
+
+  return true;
+}
+
+uint16_t PvtStream::latency() const
+{
+  return m_latency;
+}
+
+PvtStream::State PvtStream::state() const
+{
+  return m_state;
+}
+
+bool PvtStream::isRunning() const
+{
+  return (m_state != IDLE);
+}
+
+uint8_t PvtStream::count() const
+{
+  return m_count;
+}
+
+uint8_t PvtStream::available() const
+{
+  return PVT_BUFFER_SIZE - m_count;
+}
+
+uint32_t PvtStream::buffered() const
+{
+  return m_buffered;
+}
+
+uint16_t PvtStream::underruns() const
+{
+  return m_underruns;
+}
+
+void PvtStream::prepare(Segment &segment)
+{
+  const PvtPoint &PointL = m_points[m_head];
+
+  uint32_t SamplesL = (uint32_t)PointL.Duration * PVT_SAMPLE_FREQUENCY / 1000UL;
+  if (SamplesL == 0)
+  {
+    SamplesL = 1;
+  }
+  double N = (double)SamplesL;
+
+  segment.Moving = false;
+  for (uint8_t index = 0; index < PVT_AXISES; index++)
+  {
+    // Hermite cubic x(s) = p0 + v0 s + c s^2 + d s^3 over the samples.
+    double P = (double)(PointL.Position[index] - m_lastPosition[index]);
+    double V0 = (double)m_lastVelocity[index] / (double)PVT_SAMPLE_FREQUENCY;
+    double V1 = (double)PointL.Velocity[index] / (double)PVT_SAMPLE_FREQUENCY;
+    double C = (3.0 * P - (2.0 * V0 + V1) * N) / (N * N);
+    double D = (-2.0 * P + (V0 + V1) * N) / (N * N * N);
+
+    segment.Position[index] = (int64_t)m_lastPosition[index] << 32;
+    segment.Delta1[index] = (int64_t)((V0 + C + D) * PVT_ONE);
+    segment.Delta2[index] = (int64_t)((2.0 * C + 6.0 * D) * PVT_ONE);
+    segment.Delta3[index] = (int64_t)((6.0 * D) * PVT_ONE);
+    segment.End[index] = PointL.Position[index];
+
+    segment.Moving = segment.Moving || (PointL.Velocity[index] != 0);
+
+    m_lastPosition[index] = PointL.Position[index];
+    m_lastVelocity[index] = PointL.Velocity[index];
+  }
+  segment.Samples = SamplesL;
+
+  m_head = (m_head + 1) % PVT_BUFFER_SIZE;
+  m_count--;
+  m_buffered -= PointL.Duration;
+}
+
+bool IRAM_ATTR PvtStream::tick()
+{
+  if (m_state == IDLE)
+  {
+    return false;
+  }
+
+  if ((m_ticks == 0) && m_stopping)
+  {
+    bool MovingL = false;
+    for (uint8_t index = 0; index < PVT_AXISES; index++)
+    {
+      int64_t VelocityL = m_velocity[index];
+      int64_t DecelerationL = m_deceleration[index];
+      if ((DecelerationL == 0) || ((VelocityL <= DecelerationL) && (VelocityL >= -DecelerationL)))
+      {
+        VelocityL = 0;
+      }
+      else
+      {
+        VelocityL += (VelocityL > 0) ? -DecelerationL : DecelerationL;
+      }
+      m_velocity[index] = VelocityL;
+      m_current.Position[index] += VelocityL;
+      m_increment[index] = (m_current.Position[index] - m_target[index]) / (int64_t)m_ticksPerSample;
+      MovingL = MovingL || (VelocityL != 0);
+    }
+
+    if (!MovingL)
+    {
+      // Stands, the output keeps the last step.
+      m_stopping = false;
+      m_playing = false;
+      m_state = IDLE;
+      return false;
+    }
+
+    m_ticks = m_ticksPerSample;
+  }
+  else if (m_ticks == 0)
+  {
+    if (!m_playing || (m_samples == 0))
+    {
+      bool MovingL = m_playing && m_current.Moving;
+      m_playing = false;
+      if (m_nextReady)
+      {
+        m_current = m_next;
+        m_nextReady = false;
+        m_samples = m_current.Samples;
+        m_playing = true;
+      }
+      else if (MovingL)
+      {
+        // The next point is late, hold here and fill the buffer again.
+        m_underruns++;
+        m_state = BUFFERING;
+      }
+    }
+
+    for (uint8_t index = 0; index < PVT_AXISES; index++)
+    {
+      if (!m_playing)
+      {
+        m_increment[index] = 0;
+        m_velocity[index] = 0;
+        continue;
+      }
+
+      // Next sample of the cubic.
+      int64_t PositionL = m_current.Position[index] + m_current.Delta1[index];
+      m_current.Delta1[index] += m_current.Delta2[index];
+      m_current.Delta2[index] += m_current.Delta3[index];
+      if (m_samples == 1)
+      {
+        // The segment ends exactly on the point.
+        PositionL = (int64_t)m_current.End[index] << 32;
+      }
+      m_velocity[index] = PositionL - m_current.Position[index];
+      m_current.Position[index] = PositionL;
+      m_increment[index] = (PositionL - m_target[index]) / (int64_t)m_ticksPerSample;
+    }
+    if (m_playing)
+    {
+      m_samples--;
+    }
+
+    m_ticks = m_ticksPerSample;
+  }
+  m_ticks--;
+
+  return true;
+}
+
+PvtStream::Output IRAM_ATTR PvtStream::follow(uint8_t index)
+{
+  m_target[index] += m_increment[index];
+
+  int32_t TargetL = (int32_t)((m_target[index] + PVT_HALF) >> 32);
+  if (TargetL == m_output[index])
+  {
+    return NONE;
+  }
+
+  bool ForwardL = (TargetL > m_output[index]);
+  if (ForwardL != m_forward[index])
+  {
+    // Output the new direction now and the step on the next period.
+    m_forward[index] = ForwardL;
+    return TURN;
+  }
+
+  m_output[index] += ForwardL ? 1 : -1;
+
+  return STEP;
+}
+
+bool IRAM_ATTR PvtStream::forward(uint8_t index) const
+{
+  return m_forward[index];
+}
+
+#pragma endregion // Pvt Stream
@@ -0,0 +1,1250 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "TimerStepper.h"
+
+#include <math.h>
+
+#pragma region Definitions
+
+#if defined(ARDUINO_ARCH_ESP32)
+/**
+ * @brief Keep the step timer interrupt out while the state is changed.
+ *
+ */
+#define STEPPER_LOCK() portENTER_CRITICAL(&StepperMux_g)
+#define STEPPER_UNLOCK() portEXIT_CRITICAL(&StepperMux_g)
+#else
+#define STEPPER_LOCK()
+#define STEPPER_UNLOCK()
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+/**
+ * @brief Longest step interval. [ticks, Q8]
+ *
+ */
+#define MAX_INTERVAL 0x7FFFFFFFUL
+
+/**
+ * @brief Ramp scale of the table acceleration, one in Q16.
+ *
+ */
+#define RAMP_SCALE_ONE (1UL << 16)
+
+#pragma endregion // Definitions
+
+#pragma region Variables
+
+/**
+ * @brief Timer periods since start.
+ *
+ */
+static volatile uint32_t StepTimerTicks_g = 0;
+
+/**
+ * @brief Timer frequency. [Hz]
+ *
+ */
+static uint32_t StepTimerFrequency_g = 0;
+
+/**
+ * @brief Timer callback.
+ *
+ */
+static void (*StepTimerCallback_g)() = NULL;
+
+#if defined(ARDUINO_ARCH_ESP32)
+/**
+ * @brief Hardware timer instance.
+ *
+ */
+static hw_timer_t *StepTimerHW_g = NULL;
+
+/**
+ * @brief Lock of the steppers state.
+ *
+ */
+static portMUX_TYPE StepperMux_g = portMUX_INITIALIZER_UNLOCKED;
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+#pragma endregion // Variables
+
+#pragma region Step Timer
+
+#if defined(ARDUINO_ARCH_ESP32)
+/**
+ * @brief Hardware timer interrupt.
+ *
+ */
+static void IRAM_ATTR isr_step_timer_hw()
+{
+  StepTimerTicks_g++;
+  StepTimerCallback_g();
+}
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+void StepTimer::begin(uint8_t id, uint32_t periodUs, void (*callback)())
+{
+  StepTimerCallback_g = callback;
+  StepTimerTicks_g = 0;
+  StepTimerFrequency_g = 1000000UL / periodUs;
+
+#if defined(ARDUINO_ARCH_ESP32)
+  // 80MHz APB clock divided by 80 gives 1us timer resolution.
+  StepTimerHW_g = timerBegin(id, 80, true);
+  timerAttachInterrupt(StepTimerHW_g, &isr_step_timer_hw, true);
+  timerAlarmWrite(StepTimerHW_g, periodUs, true);
+  timerAlarmEnable(StepTimerHW_g);
+#else
+  // The simulated timer has no hardware index.
+  (void)id;
+#endif // defined(ARDUINO_ARCH_ESP32)
+}
+
+void StepTimer::end()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if (StepTimerHW_g != NULL)
+  {
+    timerAlarmDisable(StepTimerHW_g);
+    timerEnd(StepTimerHW_g);
+    StepTimerHW_g = NULL;
+  }
+#endif // defined(ARDUINO_ARCH_ESP32)
+  StepTimerCallback_g = NULL;
+}
+
+uint32_t StepTimer::ticks()
+{
+  return StepTimerTicks_g;
+}
+
+uint32_t StepTimer::frequency()
+{
+  return StepTimerFrequency_g;
+}
+
+#if !defined(ARDUINO_ARCH_ESP32)
+void StepTimer::simulate(uint32_t count)
+{
+  for (uint32_t index = 0; index < count; index++)
+  {
+    StepTimerTicks_g++;
+    if (StepTimerCallback_g != NULL)
+    {
+      StepTimerCallback_g();
+    }
+  }
+}
+#endif // !defined(ARDUINO_ARCH_ESP32)
+
+#pragma endregion // Step Timer
+
+#pragma region Functions
+
+/**
+ * @brief Build the ramp table at run time.
+ *
+ * @param table Ramp table.
+ * @param frequency Step timer frequency. [Hz]
+ * @param acceleration Acceleration. [steps/s^2]
+ */
+static void ramp_build(RampTable &table, uint32_t frequency, float acceleration)
+{
+  float C0L = (float)RAMP_TICK * (float)frequency * sqrtf(2.0F / acceleration);
+
+  table.Frequency = frequency;
+  table.Acceleration = acceleration;
+  table.Intervals[0] = (uint32_t)(C0L * 0.676F + 0.5F);
+  for (uint32_t n = 1; n < RAMP_TABLE_SIZE; n++)
+  {
+    table.Intervals[n] = (uint32_t)(C0L * (sqrtf(n + 1.0F) - sqrtf((float)n)) + 0.5F);
+  }
+}
+
+/**
+ * @brief Distance of the jerk limited ramp from the stand still to the speed.
+ *
+ * @param speed Cruise speed. [steps/s]
+ * @param acceleration Maximum acceleration. [steps/s^2]
+ * @param jerk Jerk. [steps/s^3]
+ * @param jerkTime Time of the jerk phases. [s]
+ * @param accelTime Time of the constant acceleration phase. [s]
+ * @return float Distance. [steps]
+ */
+static float scurve_distance(float speed, float acceleration, float jerk, float &jerkTime, float &accelTime)
+{
+  // The acceleration is not reached on the short ramps.
+  float PeakL = sqrtf(speed * jerk);
+  if (PeakL > acceleration)
+  {
+    PeakL = acceleration;
+  }
+  jerkTime = PeakL / jerk;
+  accelTime = (speed - PeakL * jerkTime) / PeakL;
+
+  // The ramp is symmetric, the average speed is the half.
+  return speed * (2.0F * jerkTime + accelTime) / 2.0F;
+}
+
+/**
+ * @brief Position on the jerk limited ramp.
+ *
+ * @param t Time from the stand still. [s]
+ * @param acceleration Peak acceleration. [steps/s^2]
+ * @param jerk Jerk. [steps/s^3]
+ * @param jerkTime Time of the jerk phases. [s]
+ * @param accelTime Time of the constant acceleration phase. [s]
+ * @return float Position. [steps]
+ */
+static float scurve_position(float t, float acceleration, float jerk, float jerkTime, float accelTime)
+{
+  if (t < jerkTime)
+  {
+    return jerk * t * t * t / 6.0F;
+  }
+
+  float S1L = jerk * jerkTime * jerkTime * jerkTime / 6.0F;
+  float V1L = jerk * jerkTime * jerkTime / 2.0F;
+  t -= jerkTime;
+  if (t < accelTime)
+  {
+    return S1L + V1L * t + acceleration * t * t / 2.0F;
+  }
+
+  float S2L = S1L + V1L * accelTime + acceleration * accelTime * accelTime / 2.0F;
+  float V2L = V1L + acceleration * accelTime;
+  t -= accelTime;
+  if (t > jerkTime)
+  {
+    t = jerkTime;
+  }
+  return S2L + V2L * t + acceleration * t * t / 2.0F - jerk * t * t * t / 6.0F;
+}
+
+/**
+ * @brief Build the jerk limited ramp table.
+ *
+ * When the ramp up to the maximum speed does not fit in the table,
+ * the cruise speed is lowered to the highest one that fits.
+ *
+ * @param table Ramp table.
+ * @param frequency Step timer frequency. [Hz]
+ * @param acceleration Maximum acceleration. [steps/s^2]
+ * @param jerk Jerk. [steps/s^3]
+ * @param maxSpeed Cruise speed. [steps/s]
+ */
+static void scurve_build(SCurveTable &table, uint32_t frequency, float acceleration, float jerk, float maxSpeed)
+{
+  table.Frequency = frequency;
+  table.Acceleration = acceleration;
+  table.Jerk = jerk;
+  table.MaxSpeed = maxSpeed;
+
+  if ((maxSpeed <= 0.0F) || (acceleration <= 0.0F))
+  {
+    table.Intervals[0] = MAX_INTERVAL;
+    table.Count = 1;
+    return;
+  }
+
+  float JerkTimeL = 0.0F;
+  float AccelTimeL = 0.0F;
+  float SpeedL = maxSpeed;
+  float LimitL = (float)(RAMP_SCURVE_SIZE - 2);
+  if (scurve_distance(SpeedL, acceleration, jerk, JerkTimeL, AccelTimeL) > LimitL)
+  {
+    // Bisection of the highest speed that fits.
+    float LowL = 0.0F;
+    float HighL = maxSpeed;
+    for (uint8_t iteration = 0; iteration < 24; iteration++)
+    {
+      SpeedL = (LowL + HighL) / 2.0F;
+      if (scurve_distance(SpeedL, acceleration, jerk, JerkTimeL, AccelTimeL) > LimitL)
+      {
+        HighL = SpeedL;
+      }
+      else
+      {
+        LowL = SpeedL;
+      }
+    }
+    SpeedL = LowL;
+  }
+
+  float DistanceL = scurve_distance(SpeedL, acceleration, jerk, JerkTimeL, AccelTimeL);
+  float PeakL = JerkTimeL * jerk;
+  float DurationL = 2.0F * JerkTimeL + AccelTimeL;
+  float ScaleL = (float)RAMP_TICK * (float)frequency;
+
+  // One interval after the ramp, it is the cruise interval.
+  uint16_t CountL = (uint16_t)DistanceL + 2;
+  float TimeL = 0.0F;
+  for (uint16_t n = 0; n < CountL; n++)
+  {
+    float NextL = 0.0F;
+    if ((float)(n + 1) >= DistanceL)
+    {
+      NextL = DurationL + ((float)(n + 1) - DistanceL) / SpeedL;
+    }
+    else
+    {
+      // Bisection of the time of the next step.
+      float LowL = TimeL;
+      float HighL = DurationL;
+      for (uint8_t iteration = 0; iteration < 24; iteration++)
+      {
+        NextL = (LowL + HighL) / 2.0F;
+        if (scurve_position(NextL, PeakL, jerk, JerkTimeL, AccelTimeL) < (float)(n + 1))
+        {
+          LowL = NextL;
+        }
+        else
+        {
+          HighL = NextL;
+        }
+      }
+      NextL = HighL;
+    }
+
+    float IntervalL = (NextL - TimeL) * ScaleL + 0.5F;
+    if (IntervalL < (float)RAMP_TICK)
+    {
+      IntervalL = (float)RAMP_TICK;
+    }
+    else if (IntervalL > (float)MAX_INTERVAL)
+    {
+      IntervalL = (float)MAX_INTERVAL;
+    }
+    table.Intervals[n] = (uint32_t)IntervalL;
+    TimeL = NextL;
+  }
+  table.Count = CountL;
+}
+
+/**
+ * @brief Ramp scale of the table intervals to the acceleration.
+ *
+ * @param tableAcceleration Acceleration of the table. [steps/s^2]
+ * @param acceleration Acceleration. [steps/s^2]
+ * @return uint32_t Scale, sqrt(a_table / a). [Q16]
+ */
+static uint32_t ramp_scale(float tableAcceleration, float acceleration)
+{
+  if ((tableAcceleration <= 0.0F) || (tableAcceleration == acceleration))
+  {
+    return RAMP_SCALE_ONE;
+  }
+
+  float ScaleL = sqrtf(tableAcceleration / acceleration) * (float)RAMP_SCALE_ONE + 0.5F;
+  return (ScaleL >= (float)MAX_INTERVAL) ? MAX_INTERVAL : (uint32_t)ScaleL;
+}
+
+/**
+ * @brief Ratio of the ramp steps of two accelerations.
+ *
+ * @param from Acceleration of the ramp. [steps/s^2]
+ * @param to New acceleration. [steps/s^2]
+ * @return uint32_t Ratio, from / to. [Q16]
+ */
+static uint32_t ramp_ratio(float from, float to)
+{
+  if ((from <= 0.0F) || (from == to))
+  {
+    return RAMP_SCALE_ONE;
+  }
+
+  float RatioL = from / to * (float)RAMP_SCALE_ONE + 0.5F;
+  return (RatioL >= (float)MAX_INTERVAL) ? MAX_INTERVAL : (uint32_t)RatioL;
+}
+
+/**
+ * @brief Ramp step of the same speed with the new acceleration.
+ *
+ * The speed after n ramp steps is sqrt(2 * n * a), so n * a is kept.
+ *
+ * @note Called from the step timer interrupt.
+ * @param n Ramp step, negative on the deceleration.
+ * @param ratio Old acceleration divided by the new one. [Q16]
+ * @return int32_t Ramp step.
+ */
+static int32_t IRAM_ATTR ramp_rescale(int32_t n, uint32_t ratio)
+{
+  if ((n == 0) || (ratio == RAMP_SCALE_ONE))
+  {
+    return n;
+  }
+
+  uint64_t StepsL = (uint64_t)((n < 0) ? -(int64_t)n : (int64_t)n);
+  uint64_t ScaledL = (StepsL * ratio + RAMP_SCALE_ONE / 2) >> 16;
+  if (ScaledL == 0)
+  {
+    // Still on the ramp.
+    ScaledL = 1;
+  }
+  else if (ScaledL > 0x7FFFFFFFULL)
+  {
+    ScaledL = 0x7FFFFFFFULL;
+  }
+
+  return (n < 0) ? -(int32_t)ScaledL : (int32_t)ScaledL;
+}
+
+#pragma endregion // Functions
+
+#pragma region Timer Stepper
+
+TimerStepper::TimerStepper(uint8_t interface, uint8_t pinStep, uint8_t pinDir)
+{
+  init(interface, pinStep, pinDir);
+}
+
+void TimerStepper::init(uint8_t interface, uint8_t pinStep, uint8_t pinDir)
+{
+  (void)interface;
+  m_pinStep = pinStep;
+  m_pinDir = pinDir;
+  m_dirInverted = false;
+  m_stepInverted = false;
+  m_forward = true;
+  m_planForward = true;
+  m_currentPos = 0;
+  m_targetPos = 0;
+  m_nextPos = 0;
+  m_hasNext = false;
+  m_nextLimits = false;
+  m_nextTaken = false;
+  m_nextCmin = 0;
+  m_nextScale = RAMP_SCALE_ONE;
+  m_nextRatio = RAMP_SCALE_ONE;
+  m_nextMaxSpeed = 1.0F;
+  m_nextAcceleration = 1.0F;
+  m_toTarget = false;
+  m_n = 0;
+  m_cn = 0;
+  m_phase = 0;
+  m_cmin = 0;
+  m_constantInterval = 0;
+  m_frequency = 0;
+  m_constantSpeed = 0.0F;
+  m_maxSpeed = 1.0F;
+  m_acceleration = 1.0F;
+  m_rampRom = NULL;
+  m_rampRam.Frequency = 0;
+  m_rampRam.Acceleration = 0.0F;
+  m_ramp = &m_rampRam;
+  m_rampScale = RAMP_SCALE_ONE;
+  m_rampAcceleration = 0.0F;
+  m_scurve = NULL;
+  m_scurveTable = NULL;
+  m_scurvePending = false;
+  m_jerk = 0.0F;
+}
+
+void TimerStepper::moveTo(long absolute)
+{
+  STEPPER_LOCK();
+  m_targetPos = absolute;
+  m_hasNext = false;
+  m_nextLimits = false;
+  STEPPER_UNLOCK();
+}
+
+bool TimerStepper::queueTo(long absolute)
+{
+  takeNext();
+  if (m_hasNext)
+  {
+    return false;
+  }
+  m_nextPos = absolute;
+  m_hasNext = true;
+
+  return true;
+}
+
+bool TimerStepper::queueTo(long absolute, float maxSpeed, float acceleration)
+{
+  takeNext();
+  if (m_hasNext)
+  {
+    return false;
+  }
+  if ((acceleration == 0.0F) || ((maxSpeed == m_maxSpeed) && (acceleration == m_acceleration)))
+  {
+    // Nothing to change on the take.
+    return queueTo(absolute);
+  }
+
+  m_nextMaxSpeed = (maxSpeed < 0.0F) ? -maxSpeed : maxSpeed;
+  m_nextAcceleration = (acceleration < 0.0F) ? -acceleration : acceleration;
+  m_nextLimits = true;
+  prepareNext();
+
+  // The target goes last, the interrupt takes it with the limits.
+  STEPPER_LOCK();
+  m_nextPos = absolute;
+  m_hasNext = true;
+  STEPPER_UNLOCK();
+
+  return true;
+}
+
+bool TimerStepper::hasNext()
+{
+  return m_hasNext;
+}
+
+long TimerStepper::finalPosition()
+{
+  STEPPER_LOCK();
+  long PositionL = m_hasNext ? m_nextPos : m_targetPos;
+  STEPPER_UNLOCK();
+
+  return PositionL;
+}
+
+void TimerStepper::move(long relative)
+{
+  moveTo(m_currentPos + relative);
+}
+
+bool TimerStepper::run()
+{
+  takeNext();
+  if ((m_frequency != StepTimer::frequency()) || (m_scurvePending && isStanding()))
+  {
+    refresh();
+  }
+  m_toTarget = true;
+
+  return isRunning();
+}
+
+bool TimerStepper::runSpeed()
+{
+  takeNext();
+  if ((m_frequency != StepTimer::frequency()) || (m_scurvePending && isStanding()))
+  {
+    refresh();
+  }
+  m_toTarget = false;
+
+  // The axis runs until the ramp reached zero.
+  return (m_constantSpeed != 0.0F) || (m_cn != 0);
+}
+
+void TimerStepper::setMaxSpeed(float speed)
+{
+  takeNext();
+  if (speed < 0.0F)
+  {
+    speed = -speed;
+  }
+  m_maxSpeed = speed;
+  refresh();
+}
+
+float TimerStepper::maxSpeed()
+{
+  takeNext();
+  return m_maxSpeed;
+}
+
+void TimerStepper::setAcceleration(float acceleration)
+{
+  takeNext();
+  if (acceleration == 0.0F)
+  {
+    return;
+  }
+  if (acceleration < 0.0F)
+  {
+    acceleration = -acceleration;
+  }
+  if (acceleration == m_acceleration)
+  {
+    return;
+  }
+  m_acceleration = acceleration;
+  refresh();
+}
+
+float TimerStepper::acceleration()
+{
+  takeNext();
+  return m_acceleration;
+}
+
+void TimerStepper::setLimits(float maxSpeed, float acceleration)
+{
+  takeNext();
+  if (maxSpeed < 0.0F)
+  {
+    maxSpeed = -maxSpeed;
+  }
+  if (acceleration < 0.0F)
+  {
+    acceleration = -acceleration;
+  }
+  if (acceleration == 0.0F)
+  {
+    acceleration = m_acceleration;
+  }
+  if ((maxSpeed == m_maxSpeed) && (acceleration == m_acceleration))
+  {
+    return;
+  }
+  m_maxSpeed = maxSpeed;
+  m_acceleration = acceleration;
+  refresh();
+}
+
+void TimerStepper::setRamp(const RampTable *table)
+{
+  takeNext();
+  m_rampRom = table;
+  m_acceleration = table->Acceleration;
+  refresh();
+}
+
+void TimerStepper::setSCurve(SCurveTable *table, float jerk)
+{
+  if ((table == NULL) || (jerk <= 0.0F))
+  {
+    table = NULL;
+    jerk = 0.0F;
+  }
+  takeNext();
+  m_scurveTable = table;
+  m_jerk = jerk;
+  refresh();
+}
+
+bool TimerStepper::isSCurve() const
+{
+  return (m_scurve != NULL);
+}
+
+void TimerStepper::setSpeed(float speed)
+{
+  if (speed > m_maxSpeed)
+  {
+    speed = m_maxSpeed;
+  }
+  else if (speed < -m_maxSpeed)
+  {
+    speed = -m_maxSpeed;
+  }
+  m_constantSpeed = speed;
+
+  int32_t IntervalL = (int32_t)intervalOf(speed);
+  m_constantInterval = (speed < 0.0F) ? -IntervalL : IntervalL;
+}
+
+float TimerStepper::speed()
+{
+  uint32_t IntervalL = m_cn;
+  if ((IntervalL == 0) || (m_frequency == 0))
+  {
+    return 0.0F;
+  }
+
+  float SpeedL = (float)RAMP_TICK * (float)m_frequency / (float)IntervalL;
+  return m_planForward ? SpeedL : -SpeedL;
+}
+
+long TimerStepper::distanceToGo()
+{
+  return m_targetPos - m_currentPos;
+}
+
+long TimerStepper::targetPosition()
+{
+  return m_targetPos;
+}
+
+long IRAM_ATTR TimerStepper::currentPosition()
+{
+  return m_currentPos;
+}
+
+void TimerStepper::setCurrentPosition(long position)
+{
+  // Stop the step engine and move the origin in one go.
+  STEPPER_LOCK();
+  m_cn = 0;
+  m_n = 0;
+  m_currentPos = position;
+  m_targetPos = position;
+  m_hasNext = false;
+  m_nextLimits = false;
+  STEPPER_UNLOCK();
+}
+
+void TimerStepper::shiftPosition(long offset)
+{
+  // The steps of the interrupt meanwhile are kept.
+  STEPPER_LOCK();
+  m_currentPos = m_currentPos - offset;
+  m_targetPos = m_targetPos - offset;
+  m_nextPos = m_nextPos - offset;
+  STEPPER_UNLOCK();
+}
+
+void TimerStepper::runToPosition()
+{
+  while (run())
+  {
+#if defined(ARDUINO)
+    yield();
+#endif // defined(ARDUINO)
+  }
+}
+
+void TimerStepper::runToNewPosition(long position)
+{
+  moveTo(position);
+  runToPosition();
+}
+
+void TimerStepper::stop()
+{
+  float SpeedL = speed();
+  if (SpeedL == 0.0F)
+  {
+    return;
+  }
+  long StepsToStopL = (long)((SpeedL * SpeedL) / (2.0F * m_acceleration)) + 1;
+  if (m_scurve != NULL)
+  {
+    // The jerk limited ramp is longer, it stops after the ramp steps.
+    int32_t N = m_n;
+    StepsToStopL = ((N < 0) ? -N : N) + 1;
+  }
+  if (SpeedL > 0.0F)
+  {
+    moveTo(m_currentPos + StepsToStopL);
+  }
+  else
+  {
+    moveTo(m_currentPos - StepsToStopL);
+  }
+}
+
+void TimerStepper::enableOutputs()
+{
+#if defined(ARDUINO)
+  pinMode(m_pinStep, OUTPUT);
+  pinMode(m_pinDir, OUTPUT);
+#endif // defined(ARDUINO)
+}
+
+void TimerStepper::disableOutputs()
+{
+#if defined(ARDUINO)
+  digitalWrite(m_pinStep, m_stepInverted ? HIGH : LOW);
+  digitalWrite(m_pinDir, LOW);
+#endif // defined(ARDUINO)
+}
+
+void TimerStepper::setPinsInverted(bool directionInvert, bool stepInvert, bool enableInvert)
+{
+  (void)enableInvert;
+  m_dirInverted = directionInvert;
+  m_stepInverted = stepInvert;
+}
+
+bool TimerStepper::isRunning()
+{
+  return !((m_cn == 0) && (m_targetPos == m_currentPos) && !m_hasNext);
+}
+
+bool TimerStepper::isStanding()
+{
+  if (m_cn != 0)
+  {
+    return false;
+  }
+
+  // The interrupt starts the axis only on a target or on a speed.
+  return m_toTarget ? ((m_targetPos == m_currentPos) && !m_hasNext) : (m_constantInterval == 0);
+}
+
+bool IRAM_ATTR TimerStepper::tick()
+{
+  if (m_cn == 0)
+  {
+    // Standing, the first step goes out right away.
+    if (!plan())
+    {
+      return false;
+    }
+    m_phase = m_cn;
+  }
+  else
+  {
+    m_phase += RAMP_TICK;
+    if (m_phase < m_cn)
+    {
+      return false;
+    }
+  }
+
+  if (m_planForward != m_forward)
+  {
+    // Output the new direction now and the step on the next period.
+    m_forward = m_planForward;
+    m_phase = m_cn - RAMP_TICK;
+    return false;
+  }
+
+  m_phase -= m_cn;
+  m_currentPos = m_currentPos + (m_forward ? 1 : -1);
+  plan();
+
+  return true;
+}
+
+bool IRAM_ATTR TimerStepper::dirLevel() const
+{
+  return (m_forward != m_dirInverted);
+}
+
+void TimerStepper::follow(bool forward)
+{
+  STEPPER_LOCK();
+  m_toTarget = true;
+  m_hasNext = false;
+  m_nextLimits = false;
+  m_cn = 0;
+  m_n = 0;
+  m_targetPos = m_currentPos;
+  m_forward = forward;
+  m_planForward = forward;
+  STEPPER_UNLOCK();
+}
+
+void IRAM_ATTR TimerStepper::step()
+{
+  // The target goes with the position, so plan() keeps the axis standing.
+  m_currentPos = m_currentPos + (m_forward ? 1 : -1);
+  m_targetPos = m_currentPos;
+}
+
+void IRAM_ATTR TimerStepper::turn(bool forward)
+{
+  m_forward = forward;
+  m_planForward = forward;
+}
+
+bool IRAM_ATTR TimerStepper::plan()
+{
+  uint32_t CminL = m_cmin;
+  if (CminL == 0)
+  {
+    // Not configured yet.
+    m_cn = 0;
+    return false;
+  }
+
+  if (!m_toTarget)
+  {
+    return planSpeed(CminL);
+  }
+
+  long DistanceL = m_targetPos - m_currentPos;
+  if ((DistanceL == 0) && m_hasNext)
+  {
+    // Take the queued target.
+    m_targetPos = m_nextPos;
+    if (m_nextLimits)
+    {
+      // The limits of the target go with it, on the same speed.
+      CminL = m_nextCmin;
+      m_cmin = CminL;
+      if (m_scurve == NULL)
+      {
+        m_rampScale = m_nextScale;
+        m_n = ramp_rescale(m_n, m_nextRatio);
+      }
+      m_nextLimits = false;
+      m_nextTaken = true;
+    }
+    m_hasNext = false;
+    DistanceL = m_targetPos - m_currentPos;
+  }
+
+  // Look ahead, when the queued target is in the same direction
+  // the axis has to stop only there.
+  long LookAheadL = DistanceL;
+  if (m_hasNext)
+  {
+    long NextL = m_nextPos - m_targetPos;
+    if (((NextL > 0) && (DistanceL > 0)) || ((NextL < 0) && (DistanceL < 0)))
+    {
+      LookAheadL = m_nextPos - m_currentPos;
+    }
+  }
+
+  // Same decisions as AccelStepper::computeNewSpeed().
+  int32_t N = m_n;
+  long StepsToStopL = (N < 0) ? -N : N;
+
+  if ((DistanceL == 0) && (StepsToStopL <= 1))
+  {
+    m_n = 0;
+    m_cn = 0;
+    return false;
+  }
+
+  if (DistanceL > 0)
+  {
+    if ((N > 0) && ((StepsToStopL >= LookAheadL) || !m_planForward))
+    {
+      // Start the deceleration.
+      N = -StepsToStopL;
+    }
+    else if ((N < 0) && (StepsToStopL < LookAheadL) && m_planForward)
+    {
+      // Accelerate again.
+      N = -N;
+    }
+  }
+  else if (DistanceL < 0)
+  {
+    if ((N > 0) && ((StepsToStopL >= -LookAheadL) || m_planForward))
+    {
+      N = -StepsToStopL;
+    }
+    else if ((N < 0) && (StepsToStopL < -LookAheadL) && !m_planForward)
+    {
+      N = -N;
+    }
+  }
+
+  // The maximum speed was lowered under the moving axis, slow down to it.
+  bool SlowDownL = false;
+  if ((N > 0) && (m_cn < CminL))
+  {
+    N = -StepsToStopL;
+    SlowDownL = true;
+  }
+
+  if (N == 0)
+  {
+    // First step, in the direction of the target.
+    m_planForward = (DistanceL > 0);
+  }
+
+  uint32_t CnL = interval(N, m_cn);
+
+  if (SlowDownL)
+  {
+    if (CnL >= CminL)
+    {
+      // Cruise again on the new maximum speed.
+      CnL = CminL;
+      N = (StepsToStopL > 1) ? (int32_t)StepsToStopL - 2 : 0;
+    }
+  }
+  else if (CnL <= CminL)
+  {
+    // Cruise, the steps to stop stay the same.
+    CnL = CminL;
+    if (N > 0)
+    {
+      N--;
+    }
+  }
+
+  m_cn = CnL;
+  m_n = N + 1;
+
+  return true;
+}
+
+bool IRAM_ATTR TimerStepper::planSpeed(uint32_t cmin)
+{
+  int32_t IntervalL = m_constantInterval;
+  uint32_t CommandL = (IntervalL < 0) ? (uint32_t)(-IntervalL) : (uint32_t)IntervalL;
+  bool ForwardL = (IntervalL > 0);
+  int32_t N = m_n;
+  uint32_t StepsToStopL = (N < 0) ? (uint32_t)(-N) : (uint32_t)N;
+  uint32_t CnL = m_cn;
+
+  if (CommandL < cmin)
+  {
+    CommandL = (CommandL == 0) ? 0 : cmin;
+  }
+
+  if (StepsToStopL == 0)
+  {
+    if (CommandL == 0)
+    {
+      m_cn = 0;
+      return false;
+    }
+    // Start, or turn after the ramp went through zero.
+    m_planForward = ForwardL;
+    N = 0;
+  }
+  else if ((CommandL == 0) || (ForwardL != m_planForward) || (CnL < CommandL))
+  {
+    // Decelerate, to the lower speed or to zero before the turn.
+    N = -(int32_t)StepsToStopL;
+  }
+  else if (CnL > CommandL)
+  {
+    // Accelerate.
+    N = (int32_t)StepsToStopL;
+  }
+  else
+  {
+    // Cruise on the commanded speed.
+    return true;
+  }
+
+  CnL = interval(N, CnL);
+
+  if ((N >= 0) && (CnL <= CommandL))
+  {
+    // The commanded speed is reached, the steps to stop stay the same.
+    CnL = CommandL;
+    N--;
+  }
+  else if ((N < 0) && (CommandL != 0) && (ForwardL == m_planForward) && (CnL >= CommandL))
+  {
+    CnL = CommandL;
+  }
+
+  m_cn = CnL;
+  m_n = N + 1;
+
+  return true;
+}
+
+uint32_t IRAM_ATTR TimerStepper::interval(int32_t n, uint32_t cn)
+{
+  const RampTable *RampL = m_ramp;
+  const SCurveTable *SCurveL = m_scurve;
+  int32_t N = n;
+  uint32_t CnL = cn;
+
+  if (SCurveL != NULL)
+  {
+    // Jerk limited ramp, the same intervals up and down.
+    uint32_t IndexL = (N < 0) ? (uint32_t)(-N - 1) : (uint32_t)N;
+    uint32_t LastL = SCurveL->Count - 1;
+    CnL = SCurveL->Intervals[(IndexL < LastL) ? IndexL : LastL];
+  }
+  else if (N == 0)
+  {
+    CnL = scaled(RampL->Intervals[0]);
+  }
+  else if (N > 0)
+  {
+    // Accelerate.
+    if (N < RAMP_TABLE_SIZE)
+    {
+      CnL = scaled(RampL->Intervals[N]);
+    }
+    else
+    {
+      // Rounded, the truncation adds up over the long ramps.
+      uint32_t DivisorL = 4 * (uint32_t)N + 1;
+      CnL -= (2 * CnL + DivisorL / 2) / DivisorL;
+    }
+  }
+  else
+  {
+    // Decelerate, -N steps to the stop.
+    if (-N <= RAMP_TABLE_SIZE)
+    {
+      CnL = scaled(RampL->Intervals[-N - 1]);
+    }
+    else
+    {
+      uint32_t DivisorL = 4 * (uint32_t)(-N) - 1;
+      CnL += (2 * CnL + DivisorL / 2) / DivisorL;
+    }
+  }
+
+  return CnL;
+}
+
+uint32_t IRAM_ATTR TimerStepper::scaled(uint32_t interval)
+{
+  uint32_t ScaleL = m_rampScale;
+  if (ScaleL == RAMP_SCALE_ONE)
+  {
+    return interval;
+  }
+
+  // The intervals of the table go with 1 / sqrt(a), past the table the recurrence does not depend on a.
+  uint64_t IntervalL = ((uint64_t)interval * ScaleL) >> 16;
+
+  return (IntervalL > MAX_INTERVAL) ? MAX_INTERVAL : (uint32_t)IntervalL;
+}
+
+void TimerStepper::refresh()
+{
+  uint32_t FrequencyL = StepTimer::frequency();
+  if (FrequencyL == 0)
+  {
+    // Wait for the step timer.
+    return;
+  }
+  m_frequency = FrequencyL;
+
+  // The table of the compiler is scaled to the acceleration, it is built
+  // here only for another timer frequency.
+  const RampTable *RampL = m_rampRom;
+  bool BuildL = false;
+  RampTable TableL;
+  if ((RampL == NULL) || (RampL->Frequency != FrequencyL))
+  {
+    RampL = &m_rampRam;
+    if (m_rampRam.Frequency != FrequencyL)
+    {
+      // Built aside, the interrupt reads the old table meanwhile.
+      ramp_build(TableL, FrequencyL, m_acceleration);
+      BuildL = true;
+    }
+  }
+  uint32_t ScaleL = ramp_scale(BuildL ? TableL.Acceleration : RampL->Acceleration, m_acceleration);
+
+  const SCurveTable *SCurveL = m_scurveTable;
+  bool StaleL = (m_scurveTable != NULL) &&
+                ((m_scurveTable->Frequency != FrequencyL) || (m_scurveTable->Acceleration != m_acceleration) ||
+                 (m_scurveTable->Jerk != m_jerk) || (m_scurveTable->MaxSpeed != m_maxSpeed));
+  m_scurvePending = false;
+  if ((StaleL || (SCurveL != m_scurve)) && !isStanding())
+  {
+    // The ramp step is an index of the table, the moving axis keeps its
+    // ramp and takes the new one on the stand still.
+    SCurveL = m_scurve;
+    m_scurvePending = true;
+  }
+  else if (StaleL)
+  {
+    // The interrupt does not read the table of a standing axis.
+    scurve_build(*m_scurveTable, FrequencyL, m_acceleration, m_jerk, m_maxSpeed);
+  }
+
+  uint32_t CminL = intervalOf(m_maxSpeed);
+  if ((SCurveL != NULL) && (CminL < SCurveL->Intervals[SCurveL->Count - 1]))
+  {
+    // The ramp of the table ends below the maximum speed.
+    CminL = SCurveL->Intervals[SCurveL->Count - 1];
+  }
+
+  // The interrupt takes the new ramp at once, on the same speed.
+  uint32_t RatioL = ramp_ratio(m_rampAcceleration, m_acceleration);
+  STEPPER_LOCK();
+  if (m_nextTaken)
+  {
+    // The interrupt took the queued limits meanwhile, they go first.
+    STEPPER_UNLOCK();
+    takeNext();
+    return;
+  }
+  if (BuildL)
+  {
+    m_rampRam = TableL;
+  }
+  m_ramp = RampL;
+  m_rampScale = ScaleL;
+  if ((SCurveL == NULL) && (m_scurve == NULL))
+  {
+    m_n = ramp_rescale(m_n, RatioL);
+  }
+  m_scurve = SCurveL;
+  m_cmin = CminL;
+  STEPPER_UNLOCK();
+  m_rampAcceleration = m_acceleration;
+
+  setSpeed(m_constantSpeed);
+
+  if (m_nextLimits)
+  {
+    // The queued limits follow the new ramp.
+    prepareNext();
+  }
+}
+
+void TimerStepper::prepareNext()
+{
+  const RampTable *RampL = m_ramp;
+  const SCurveTable *SCurveL = m_scurve;
+  uint32_t CminL = intervalOf(m_nextMaxSpeed);
+  if ((SCurveL != NULL) && (CminL < SCurveL->Intervals[SCurveL->Count - 1]))
+  {
+    // The jerk limited ramp keeps its table, only the maximum speed goes.
+    CminL = SCurveL->Intervals[SCurveL->Count - 1];
+  }
+  uint32_t ScaleL = ramp_scale(RampL->Acceleration, m_nextAcceleration);
+  uint32_t RatioL = ramp_ratio(m_rampAcceleration, m_nextAcceleration);
+
+  STEPPER_LOCK();
+  m_nextCmin = CminL;
+  m_nextScale = ScaleL;
+  m_nextRatio = RatioL;
+  STEPPER_UNLOCK();
+}
+
+void TimerStepper::takeNext()
+{
+  if (!m_nextTaken)
+  {
+    return;
+  }
+  m_nextTaken = false;
+
+  // The interrupt runs with the limits already, the float values follow.
+  m_maxSpeed = m_nextMaxSpeed;
+  m_acceleration = m_nextAcceleration;
+  m_rampAcceleration = m_nextAcceleration;
+  refresh();
+}
+
+uint32_t TimerStepper::intervalOf(float speed)
+{
+  if ((speed == 0.0F) || (m_frequency == 0))
+  {
+    return 0;
+  }
+
+  float IntervalL = (float)RAMP_TICK * (float)m_frequency / fabsf(speed);
+  if (IntervalL >= (float)MAX_INTERVAL)
+  {
+    return MAX_INTERVAL;
+  }
+  if (IntervalL < (float)RAMP_TICK)
+  {
+    // Not more than one step per timer period.
+    return RAMP_TICK;
+  }
+
+  return (uint32_t)(IntervalL + 0.5F);
+}
+
+#pragma endregion // Timer Stepper
@@ -57,13 +57,60 @@
 
 #if defined(ENABLE_MOTORS)
 #include <AccelStepper.h>
-#include <MultiStepper.h>
+#include "Axis.h"
 #endif // defined(ENABLE_MOTORS)
 
+#if defined(ENABLE_STEP_TIMER)
+#include "TimerStepper.h"
+#include "StepOutput.h"
+#endif // defined(ENABLE_STEP_TIMER)
+
+#if defined(ENABLE_MOTION_QUEUE)
+#include "MotionQueue.h"
+#endif // defined(ENABLE_MOTION_QUEUE)
+
+#if defined(ENABLE_COORDINATED_MOTION)
+#include "CoordinatedMotion.h"
+#endif // defined(ENABLE_COORDINATED_MOTION)
+
+#if defined(ENABLE_INPUT_SHAPER)
+#include "InputShaper.h"
+#endif // defined(ENABLE_INPUT_SHAPER)
+
+#if defined(ENABLE_JOINT_COUPLING)
+#include "JointCoupling.h"
+#endif // defined(ENABLE_JOINT_COUPLING)
+
+#if defined(ENABLE_PVT_STREAM)
+#include "PvtStream.h"
+#endif // defined(ENABLE_PVT_STREAM)
+
+#if defined(ENABLE_MOTORS) || defined(ENABLE_PS4)
+#include "WristTransform.h"
+#endif // defined(ENABLE_MOTORS) || defined(ENABLE_PS4)
+
+#if defined(ENABLE_KINEMATICS)
+#include "Kinematics.h"
+#endif // defined(ENABLE_KINEMATICS)
+
+#if defined(ENABLE_LINEAR_MOVE)
+#include "LinearPath.h"
+#endif // defined(ENABLE_LINEAR_MOVE)
+
+#include "EStop.h"
+
 #if defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
-#include <Button2.h>
+#include "InputScanner.h"
 #endif // defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
 
+#if defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+#include "Homing.h"
+#endif // defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_POSITION_JOURNAL)
+#include "PositionJournal.h"
+#endif // defined(ENABLE_POSITION_JOURNAL)
+
 #if defined(ENABLE_FEATURES_FLAGS)
 #include <Preferences.h>
 #endif // defined(ENABLE_FEATURES_FLAGS)
@@ -111,9 +158,9 @@
 #include "JointPositionUnion.h"
 #endif // defined(ENABLE_MOTORS) || defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
 
-#if defined(ENABLE_WDT) || defined(ENABLE_PS4)
+#if defined(ENABLE_WDT) || defined(ENABLE_PS4) || defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
 #include "FxTimer.h"
-#endif // defined(ENABLE_WDT) || defined(ENABLE_PS4)
+#endif // defined(ENABLE_WDT) || defined(ENABLE_PS4) || defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
 
 #if defined(ENABLE_STATUS_LCD)
 #include "freertos/FreeRTOS.h"
@@ -139,8 +186,99 @@
  * @brief Command parser type.
  *
  */
-typedef CommandParser<CMDS_COUNT, ARGS_COUNT, CMD_NAME_LENGTH, ARGS_LENGTH> CommandParser_t;
+typedef CommandParser<CMDS_COUNT, ARGS_COUNT, CMD_NAME_LENGTH, ARGS_LENGTH, RESPONSE_LENGTH> CommandParser_t;
 #endif            // define(ENABLE_TCM_COMMANDS)
+
+#if defined(ENABLE_MOTORS)
+/**
+ * @brief Stepper driver type.
+ *
+ */
+#if defined(ENABLE_STEP_TIMER)
+typedef TimerStepper Stepper_t;
+#else
+typedef AccelStepper Stepper_t;
+#endif // defined(ENABLE_STEP_TIMER)
+
+/**
+ * @brief Axises descriptors.
+ *
+ */
+typedef Axis<0, PIN_STP_1, PIN_DIR_1, false, M1_MAX_SPEED, M1_ACCEL, M1_JERK> Axis1_t;
+typedef Axis<1, PIN_STP_2, PIN_DIR_2, false, M2_MAX_SPEED, M2_ACCEL, M2_JERK> Axis2_t;
+typedef Axis<2, PIN_STP_3, PIN_DIR_3, true, M3_MAX_SPEED, M3_ACCEL, M3_JERK> Axis3_t;
+typedef Axis<3, PIN_STP_4, PIN_DIR_4, false, M4_MAX_SPEED, M4_ACCEL, M4_JERK> Axis4_t;
+typedef Axis<4, PIN_STP_5, PIN_DIR_5, true, M5_MAX_SPEED, M5_ACCEL, M5_JERK> Axis5_t;
+typedef Axis<5, PIN_STP_6, PIN_DIR_6, true, M6_MAX_SPEED, M6_ACCEL, M6_JERK> Axis6_t;
+
+/**
+ * @brief All axises of the robot.
+ *
+ */
+typedef AxisTable<Axis1_t, Axis2_t, Axis3_t, Axis4_t, Axis5_t, Axis6_t> Axises_t;
+
+#if defined(ENABLE_SHMR)
+/**
+ * @brief Axises of the SHMR synchronized moves, q1, q2, q3 and the gripper.
+ *
+ */
+typedef AxisTable<Axis3_t, Axis1_t, Axis2_t, Axis6_t> SHMRAxises_t;
+#endif // defined(ENABLE_SHMR)
+#endif // defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_MOTION_QUEUE)
+/**
+ * @brief Motion segment, absolute targets of all axises and their limits.
+ *
+ */
+typedef struct
+{
+  long Target[Axises_t::COUNT];
+  /** @brief Maximum speed of the target, 0 keeps the axis limits. [steps/s] */
+  float MaxSpeed[Axises_t::COUNT];
+  /** @brief Acceleration of the target, 0 keeps the axis limits. [steps/s^2] */
+  float Acceleration[Axises_t::COUNT];
+} MotionSegment_t;
+
+/**
+ * @brief Motion queue type.
+ *
+ */
+typedef MotionQueue<MotionSegment_t, MOTION_QUEUE_SIZE> MotionQueue_t;
+#endif // defined(ENABLE_MOTION_QUEUE)
+
+#if defined(ENABLE_LIMIT_LATCH)
+/**
+ * @brief Positions of an axis latched on the edges of its limit switch.
+ *
+ */
+typedef struct
+{
+  volatile long Pressed;  ///< Position on the last edge to pressed. [steps]
+  volatile long Released; ///< Position on the last edge to released. [steps]
+  volatile uint32_t Time; ///< Time of the last edge. [us]
+  volatile uint16_t Edges; ///< Number of the edges.
+  volatile uint16_t PressedEdge;  ///< Number of the last edge to pressed.
+  volatile uint16_t ReleasedEdge; ///< Number of the last edge to released.
+} LimitLatch_t;
+#endif // defined(ENABLE_LIMIT_LATCH)
+
+#if defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
+/**
+ * @brief Extended telemetry, the state of the robot at one time.
+ *
+ */
+typedef struct
+{
+  uint32_t Time;                      ///< Time of the reading. [us]
+  int32_t Position[TELEMETRY_AXISES]; ///< Joint positions. [steps]
+  int32_t Speed[TELEMETRY_AXISES];    ///< Joint speeds. [steps/s, fixed point with TELEMETRY_SPEED_SHIFT fraction bits]
+  uint8_t MotorState;                 ///< Moving axises, bit per axis.
+  uint8_t Inputs;                     ///< Debounced inputs, bit per input.
+  uint8_t Valid;                      ///< Axises with a homed position, bit per axis.
+  uint8_t Flags;                      ///< TELEMETRY_FLAG_* bits.
+} Telemetry_t;
+#endif // defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
 #pragma endregion // Types
 
 #pragma region Enums
@@ -150,7 +288,29 @@ enum OperationModes : uint8_t
   NONE = 0U,
   Positioning,
   Speed,
+  Coordinated,
+  Stream,
+  Synchronized,
+};
+
+#if defined(ENABLE_SHMR)
+enum class GripperJobs : uint8_t
+{
+  Idle = 0U,
+  Grip,
+  Ungrip,
+  Spread,
+  OpenTo,
+};
+
+enum class GripperResults : uint8_t
+{
+  Running = 0U,
+  Done,
+  Failed,
+  Stopped,
 };
+#endif // defined(ENABLE_SHMR)
 
 #pragma endregion // Enums
 
@@ -182,13 +342,234 @@ void init_drivers();
  */
 void enable_drivers(bool state);
 
+#if defined(ENABLE_POSITION_JOURNAL)
+/**
+ * @brief Open the position journal and restore the positions of the axises.
+ *
+ */
+void init_journal();
+
+/**
+ * @brief Write the positions to the journal at rest.
+ *
+ */
+void update_journal();
+#endif // defined(ENABLE_POSITION_JOURNAL)
+
+#if defined(ENABLE_MOTORS)
+/**
+ * @brief Mark the start of a motion in the journal, before the motion is released.
+ *
+ */
+void journal_motion();
+#endif // defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_JOINT_COUPLING)
+/**
+ * @brief Set the couplings of the joints from the configuration.
+ *
+ */
+void init_coupling();
+#endif // defined(ENABLE_JOINT_COUPLING)
+
 /**
  * @brief Update the stepper drivers.
  *
  */
 void update_drivers();
+
+/**
+ * @brief Command the speed of the axis, it ramps there with the axis acceleration.
+ *
+ * @param index Axis index.
+ * @param speed Speed. [steps/s]
+ */
+void set_axis_speed(uint8_t index, float speed);
+
+/**
+ * @brief Set the maximum speed and the acceleration of the axis.
+ *
+ * @param stepper Stepper driver of the axis.
+ * @param maxSpeed Maximum speed. [steps/s]
+ * @param acceleration Acceleration. [steps/s^2]
+ */
+void set_axis_limits(Stepper_t &stepper, float maxSpeed, float acceleration);
+
+#if defined(ENABLE_WRIST_TRANSFORM)
+/**
+ * @brief Limits of the wrist motors, so both of them arrive together.
+ *
+ * @param left Distance of the left motor. [steps]
+ * @param right Distance of the right motor. [steps]
+ * @param maxSpeeds Maximum speeds of the left and the right motor. [steps/s]
+ * @param accels Accelerations of the left and the right motor. [steps/s^2]
+ */
+void wrist_limits(long left, long right, float *maxSpeeds, float *accels);
+
+/**
+ * @brief Scale the limits of the wrist motors, so both of them arrive together.
+ *
+ * @param left Distance of the left motor. [steps]
+ * @param right Distance of the right motor. [steps]
+ */
+void sync_wrist(long left, long right);
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+
+#if defined(ENABLE_DRIVERS_BENCHMARK)
+/**
+ * @brief Update the stepper drivers, hand written version for the benchmark.
+ *
+ */
+void update_drivers_legacy();
+
+/**
+ * @brief Measure the CPU cycles of update_drivers().
+ *
+ */
+void benchmark_drivers();
+#endif // defined(ENABLE_DRIVERS_BENCHMARK)
 #endif // defined(ENABLE_MOTORS)
 
+#if defined(ENABLE_MOTION_QUEUE)
+/**
+ * @brief Hand the queued segments to the stepper drivers.
+ *
+ */
+void update_motion_queue();
+
+/**
+ * @brief Add segment to the motion queue.
+ *
+ * @param value Joint positions.
+ * @param relative The positions are relative to the end of the queue.
+ * @return true Queued.
+ * @return false The queue is full.
+ */
+bool enqueue_segment(JointPosition_t &value, bool relative);
+#endif // defined(ENABLE_MOTION_QUEUE)
+
+#if defined(ENABLE_COORDINATED_MOTION)
+/**
+ * @brief Start coordinated move of all axises.
+ *
+ * @param value Joint positions, the speeds limit the axises.
+ * @return true The move is started.
+ * @return false Nothing to move.
+ */
+bool move_coordinated(JointPosition_t &value);
+#endif // defined(ENABLE_COORDINATED_MOTION)
+
+#if defined(ENABLE_PVT_STREAM)
+/**
+ * @brief Prepare the next PVT segment for the step timer.
+ *
+ */
+void update_pvt_stream();
+
+/**
+ * @brief Start the PVT stream from the current positions.
+ *
+ */
+void begin_pvt_stream();
+
+/**
+ * @brief Fill the status of the PVT stream.
+ *
+ * @param payload Response buffer, 7 bytes.
+ * @return uint8_t Length of the status.
+ */
+uint8_t pvt_stream_status(uint8_t *payload);
+#endif // defined(ENABLE_PVT_STREAM)
+
+#if defined(ENABLE_KINEMATICS)
+/**
+ * @brief Initialize the kinematics with the calibration.
+ *
+ */
+void init_kinematics();
+
+/**
+ * @brief Joint positions of the arm, the wrist as the pitch and the roll.
+ *
+ * @param steps Joint positions. [steps]
+ */
+void joint_steps(long *steps);
+
+/**
+ * @brief Pose of the tool on the current positions.
+ *
+ * @return const KinematicsPose& Tool pose.
+ */
+const KinematicsPose &read_pose();
+
+/**
+ * @brief Fill the pose of the tool.
+ *
+ * @param payload Response buffer, 20 bytes.
+ * @return uint8_t Length of the pose.
+ */
+uint8_t pose_payload(uint8_t *payload);
+#endif // defined(ENABLE_KINEMATICS)
+
+#if defined(ENABLE_LINEAR_MOVE)
+/**
+ * @brief Motor positions of a pose.
+ *
+ * @param pose Tool pose.
+ * @param angles Joint angles near the solution in, the solution out. [deg]
+ * @param motors Motor positions of all axises. [steps]
+ * @return true Solved.
+ * @return false The pose is out of reach.
+ */
+bool pose_motors(const KinematicsPose &pose, float *angles, long *motors);
+
+/**
+ * @brief Start a straight line move of the tool.
+ *
+ * The move is slowed down when a joint would run over its maximum speed.
+ *
+ * @param target Target pose.
+ * @param speed Tool point speed. [mm/s]
+ * @return true The move is started.
+ * @return false Nothing to move or a pose of the line is out of reach.
+ */
+bool move_linear(const KinematicsPose &target, float speed);
+
+/**
+ * @brief Feed the points of the straight line move to the PVT stream.
+ *
+ */
+void update_linear_move();
+#endif // defined(ENABLE_LINEAR_MOVE)
+
+#if defined(ENABLE_STEP_TIMER)
+/**
+ * @brief Initialize the step timer.
+ *
+ */
+void init_step_timer();
+
+/**
+ * @brief Step timer interrupt, generates the step pulses of all axises.
+ *
+ */
+void isr_step_timer();
+#endif // defined(ENABLE_STEP_TIMER)
+
+#if defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
+/**
+ * @brief Start the scan of the inputs.
+ *
+ */
+void init_inputs();
+
+/**
+ * @brief Scan the inputs at their fixed rate.
+ *
+ */
+void update_inputs();
+#endif // defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
+
 #if defined(ENABLE_LIMITS)
 /**
  * @brief Initialize the limit switches.
@@ -196,17 +577,86 @@ void update_drivers();
  */
 void init_limits();
 
+#if defined(ENABLE_MOTORS)
+/**
+ * @brief Pressed limit switches.
+ *
+ * @return uint8_t Bit per axis index.
+ */
+uint8_t limits_pressed();
+
+/**
+ * @brief Initialize the homing of the axises with a limit switch.
+ *
+ */
+void init_homing();
+
+/**
+ * @brief Start the homing.
+ *
+ * @param axises Axises to home, bit per axis index, the ones without a switch are left out.
+ * @return true Started.
+ * @return false No axis to home.
+ */
+bool start_homing(uint8_t axises);
+
+/**
+ * @brief Stop the homing, the axises stop with their acceleration.
+ *
+ */
+void stop_homing();
+
+/**
+ * @brief Advance the homing, called from the main loop.
+ *
+ */
+void update_homing();
+
 /**
- * @brief Update limit switches input state.
+ * @brief Fill the status of the homing.
  *
+ * @param payload Response buffer, 5 bytes.
+ * @return uint8_t Length of the status.
  */
-void update_limits();
+uint8_t homing_status(uint8_t *payload);
 
+#if defined(ENABLE_LIMIT_LATCH)
 /**
- * @brief Find the limits of the axises.
+ * @brief Attach the latch interrupts to the limit switches.
  *
  */
-void find_limits();
+void init_limit_latch();
+
+/**
+ * @brief Limit switch interrupt, latch the position of the axis on the edge.
+ *
+ * @tparam A Axis.
+ * @tparam PIN Limit switch pin.
+ */
+template <typename A, uint8_t PIN>
+void isr_limit_latch();
+
+/**
+ * @brief Position of the axis on the last latched edge after the given one.
+ *
+ * @param index Axis index.
+ * @param pressed Edge to pressed, else to released.
+ * @param since Number of the edges before.
+ * @param position Latched position, unchanged without such edge. [steps]
+ * @return true There is such edge.
+ * @return false No edge latched since.
+ */
+bool limit_latch_edge(uint8_t index, bool pressed, uint16_t since, long &position);
+
+/**
+ * @brief Fill the latched positions of the limit switches.
+ *
+ * @param payload Response buffer, 56 bytes.
+ * @return uint8_t Length of the positions.
+ */
+uint8_t limit_latch_payload(uint8_t *payload);
+#endif // defined(ENABLE_LIMIT_LATCH)
+#endif // defined(ENABLE_MOTORS)
 
 #endif // defined(ENABLE_LIMITS)
 
@@ -222,6 +672,20 @@ void init_estop();
  *
  */
 void update_estop();
+
+/**
+ * @brief E-Stop interrupt, latch the fault and stop the steps and the drivers.
+ *
+ */
+void isr_estop();
+
+/**
+ * @brief Clear the E-Stop fault.
+ *
+ * @return true Cleared.
+ * @return false The E-Stop is still active.
+ */
+bool reset_estop();
 #endif // defined(ENABLE_ESTOP)
 
 #if defined(ENABLE_WIFI)
@@ -278,7 +742,24 @@ void init_wg();
 void init_ota();
 #endif // defined(ENABLE_OTA)
 
+#if defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
+/**
+ * @brief Read the extended telemetry.
+ *
+ * @param telemetry Telemetry.
+ */
+void read_telemetry(Telemetry_t &telemetry);
+#endif // defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
+
 #if defined(ENABLE_SUPER)
+/**
+ * @brief Fill the extended telemetry frame.
+ *
+ * @param payload Response buffer, TELEMETRY_LENGTH bytes.
+ * @return uint8_t Length of the frame.
+ */
+uint8_t telemetry_payload(uint8_t *payload);
+
 /**
  * @brief Initialize the SUPER.
  *
@@ -338,6 +819,14 @@ void cmd_close(CommandParser_t::Argument *args, char *response);
  */
 void cmd_read(CommandParser_t::Argument *args, char *response);
 
+/**
+ * @brief Read Command with the extended telemetry (@READX)
+ *
+ * @param args
+ * @param response
+ */
+void cmd_readx(CommandParser_t::Argument *args, char *response);
+
 /**
  * @brief 221 / 228 Reset Command F.6 (@RESET)
  *
@@ -361,44 +850,104 @@ void cmd_set(CommandParser_t::Argument *args, char *response);
  * @param response
  */
 void cmd_step(CommandParser_t::Argument *args, char *response);
-#endif // defined(ENABLE_TCM_COMMANDS)
 
-#if defined(ENABLE_WDT)
+#if defined(ENABLE_COORDINATED_MOTION)
 /**
- * @brief Initialise the WDT.
+ * @brief Coordinated variant of @STEP (@STEPC)
  *
+ * @param args
+ * @param response
  */
-void init_wdt();
+void cmd_stepc(CommandParser_t::Argument *args, char *response);
+#endif // defined(ENABLE_COORDINATED_MOTION)
 
+#if defined(ENABLE_KINEMATICS)
 /**
- * @brief Update WDT.
+ * @brief Read the pose of the tool (@POSE)
  *
+ * @param args
+ * @param response
  */
-void update_wdt();
+void cmd_pose(CommandParser_t::Argument *args, char *response);
+#endif // defined(ENABLE_KINEMATICS)
 
+#if defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
 /**
- * @brief Feed the WDT.
+ * @brief Start the homing of all axises with a limit switch (HOME)
  *
+ * @param args
+ * @param response
  */
-void feed_wdt();
+void cmd_home(CommandParser_t::Argument *args, char *response);
 
 /**
- * @brief WDT expiration check function.
+ * @brief Read the progress of the homing (@HOMING)
  *
- * @return true
- * @return false
+ * @param args
+ * @param response
  */
-bool wdt_expired();
-#endif // defined(ENABLE_WDT)
+void cmd_homing(CommandParser_t::Argument *args, char *response);
+#endif // defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
 
-#if defined(ENABLE_STATUS_LCD)
-bool is_i2c_dev_connected(uint8_t address, unsigned long timeout);
-
-void init_lcd();
-
-void check_lcd();
-
-void draw_lcd();
+#if defined(ENABLE_ESTOP)
+/**
+ * @brief Clear the E-Stop fault (@ESRESET)
+ *
+ * @param args
+ * @param response
+ */
+void cmd_estop_reset(CommandParser_t::Argument *args, char *response);
+#endif // defined(ENABLE_ESTOP)
+#endif // defined(ENABLE_TCM_COMMANDS)
+
+#if defined(ENABLE_WDT)
+/**
+ * @brief Initialise the WDT.
+ *
+ */
+void init_wdt();
+
+/**
+ * @brief Update WDT.
+ *
+ */
+void update_wdt();
+
+/**
+ * @brief Feed the WDT.
+ *
+ */
+void feed_wdt();
+
+/**
+ * @brief WDT expiration check function.
+ *
+ * @return true
+ * @return false
+ */
+bool wdt_expired();
+
+/**
+ * @brief Stop the motion with the deceleration of the axises, on the WDT expiration.
+ *
+ */
+void wdt_stop();
+
+/**
+ * @brief Continue after the WDT stop, the positions are kept.
+ *
+ */
+void wdt_resume();
+#endif // defined(ENABLE_WDT)
+
+#if defined(ENABLE_STATUS_LCD)
+bool is_i2c_dev_connected(uint8_t address, unsigned long timeout);
+
+void init_lcd();
+
+void check_lcd();
+
+void draw_lcd();
 
 void display_text_animation();
 
@@ -413,11 +962,50 @@ float getGripperAbsoluteDistance_FromPayload(uint8_t *payload);
 
 void getAbsolute_Angles_q1q2q3_FromPayload(uint8_t *payload, float *q);
 
-void gripperOpenTo(float a6);
+/**
+ * @brief Start to open the gripper to the distance.
+ *
+ * @param a6 Distance between the jaws. [mm]
+ * @return true Started.
+ * @return false An other gripper job runs.
+ */
+bool gripperOpenTo(float a6);
+
+/**
+ * @brief Start to close the gripper until its limit switch.
+ *
+ * @return true Started, or the gripper is closed.
+ * @return false An other gripper job runs.
+ */
+bool gripperGrip();
+
+/**
+ * @brief Start to open the gripper from its limit switch.
+ *
+ * @return true Started, or the gripper is open.
+ * @return false An other gripper job runs.
+ */
+bool gripperUngrip();
+
+/**
+ * @brief Check the gripper limit switch.
+ *
+ * @return true The gripper is closed.
+ * @return false The gripper is open.
+ */
+bool gripper_closed();
 
-void gripperGrip();
+/**
+ * @brief Advance the gripper job, called from the main loop.
+ *
+ */
+void update_gripper();
 
-void gripperUngrip();
+/**
+ * @brief Stop the gripper job, the gripper stops with its acceleration.
+ *
+ */
+void stop_gripper();
 
 void goToStartPositions();
 
@@ -425,7 +1013,24 @@ void ResetGripper();
 
 void setMotorsSpeed(float motorSpeed_[]);
 
-void sendTaskToSteppers(float a1, float a2, float a3, float a6);
+/**
+ * @brief Start the SHMR move, q1, q2, q3 and the gripper arrive together.
+ *
+ * @param a1 q1. [deg]
+ * @param a2 q2. [deg]
+ * @param a3 q3. [deg]
+ * @param a6 Distance between the jaws. [mm]
+ * @return true Started.
+ * @return false A gripper job runs.
+ */
+bool sendTaskToSteppers(float a1, float a2, float a3, float a6);
+
+/**
+ * @brief Move the SHMR axises to the targets with the same time profile.
+ *
+ * @param targets Targets in the order of SHMRAxises_t. [steps]
+ */
+void move_synchronized(const long *targets);
 
 #endif // defined(ENABLE_SHMR)
 
@@ -441,6 +1046,14 @@ void init_ps4();
  * 
  */
 void update_ps4();
+
+#if defined(ENABLE_PS4_CARTESIAN)
+/**
+ * @brief Jog the tool in X, Y, Z, pitch and roll with the sticks.
+ *
+ */
+void jog_ps4_cartesian();
+#endif // defined(ENABLE_PS4_CARTESIAN)
 #endif // defined(ENABLE_PS4)
 
 #pragma endregion // Prototypes
@@ -467,16 +1080,16 @@ uint8_t MotorState_g;
 uint8_t OperationMode_g;
 
 /**
- * @brief Safety stop flag.
+ * @brief E-Stop fault latch, never latched without the E-Stop.
  *
  */
-int SafetyStopFlag_g;
+EStop EStop_g;
 
 /**
- * @brief Store position flag.
+ * @brief Axises with a position to their homed zero, bit per axis index.
  *
  */
-bool StorePosition_g;
+uint8_t PositionValid_g;
 
 /**
  * @brief Move joint in absolute mode.
@@ -506,78 +1119,214 @@ JointPositionUnion CurrentPositions_g;
 
 #if defined(ENABLE_MOTORS)
 /**
- * @brief TCP server for robot operation service.
+ * @brief Stepper drivers instances, in the order of Axises_t.
+ *
+ */
+Stepper_t Steppers_g[Axises_t::COUNT];
+
+/**
+ * @brief Stepper driver instance for the base.
+ *
+ */
+Stepper_t &stepper1 = Steppers_g[Axis1_t::INDEX];
+
+/**
+ * @brief Stepper driver instance for the shoulder.
+ *
+ */
+Stepper_t &stepper2 = Steppers_g[Axis2_t::INDEX];
+
+/**
+ * @brief Stepper driver instance for the elbow.
  *
  */
-AccelStepper stepper1;
+Stepper_t &stepper3 = Steppers_g[Axis3_t::INDEX];
 
 /**
- * @brief Stepper driver instance for .
+ * @brief Stepper driver instance for the left differential.
  *
  */
-AccelStepper stepper2;
+Stepper_t &stepper4 = Steppers_g[Axis4_t::INDEX];
 
 /**
- * @brief Stepper driver instance for .
+ * @brief Stepper driver instance for the right differential.
  *
  */
-AccelStepper stepper3;
+Stepper_t &stepper5 = Steppers_g[Axis5_t::INDEX];
 
 /**
- * @brief Stepper driver instance for .
+ * @brief Stepper driver instance for the gripper.
  *
  */
-AccelStepper stepper4;
+Stepper_t &stepper6 = Steppers_g[Axis6_t::INDEX];
 
+#if !defined(ENABLE_STEP_TIMER)
 /**
- * @brief Stepper driver instance for .
+ * @brief Commanded speeds of the axises in speed mode. [steps/s]
  *
  */
-AccelStepper stepper5;
+float SpeedTargets_g[Axises_t::COUNT];
 
 /**
- * @brief Stepper driver instance for .
+ * @brief Time of the last speed ramp update. [us]
  *
  */
-AccelStepper stepper6;
+unsigned long SpeedRampTime_g;
+#endif // !defined(ENABLE_STEP_TIMER)
 
 #endif // defined(ENABLE_MOTORS)
 
+#if defined(ENABLE_MOTION_QUEUE)
+/**
+ * @brief Queued motion segments.
+ *
+ */
+MotionQueue_t MotionQueue_g;
+#endif // defined(ENABLE_MOTION_QUEUE)
+
+#if defined(ENABLE_COORDINATED_MOTION)
+/**
+ * @brief Coordinated move of the axises.
+ *
+ */
+CoordinatedMotion Coordinated_g;
+#endif // defined(ENABLE_COORDINATED_MOTION)
+
+#if defined(ENABLE_SCURVE)
+/**
+ * @brief S-curve ramps of the axises, built at run time.
+ *
+ */
+SCurveTable SCurves_g[Axises_t::COUNT];
+
+/**
+ * @brief Axises bits with S-curve ramp.
+ *
+ */
+uint8_t SCurveAxises_g = SCURVE_AXISES;
+#endif // defined(ENABLE_SCURVE)
+
+#if defined(ENABLE_INPUT_SHAPER)
+/**
+ * @brief Input shapers of the axises.
+ *
+ */
+InputShaper Shapers_g[Axises_t::COUNT];
+#endif // defined(ENABLE_INPUT_SHAPER)
+
+#if defined(ENABLE_JOINT_COUPLING)
+/**
+ * @brief Coupling of the joints, compensated on the motor steps.
+ *
+ */
+JointCoupling Coupling_g;
+#endif // defined(ENABLE_JOINT_COUPLING)
+
+#if defined(ENABLE_PVT_STREAM)
+/**
+ * @brief Stream of host planned points.
+ *
+ */
+PvtStream Pvt_g;
+#endif // defined(ENABLE_PVT_STREAM)
+
+#if defined(ENABLE_KINEMATICS)
+/**
+ * @brief Kinematics of the arm.
+ *
+ */
+Kinematics Kinematics_g;
+#endif // defined(ENABLE_KINEMATICS)
+
+#if defined(ENABLE_LINEAR_MOVE)
+/**
+ * @brief Straight line move of the tool.
+ *
+ */
+LinearPath Linear_g;
+
+/**
+ * @brief Joint angles of the last point of the line. [deg]
+ *
+ */
+float LinearAngles_g[KINEMATICS_JOINTS];
+#endif // defined(ENABLE_LINEAR_MOVE)
+
+#if defined(ENABLE_STEP_TIMER)
+/**
+ * @brief Acceleration ramps of the axises, built by the compiler.
+ *
+ * @note The step timer interrupt reads them, so they are in DRAM.
+ */
+DRAM_ATTR const RampTable Ramps_g[Axises_t::COUNT] = {
+  ramp_table<STEP_TIMER_FREQUENCY, Axis1_t::ACCEL>(),
+  ramp_table<STEP_TIMER_FREQUENCY, Axis2_t::ACCEL>(),
+  ramp_table<STEP_TIMER_FREQUENCY, Axis3_t::ACCEL>(),
+  ramp_table<STEP_TIMER_FREQUENCY, Axis4_t::ACCEL>(),
+  ramp_table<STEP_TIMER_FREQUENCY, Axis5_t::ACCEL>(),
+  ramp_table<STEP_TIMER_FREQUENCY, Axis6_t::ACCEL>(),
+};
+#endif // defined(ENABLE_STEP_TIMER)
+
+#if defined(ENABLE_POSITION_JOURNAL)
+/**
+ * @brief Journal of the axis positions in the flash.
+ *
+ */
+PositionJournal Journal_g;
+
+/**
+ * @brief Time of the last journal record. [ms]
+ *
+ */
+unsigned long JournalTime_g;
+#endif // defined(ENABLE_POSITION_JOURNAL)
+
 #if defined(ENABLE_LIMITS)
+#if defined(ENABLE_MOTORS)
 /**
- * @brief Limit switch for M1.
+ * @brief Homing of the axises with a limit switch.
  *
  */
-Button2 M1LimitSwitch_g;
+Homing Homing_g;
 
+#if defined(ENABLE_LIMIT_LATCH)
 /**
- * @brief Limit switch for M2.
+ * @brief Positions latched on the limit switch edges, by axis index.
  *
  */
-Button2 M2LimitSwitch_g;
+LimitLatch_t LimitLatches_g[Axises_t::COUNT];
 
 /**
- * @brief Limit switch for M3.
+ * @brief Steps planned for the axises and not output yet, by axis index.
  *
+ * The shaper delays the steps and the coupling adds the compensation,
+ * the motor is on the planner position minus the lag.
  */
-Button2 M3LimitSwitch_g;
+volatile long OutputLags_g[Axises_t::COUNT];
 
 /**
- * @brief Limit switch for M6.
+ * @brief Number of the latched edges when the homing started, by axis index.
  *
  */
-Button2 M6LimitSwitch_g;
+uint16_t HomingEdges_g[Axises_t::COUNT];
+#endif // defined(ENABLE_LIMIT_LATCH)
+#endif // defined(ENABLE_MOTORS)
 #endif // defined(ENABLE_LIMITS)
 
-#if defined(ENABLE_ESTOP)
+#if defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
 /**
- * @brief Limit switch for M1.
+ * @brief Limit switches and E-Stop inputs.
  *
  */
-Button2 EStopSwitch_g;
-#endif // defined(ENABLE_ESTOP)
+InputScanner Inputs_g;
+
+/**
+ * @brief Scan period timer of the inputs.
+ *
+ */
+FxTimer *InputsScanTimer_g;
 
-#if defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
 /**
  * @brief Limit switches states.
  *
@@ -745,6 +1494,12 @@ FxTimer *WatchDogTimer_g;
  *
  */
 int WatchDogCounter_g;
+
+/**
+ * @brief The motion is stopped by the WDT.
+ *
+ */
+bool WatchDogStop_g;
 #endif // defined(ENABLE_WDT)
 
 #if defined(ENABLE_STATUS_LCD)
@@ -794,12 +1549,6 @@ char LCDSecondLine_g[LCD_COLUMNS];
 #endif // defined(ENABLE_STATUS_LCD)
 
 #if defined(ENABLE_SHMR)
-/**
- * @brief Multistepper controller.
- *
- */
-MultiStepper steppers;
-
 /**
  * @brief Passed positions storage.
  *
@@ -812,6 +1561,24 @@ long positions_[AXIS_TO_CONTROL];
  */
 float oldA2, oldA3, a6_offset_a2_a3_;
 
+/**
+ * @brief Running gripper job, GripperJobs.
+ *
+ */
+GripperJobs GripperJob_g;
+
+/**
+ * @brief Result of the last gripper job, GripperResults.
+ *
+ */
+GripperResults GripperResult_g;
+
+/**
+ * @brief Start time of the gripper job. [ms]
+ *
+ */
+unsigned long GripperTime_g;
+
 #endif // defined(ENABLE_SHMR)
 
 #if defined(ENABLE_PS4)
@@ -834,6 +1601,14 @@ bool PS4TimeToUpdate_g;
  */
 uint32_t PS4SleepCounter_g;
 #endif // defined(ENABLE_SLEEP_MODE)
+
+#if defined(ENABLE_PS4_CARTESIAN)
+/**
+ * @brief The sticks jog the tool, not the joints.
+ *
+ */
+bool PS4Cartesian_g;
+#endif // defined(ENABLE_PS4_CARTESIAN)
 #endif // defined(ENABLE_PS4)
 
 #pragma endregion // Variables
@@ -863,15 +1638,37 @@ void setup()
   init_drivers();
 #endif // defined(ENABLE_MOTORS)
 
+#if defined(ENABLE_KINEMATICS)
+  init_kinematics();
+#endif // defined(ENABLE_KINEMATICS)
+
+#if defined(ENABLE_STEP_TIMER)
+  init_step_timer();
+#endif // defined(ENABLE_STEP_TIMER)
+
+#if defined(ENABLE_DRIVERS_BENCHMARK)
+  benchmark_drivers();
+#endif // defined(ENABLE_DRIVERS_BENCHMARK)
+
 #if defined(ENABLE_LIMITS)
   init_limits();
-  // find_limits();
+#if defined(ENABLE_MOTORS)
+  init_homing();
+#if defined(ENABLE_LIMIT_LATCH)
+  init_limit_latch();
+#endif // defined(ENABLE_LIMIT_LATCH)
+  // start_homing(Axises_t::BITS);
+#endif // defined(ENABLE_MOTORS)
 #endif // defined(ENABLE_LIMITS)
 
 #if defined(ENABLE_ESTOP)
   init_estop();
 #endif // defined(ENABLE_ESTOP)
 
+#if defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
+  init_inputs();
+#endif // defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
+
 #if defined(ENABLE_FEATURES_FLAGS)
   // Open Preferences with my-app namespace. Each application module, library, etc
   // has to use a namespace name to prevent key name collisions. We will open storage in
@@ -947,19 +1744,6 @@ void setup()
   digitalWrite(SS, HIGH); // Setting SlaveSelect as HIGH (So master does not connect with slave)
 #endif // defined(ENABLE_SPI_IO)
 
-#if defined(ENABLE_SHMR)
-  steppers = MultiStepper();
-
-  // Slow speed.
-  float speeds[4] = {MOTOR_SLOW_SPEED, MOTOR_SLOW_SPEED, MOTOR_SLOW_SPEED, MOTOR_SLOW_SPEED_6};
-  setMotorsSpeed(speeds);
-
-  steppers.addStepper(stepper4); // q1
-  steppers.addStepper(stepper1); // q2
-  steppers.addStepper(stepper2); // q3
-  steppers.addStepper(stepper6);
-#endif // defined(ENABLE_SHMR)
-
 #if defined(ENABLE_PS4)
   init_ps4();
 #endif // defined(ENABLE_PS4)
@@ -977,13 +1761,17 @@ void setup()
 void loop()
 {
 
+#if defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
+  update_inputs();
+#endif // defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
+
 #if defined(ENABLE_ESTOP)
   update_estop();
 #endif // defined(ENABLE_ESTOP)
 
-#if defined(ENABLE_LIMITS)
-  update_limits();
-#endif // defined(ENABLE_LIMITS)
+#if defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+  update_homing();
+#endif // defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
 
 #if defined(ENABLE_WDT)
   update_wdt();
@@ -1018,28 +1806,30 @@ void loop()
 #endif // defined(ENABLE_OTA)
 
 #if defined(ENABLE_MOTORS)
-  if (SafetyStopFlag_g == LOW)
+  if (!EStop_g.latched())
   {
     // Robko01.update();
     // MotorState_g = Robko01.get_motor_state();
+#if defined(ENABLE_MOTION_QUEUE)
+    update_motion_queue();
+#endif // defined(ENABLE_MOTION_QUEUE)
+#if defined(ENABLE_LINEAR_MOVE)
+    update_linear_move();
+#endif // defined(ENABLE_LINEAR_MOVE)
+#if defined(ENABLE_PVT_STREAM)
+    update_pvt_stream();
+#endif // defined(ENABLE_PVT_STREAM)
     update_drivers();
+#if defined(ENABLE_SHMR)
+    update_gripper();
+#endif // defined(ENABLE_SHMR)
   }
 
-  if (MotorState_g == 0 && StorePosition_g)
-  {
-    StorePosition_g = false;
-    // TODO: Save position.
-  }
-  else
-  {
-    StorePosition_g = true;
-  }
+#if defined(ENABLE_POSITION_JOURNAL)
+  update_journal();
+#endif // defined(ENABLE_POSITION_JOURNAL)
 #endif // defined(ENABLE_MOTORS)
 
-#if defined(ENABLE_SHMR)
-// steppers.run();
-#endif // defined(ENABLE_SHMR)
-
 #if defined(ENABLE_STATUS_LCD)
 #endif // defined(ENABLE_STATUS_LCD)
 }
@@ -1165,88 +1955,1860 @@ if (!EnableMotorsIO_g)
 #endif // defined(ENABLE_MOTORS_IO)
 
 #if defined(ENABLE_MOTORS)
+#pragma region Axis Actions
+
 /**
- * @brief Initialize the stepper drivers.
+ * @brief Position field of the joint.
  *
+ * @param value Joint position.
+ * @param index Axis index.
+ * @return int16_t& Position. [steps]
  */
-void init_drivers()
-{
-#if defined(SHOW_FUNC_NAMES)
-  DEBUGLOG("\r\n");
-  DEBUGLOG(__PRETTY_FUNCTION__);
-  DEBUGLOG("\r\n");
-#endif // SHOW_FUNC_NAMES
-
-#if defined(ENABLE_FEATURES_FLAGS)
-// If the flag is false.
-if (!EnableMotors_g)
+inline int16_t &joint_position(JointPosition_t &value, uint8_t index)
 {
-  // Print cancel execution message.
-  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
-  // Exit from the function.
-  return;
-}
-#endif // defined(ENABLE_FEATURES_FLAGS)
-
-#if defined(ENABLE_STATUS_LCD)
-  sprintf(LCDFirstLine_g, __FUNCTION__);
-  draw_lcd();
-#endif // defined(ENABLE_STATUS_LCD)
-
-  // Toggle the safety because there is noe E-Stop at this time.
-  SafetyStopFlag_g = LOW;
-
-  // Store position flag initialization.
-  StorePosition_g = false;
-
-  // Init the motors state.
-  MotorState_g = 0;
-
-  // Init the steppers operation mode.
-  OperationMode_g = OperationModes::NONE;
-
-  stepper1 = AccelStepper(AccelStepper::DRIVER, PIN_STP_1, PIN_DIR_1);
-  stepper2 = AccelStepper(AccelStepper::DRIVER, PIN_STP_2, PIN_DIR_2);
-  stepper3 = AccelStepper(AccelStepper::DRIVER, PIN_STP_3, PIN_DIR_3);
-  stepper4 = AccelStepper(AccelStepper::DRIVER, PIN_STP_4, PIN_DIR_4);
-  stepper5 = AccelStepper(AccelStepper::DRIVER, PIN_STP_5, PIN_DIR_5);
-  stepper6 = AccelStepper(AccelStepper::DRIVER, PIN_STP_6, PIN_DIR_6);
-
-  stepper1.setAcceleration(M1_ACCEL);
-  stepper2.setAcceleration(M2_ACCEL);
-  stepper3.setAcceleration(M3_ACCEL);
-  stepper4.setAcceleration(M4_ACCEL);
-  stepper5.setAcceleration(M5_ACCEL);
-  stepper6.setAcceleration(M6_ACCEL);
-
-  stepper1.setMaxSpeed(M1_MAX_SPEED);
-  stepper2.setMaxSpeed(M2_MAX_SPEED);
-  stepper3.setMaxSpeed(M3_MAX_SPEED);
-  stepper4.setMaxSpeed(M4_MAX_SPEED);
-  stepper5.setMaxSpeed(M5_MAX_SPEED);
-  stepper6.setMaxSpeed(M6_MAX_SPEED);
-
-  // Set directions.
-  stepper3.setPinsInverted(true, false, false);
-  stepper5.setPinsInverted(true, false, false);
-  stepper6.setPinsInverted(true, false, false);
-
-#if defined(ENABLE_SHMR)
-  steppers.addStepper(stepper3); // q1
-  steppers.addStepper(stepper1); // q2
-  steppers.addStepper(stepper2); // q3
-  steppers.addStepper(stepper6);
-#endif
+  switch (index)
+  {
+  case 0:
+    return value.BasePos;
+  case 1:
+    return value.ShoulderPos;
+  case 2:
+    return value.ElbowPos;
+  case 3:
+    return value.LeftDiffPos;
+  case 4:
+    return value.RightDiffPos;
+  default:
+    return value.GripperPos;
+  }
 }
 
 /**
- * @brief Unable disable drivers.
+ * @brief Speed field of the joint.
  *
+ * @param value Joint position.
+ * @param index Axis index.
+ * @return int16_t& Speed. [steps/s]
  */
-void enable_drivers(bool state)
+inline int16_t &joint_speed(JointPosition_t &value, uint8_t index)
 {
-#if defined(SHOW_FUNC_NAMES)
-  DEBUGLOG("\r\n");
+  switch (index)
+  {
+  case 0:
+    return value.BaseSpeed;
+  case 1:
+    return value.ShoulderSpeed;
+  case 2:
+    return value.ElbowSpeed;
+  case 3:
+    return value.LeftDiffSpeed;
+  case 4:
+    return value.RightDiffSpeed;
+  default:
+    return value.GripperSpeed;
+  }
+}
+
+/**
+ * @brief Motor position of the axis for the joint positions.
+ *
+ * With the wrist transform the LeftDiff fields carry the wrist pitch
+ * and the RightDiff fields the roll, here they are mixed to the motors.
+ *
+ * @param value Joint position.
+ * @param index Axis index.
+ * @return long Motor position. [steps]
+ */
+inline long motor_position(JointPosition_t &value, uint8_t index)
+{
+#if defined(ENABLE_WRIST_TRANSFORM)
+  if (index == Axis4_t::INDEX)
+  {
+    return wrist_left((long)value.LeftDiffPos, (long)value.RightDiffPos);
+  }
+  if (index == Axis5_t::INDEX)
+  {
+    return wrist_right((long)value.LeftDiffPos, (long)value.RightDiffPos);
+  }
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+  return joint_position(value, index);
+}
+
+/**
+ * @brief Motor speed of the axis for the joint speeds.
+ *
+ * @param value Joint position.
+ * @param index Axis index.
+ * @return long Motor speed. [steps/s]
+ */
+inline long motor_speed(JointPosition_t &value, uint8_t index)
+{
+#if defined(ENABLE_WRIST_TRANSFORM)
+  if (index == Axis4_t::INDEX)
+  {
+    return wrist_left((long)value.LeftDiffSpeed, (long)value.RightDiffSpeed);
+  }
+  if (index == Axis5_t::INDEX)
+  {
+    return wrist_right((long)value.LeftDiffSpeed, (long)value.RightDiffSpeed);
+  }
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+  return joint_speed(value, index);
+}
+
+/**
+ * @brief Joint position of the axis from the motor positions.
+ *
+ * @param index Axis index.
+ * @return long Joint position, pitch and roll for the wrist. [steps]
+ */
+inline long axis_position(uint8_t index)
+{
+#if defined(ENABLE_WRIST_TRANSFORM)
+  long LeftL = Steppers_g[Axis4_t::INDEX].currentPosition();
+  long RightL = Steppers_g[Axis5_t::INDEX].currentPosition();
+  if (index == Axis4_t::INDEX)
+  {
+    return wrist_pitch(LeftL, RightL);
+  }
+  if (index == Axis5_t::INDEX)
+  {
+    return wrist_roll(LeftL, RightL);
+  }
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+  return Steppers_g[index].currentPosition();
+}
+
+/**
+ * @brief Joint speed of the axis from the motor speeds.
+ *
+ * @param index Axis index.
+ * @return float Joint speed, pitch and roll for the wrist. [steps/s]
+ */
+inline float axis_speed(uint8_t index)
+{
+#if defined(ENABLE_WRIST_TRANSFORM)
+  float LeftL = Steppers_g[Axis4_t::INDEX].speed();
+  float RightL = Steppers_g[Axis5_t::INDEX].speed();
+  if (index == Axis4_t::INDEX)
+  {
+    return (LeftL - RightL) / 2.0F;
+  }
+  if (index == Axis5_t::INDEX)
+  {
+    return (LeftL + RightL) / 2.0F;
+  }
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+  return Steppers_g[index].speed();
+}
+
+/**
+ * @brief Create and configure the stepper driver of the axis.
+ *
+ */
+struct InitAxisAction
+{
+  template <typename A>
+  inline void apply()
+  {
+#if defined(ENABLE_STEP_TIMER)
+    // In place, the interrupt reads the ramp through a pointer into the stepper.
+    Steppers_g[A::INDEX].init(Stepper_t::DRIVER, A::PIN_STEP, A::PIN_DIR);
+    Steppers_g[A::INDEX].setRamp(&Ramps_g[A::INDEX]);
+#else
+    Steppers_g[A::INDEX] = Stepper_t(Stepper_t::DRIVER, A::PIN_STEP, A::PIN_DIR);
+#endif // defined(ENABLE_STEP_TIMER)
+    Steppers_g[A::INDEX].setAcceleration(A::ACCEL);
+    Steppers_g[A::INDEX].setMaxSpeed(A::MAX_SPEED);
+#if defined(ENABLE_SCURVE)
+    if (SCurveAxises_g & A::BIT)
+    {
+      Steppers_g[A::INDEX].setSCurve(&SCurves_g[A::INDEX], A::JERK);
+    }
+#endif // defined(ENABLE_SCURVE)
+    Steppers_g[A::INDEX].setPinsInverted(A::DIR_INVERTED, false, false);
+  }
+};
+
+#if defined(ENABLE_SCURVE)
+/**
+ * @brief Select the ramp of the axis.
+ *
+ */
+struct ProfileAxisAction
+{
+  uint8_t Mask;
+
+  template <typename A>
+  inline void apply()
+  {
+    if (Mask & A::BIT)
+    {
+      Steppers_g[A::INDEX].setSCurve(&SCurves_g[A::INDEX], A::JERK);
+    }
+    else
+    {
+      Steppers_g[A::INDEX].setSCurve(NULL, 0);
+    }
+  }
+};
+#endif // defined(ENABLE_SCURVE)
+
+/**
+ * @brief Enable or disable the outputs of the axis.
+ *
+ */
+struct EnableAxisAction
+{
+  bool State;
+
+  template <typename A>
+  inline void apply()
+  {
+    if (State)
+    {
+      Steppers_g[A::INDEX].enableOutputs();
+    }
+    else
+    {
+      Steppers_g[A::INDEX].disableOutputs();
+      // The drivers are off, the axis stops at once without a ramp.
+      set_axis_speed(A::INDEX, 0);
+      Steppers_g[A::INDEX].setSpeed(0);
+      Steppers_g[A::INDEX].setCurrentPosition(Steppers_g[A::INDEX].currentPosition());
+    }
+  }
+};
+
+/**
+ * @brief Run the axis to its target position.
+ *
+ */
+struct RunAxisAction
+{
+  uint8_t State;
+
+  template <typename A>
+  inline void apply()
+  {
+    if (Steppers_g[A::INDEX].run())
+    {
+      State |= A::BIT;
+    }
+  }
+};
+
+/**
+ * @brief Run the axis with its constant speed.
+ *
+ */
+struct RunSpeedAxisAction
+{
+  uint8_t State;
+#if !defined(ENABLE_STEP_TIMER)
+  float Period;
+#endif // !defined(ENABLE_STEP_TIMER)
+
+  template <typename A>
+  inline void apply()
+  {
+#if !defined(ENABLE_STEP_TIMER)
+    // AccelStepper jumps to the new speed, ramp it here with the acceleration.
+    float SpeedL = Steppers_g[A::INDEX].speed();
+    float TargetL = SpeedTargets_g[A::INDEX];
+    if (SpeedL != TargetL)
+    {
+      float DeltaL = Steppers_g[A::INDEX].acceleration() * Period;
+      if (TargetL > SpeedL + DeltaL)
+      {
+        SpeedL += DeltaL;
+      }
+      else if (TargetL < SpeedL - DeltaL)
+      {
+        SpeedL -= DeltaL;
+      }
+      else
+      {
+        SpeedL = TargetL;
+      }
+      Steppers_g[A::INDEX].setSpeed(SpeedL);
+    }
+#endif // !defined(ENABLE_STEP_TIMER)
+    if (Steppers_g[A::INDEX].runSpeed())
+    {
+      State |= A::BIT;
+    }
+  }
+};
+
+/**
+ * @brief Stop the axis with its acceleration.
+ *
+ */
+struct StopAxisAction
+{
+  template <typename A>
+  inline void apply()
+  {
+    Steppers_g[A::INDEX].stop();
+  }
+};
+
+/**
+ * @brief Stop the axis at once on its position, without deceleration.
+ *
+ */
+struct HaltAxisAction
+{
+  template <typename A>
+  inline void apply()
+  {
+    Steppers_g[A::INDEX].setCurrentPosition(Steppers_g[A::INDEX].currentPosition());
+  }
+};
+
+/**
+ * @brief Clear the position of the axis.
+ *
+ */
+struct ClearAxisAction
+{
+  template <typename A>
+  inline void apply()
+  {
+    Steppers_g[A::INDEX].setCurrentPosition(0);
+    // The zero is not on the switch any more.
+    PositionValid_g &= ~(1U << A::INDEX);
+  }
+};
+
+/**
+ * @brief Move the axis relative to its position.
+ *
+ */
+struct MoveRelativeAxisAction
+{
+  JointPosition_t &Value;
+
+  template <typename A>
+  inline void apply()
+  {
+    Steppers_g[A::INDEX].setSpeed(motor_speed(Value, A::INDEX));
+    Steppers_g[A::INDEX].move(motor_position(Value, A::INDEX));
+  }
+};
+
+/**
+ * @brief Move the axis to absolute position.
+ *
+ */
+struct MoveAbsoluteAxisAction
+{
+  JointPosition_t &Value;
+
+  template <typename A>
+  inline void apply()
+  {
+    if (Steppers_g[A::INDEX].currentPosition() != motor_position(Value, A::INDEX))
+    {
+      Steppers_g[A::INDEX].setSpeed(motor_speed(Value, A::INDEX));
+      Steppers_g[A::INDEX].moveTo(motor_position(Value, A::INDEX));
+    }
+  }
+};
+
+/**
+ * @brief Set the constant speed of the axis.
+ *
+ */
+struct MoveSpeedAxisAction
+{
+  JointPosition_t &Value;
+
+  template <typename A>
+  inline void apply()
+  {
+    set_axis_speed(A::INDEX, motor_speed(Value, A::INDEX));
+  }
+};
+
+/**
+ * @brief Read the position and the speed of the axis.
+ *
+ */
+struct ReadAxisAction
+{
+  JointPosition_t &Value;
+
+  template <typename A>
+  inline void apply()
+  {
+    joint_position(Value, A::INDEX) = (int16_t)axis_position(A::INDEX);
+    joint_speed(Value, A::INDEX) = (int16_t)axis_speed(A::INDEX);
+  }
+};
+
+#if defined(ENABLE_TCM_COMMANDS)
+/**
+ * @brief Move the axis to the position from the @STEP arguments.
+ *
+ */
+struct StepAxisAction
+{
+  float Speed;
+  JointPosition_t &Value;
+
+  template <typename A>
+  inline void apply()
+  {
+    Steppers_g[A::INDEX].setSpeed(Speed);
+    Steppers_g[A::INDEX].moveTo(motor_position(Value, A::INDEX));
+  }
+};
+#endif // defined(ENABLE_TCM_COMMANDS)
+
+#if defined(ENABLE_STEP_TIMER)
+/**
+ * @brief Add the step pulse and the direction of the axis to the output.
+ *
+ */
+struct OutputAxisAction
+{
+  StepOutput &Output;
+#if defined(ENABLE_COORDINATED_MOTION)
+  bool Lead;
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_PVT_STREAM)
+  bool Stream;
+#endif // defined(ENABLE_PVT_STREAM)
+
+  template <typename A>
+  inline void IRAM_ATTR apply()
+  {
+    bool StepL = Steppers_g[A::INDEX].tick();
+#if defined(ENABLE_COORDINATED_MOTION)
+    if (Lead && Coordinated_g.follow(A::INDEX))
+    {
+      Steppers_g[A::INDEX].step();
+      StepL = true;
+    }
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_PVT_STREAM)
+    if (Stream)
+    {
+      PvtStream::Output OutputL = Pvt_g.follow(A::INDEX);
+      if (OutputL == PvtStream::TURN)
+      {
+        Steppers_g[A::INDEX].turn(Pvt_g.forward(A::INDEX));
+      }
+      else if (OutputL == PvtStream::STEP)
+      {
+        Steppers_g[A::INDEX].step();
+        StepL = true;
+      }
+    }
+#endif // defined(ENABLE_PVT_STREAM)
+#if defined(ENABLE_LIMIT_LATCH)
+    if (StepL)
+    {
+      OutputLags_g[A::INDEX] += (Steppers_g[A::INDEX].dirLevel() != A::DIR_INVERTED) ? 1 : -1;
+    }
+#endif // defined(ENABLE_LIMIT_LATCH)
+#if defined(ENABLE_JOINT_COUPLING)
+    // The motors step after all joints are added, in CouplingOutputAxisAction.
+    Coupling_g.add(A::INDEX, StepL, Steppers_g[A::INDEX].dirLevel() != A::DIR_INVERTED);
+#else
+    constexpr StepOutputMask STEP_MASK = step_output_pins(A::STEP_PIN_BIT);
+    constexpr StepOutputMask DIR_MASK = step_output_pins(A::DIR_PIN_BIT);
+#if defined(ENABLE_INPUT_SHAPER)
+    StepL = Shapers_g[A::INDEX].shape(StepL, Steppers_g[A::INDEX].dirLevel());
+    bool LevelL = Shapers_g[A::INDEX].dirLevel();
+#else
+    bool LevelL = Steppers_g[A::INDEX].dirLevel();
+#endif // defined(ENABLE_INPUT_SHAPER)
+    Output.add(StepL, LevelL, STEP_MASK, DIR_MASK);
+#if defined(ENABLE_LIMIT_LATCH)
+    if (StepL)
+    {
+      OutputLags_g[A::INDEX] -= (LevelL != A::DIR_INVERTED) ? 1 : -1;
+    }
+#endif // defined(ENABLE_LIMIT_LATCH)
+#endif // defined(ENABLE_JOINT_COUPLING)
+  }
+};
+
+#if defined(ENABLE_JOINT_COUPLING)
+/**
+ * @brief Add the step pulse and the direction of the motor with the coupled steps to the output.
+ *
+ */
+struct CouplingOutputAxisAction
+{
+  StepOutput &Output;
+
+  template <typename A>
+  inline void IRAM_ATTR apply()
+  {
+    constexpr StepOutputMask STEP_MASK = step_output_pins(A::STEP_PIN_BIT);
+    constexpr StepOutputMask DIR_MASK = step_output_pins(A::DIR_PIN_BIT);
+    bool StepL = (Coupling_g.follow(A::INDEX) == JointCoupling::STEP);
+    bool LevelL = (Coupling_g.forward(A::INDEX) != A::DIR_INVERTED);
+#if defined(ENABLE_INPUT_SHAPER)
+    // The shaper smooths the motor, the compensation included.
+    StepL = Shapers_g[A::INDEX].shape(StepL, LevelL);
+    LevelL = Shapers_g[A::INDEX].dirLevel();
+#endif // defined(ENABLE_INPUT_SHAPER)
+    Output.add(StepL, LevelL, STEP_MASK, DIR_MASK);
+#if defined(ENABLE_LIMIT_LATCH)
+    if (StepL)
+    {
+      OutputLags_g[A::INDEX] -= (LevelL != A::DIR_INVERTED) ? 1 : -1;
+    }
+#endif // defined(ENABLE_LIMIT_LATCH)
+  }
+};
+
+/**
+ * @brief Collect the axis with pending coupled steps.
+ *
+ */
+struct CouplingStateAxisAction
+{
+  uint8_t State;
+
+  template <typename A>
+  inline void apply()
+  {
+    if (Coupling_g.isRunning(A::INDEX))
+    {
+      State |= A::BIT;
+    }
+  }
+};
+#endif // defined(ENABLE_JOINT_COUPLING)
+#endif // defined(ENABLE_STEP_TIMER)
+
+#if defined(ENABLE_INPUT_SHAPER)
+/**
+ * @brief Collect the axis with pending shaped steps.
+ *
+ */
+struct ShaperStateAxisAction
+{
+  uint8_t State;
+
+  template <typename A>
+  inline void apply()
+  {
+    if (Shapers_g[A::INDEX].isRunning())
+    {
+      State |= A::BIT;
+    }
+  }
+};
+
+/**
+ * @brief Drop the pending shaped steps of the axis.
+ *
+ */
+struct ShaperResetAxisAction
+{
+  template <typename A>
+  inline void apply()
+  {
+    Shapers_g[A::INDEX].reset();
+  }
+};
+#endif // defined(ENABLE_INPUT_SHAPER)
+
+#if defined(ENABLE_MOTION_QUEUE)
+/**
+ * @brief Check that the axis took its queued target.
+ *
+ */
+struct LookAheadAxisAction
+{
+  bool Free;
+
+  template <typename A>
+  inline void apply()
+  {
+    Free = Free && !Steppers_g[A::INDEX].hasNext();
+  }
+};
+
+/**
+ * @brief Queue the target of the segment to the axis.
+ *
+ */
+struct QueueToAxisAction
+{
+  const MotionSegment_t &Segment;
+
+  template <typename A>
+  inline void apply()
+  {
+    // The interrupt takes the limits together with the target.
+    Steppers_g[A::INDEX].queueTo(Segment.Target[A::INDEX], Segment.MaxSpeed[A::INDEX], Segment.Acceleration[A::INDEX]);
+  }
+};
+
+/**
+ * @brief Fill the target of the axis in the segment.
+ *
+ */
+struct SegmentAxisAction
+{
+  MotionSegment_t &Segment;
+  JointPosition_t &Value;
+  bool Relative;
+
+  template <typename A>
+  inline void apply()
+  {
+    long TargetL = motor_position(Value, A::INDEX);
+    if (Relative)
+    {
+      // Relative to the end of the queue.
+      if (MotionQueue_g.count() > 0)
+      {
+        TargetL += MotionQueue_g.back().Target[A::INDEX];
+      }
+      else
+      {
+        TargetL += Steppers_g[A::INDEX].finalPosition();
+      }
+    }
+    Segment.Target[A::INDEX] = TargetL;
+    Segment.MaxSpeed[A::INDEX] = 0.0F;
+    Segment.Acceleration[A::INDEX] = 0.0F;
+  }
+};
+#endif // defined(ENABLE_MOTION_QUEUE)
+
+#if defined(ENABLE_COORDINATED_MOTION)
+/**
+ * @brief Hand the axis to the coordinated move.
+ *
+ */
+struct CoordinatedAxisAction
+{
+  JointPosition_t &Value;
+
+  template <typename A>
+  inline void apply()
+  {
+    long DistanceL = motor_position(Value, A::INDEX) - Steppers_g[A::INDEX].currentPosition();
+    float SpeedL = motor_speed(Value, A::INDEX);
+    if (SpeedL < 0.0F)
+    {
+      SpeedL = -SpeedL;
+    }
+    if ((SpeedL <= 0.0F) || (SpeedL > Steppers_g[A::INDEX].maxSpeed()))
+    {
+      SpeedL = Steppers_g[A::INDEX].maxSpeed();
+    }
+    Coordinated_g.setAxis(A::INDEX, DistanceL, SpeedL, Steppers_g[A::INDEX].acceleration());
+    if (DistanceL != 0)
+    {
+      Steppers_g[A::INDEX].follow(DistanceL > 0);
+    }
+  }
+};
+
+/**
+ * @brief Collect the state of the axis in the coordinated move.
+ *
+ */
+struct CoordinatedStateAxisAction
+{
+  uint8_t State;
+
+  template <typename A>
+  inline void apply()
+  {
+    if (Coordinated_g.moves(A::INDEX))
+    {
+      State |= A::BIT;
+    }
+  }
+};
+#endif // defined(ENABLE_COORDINATED_MOTION)
+
+#if defined(ENABLE_PVT_STREAM)
+/**
+ * @brief Hand the axis to the PVT stream.
+ *
+ */
+struct PvtAxisAction
+{
+  long *Positions;
+
+  template <typename A>
+  inline void apply()
+  {
+    Positions[A::INDEX] = Steppers_g[A::INDEX].currentPosition();
+    Pvt_g.setAcceleration(A::INDEX, Steppers_g[A::INDEX].acceleration());
+    Steppers_g[A::INDEX].follow(true);
+  }
+};
+#endif // defined(ENABLE_PVT_STREAM)
+
+#if defined(ENABLE_SHMR)
+/**
+ * @brief Find the common profile of the synchronized move, in the order of SHMRAxises_t.
+ *
+ * Every axis runs with its distance times the common speed and acceleration
+ * per step, so all of them take the same time. The common values are the
+ * largest ones in the limits of all axises.
+ */
+struct SHMRPlanAxisAction
+{
+  const long *Targets;
+  uint8_t Ordinal;
+  float SpeedPerStep;
+  float AccelPerStep;
+
+  template <typename A>
+  inline void apply()
+  {
+    long DistanceL = labs(Targets[Ordinal++] - Steppers_g[A::INDEX].currentPosition());
+    if (DistanceL == 0)
+    {
+      return;
+    }
+    float SpeedL = A::MAX_SPEED / (float)DistanceL;
+    float AccelL = A::ACCEL / (float)DistanceL;
+    if ((SpeedPerStep == 0.0F) || (SpeedL < SpeedPerStep))
+    {
+      SpeedPerStep = SpeedL;
+    }
+    if ((AccelPerStep == 0.0F) || (AccelL < AccelPerStep))
+    {
+      AccelPerStep = AccelL;
+    }
+  }
+};
+
+/**
+ * @brief Start the axis of the synchronized move, in the order of SHMRAxises_t.
+ *
+ */
+struct SHMRMoveAxisAction
+{
+  const long *Targets;
+  uint8_t Ordinal;
+  float SpeedPerStep;
+  float AccelPerStep;
+
+  template <typename A>
+  inline void apply()
+  {
+    long TargetL = Targets[Ordinal++];
+    long DistanceL = labs(TargetL - Steppers_g[A::INDEX].currentPosition());
+    if (DistanceL == 0)
+    {
+      return;
+    }
+    // A moving axis takes both limits together, then the new target.
+    set_axis_limits(Steppers_g[A::INDEX], SpeedPerStep * (float)DistanceL, AccelPerStep * (float)DistanceL);
+    Steppers_g[A::INDEX].moveTo(TargetL);
+  }
+};
+
+/**
+ * @brief Give the axis its own limits back after the synchronized move.
+ *
+ */
+struct SHMRLimitsAxisAction
+{
+  template <typename A>
+  inline void apply()
+  {
+    set_axis_limits(Steppers_g[A::INDEX], A::MAX_SPEED, A::ACCEL);
+  }
+};
+
+/**
+ * @brief Set the speed of the axis, in the order of SHMRAxises_t.
+ *
+ */
+struct SHMRSpeedAxisAction
+{
+  const float *Speeds;
+  uint8_t Ordinal;
+
+  template <typename A>
+  inline void apply()
+  {
+    Steppers_g[A::INDEX].setSpeed(Speeds[Ordinal++]);
+  }
+};
+#endif // defined(ENABLE_SHMR)
+
+#pragma endregion // Axis Actions
+#endif // defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_MOTORS)
+/**
+ * @brief Initialize the stepper drivers.
+ *
+ */
+void init_drivers()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableMotors_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+#if defined(ENABLE_STATUS_LCD)
+  sprintf(LCDFirstLine_g, __FUNCTION__);
+  draw_lcd();
+#endif // defined(ENABLE_STATUS_LCD)
+
+  // The positions are not known until the homing.
+  PositionValid_g = 0;
+
+  // Init the motors state.
+  MotorState_g = 0;
+
+  // Init the steppers operation mode.
+  OperationMode_g = OperationModes::NONE;
+
+  // Pins, directions, speeds and accelerations from the axises table.
+  InitAxisAction InitL;
+  Axises_t::each(InitL);
+
+#if defined(ENABLE_JOINT_COUPLING)
+  init_coupling();
+#endif // defined(ENABLE_JOINT_COUPLING)
+
+#if defined(ENABLE_POSITION_JOURNAL)
+  init_journal();
+#endif // defined(ENABLE_POSITION_JOURNAL)
+}
+
+/**
+ * @brief Unable disable drivers.
+ *
+ */
+void enable_drivers(bool state)
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableMotors_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+#if defined(ENABLE_STATUS_LCD)
+  sprintf(LCDFirstLine_g, __FUNCTION__);
+  draw_lcd();
+#endif // defined(ENABLE_STATUS_LCD)
+
+  if (state)
+  {
+#if defined(ENABLE_ESTOP)
+    // The E-Stop fault is reset first.
+    if (EStop_g.latched())
+    {
+      return;
+    }
+#endif // defined(ENABLE_ESTOP)
+
+#if defined(ENABLE_MOTORS_IO)
+    // Enable stepper drivers.
+    digitalWrite(PIN_ENABLE, LOW);
+#endif // #if defined(ENABLE_MOTORS_IO)
+#if defined(ENABLE_MOTORS)
+    EnableAxisAction EnableL = {true};
+    Axises_t::each(EnableL);
+#endif // defined(ENABLE_MOTORS)
+  }
+  else
+  {
+#if defined(ENABLE_MOTORS_IO)
+    // Disable stepper drivers.
+    digitalWrite(PIN_ENABLE, HIGH);
+#endif // #if defined(ENABLE_MOTORS_IO)
+
+#if defined(ENABLE_MOTORS)
+    EnableAxisAction EnableL = {false};
+    Axises_t::each(EnableL);
+#endif // defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_MOTION_QUEUE)
+    MotionQueue_g.clear();
+#endif // defined(ENABLE_MOTION_QUEUE)
+
+#if defined(ENABLE_COORDINATED_MOTION)
+    Coordinated_g.reset();
+#endif // defined(ENABLE_COORDINATED_MOTION)
+
+#if defined(ENABLE_PVT_STREAM)
+    Pvt_g.reset();
+#endif // defined(ENABLE_PVT_STREAM)
+
+#if defined(ENABLE_LINEAR_MOVE)
+    Linear_g.stop();
+#endif // defined(ENABLE_LINEAR_MOVE)
+
+#if defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+    Homing_g.stop();
+#endif // defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_SHMR)
+    stop_gripper();
+#endif // defined(ENABLE_SHMR)
+
+    // Without holding torque the axises can move.
+    PositionValid_g = 0;
+
+#if defined(ENABLE_INPUT_SHAPER)
+    ShaperResetAxisAction ShaperL;
+    Axises_t::each(ShaperL);
+#endif // defined(ENABLE_INPUT_SHAPER)
+
+#if defined(ENABLE_JOINT_COUPLING)
+    Coupling_g.reset();
+#endif // defined(ENABLE_JOINT_COUPLING)
+  }
+
+  MotorsEnabled_g = state;
+}
+
+#if defined(ENABLE_JOINT_COUPLING)
+/**
+ * @brief Set the couplings of the joints from the configuration.
+ *
+ */
+void init_coupling()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  const CouplingRatio RatiosL[] = COUPLING_RATIOS;
+  for (size_t index = 0; index < sizeof(RatiosL) / sizeof(RatiosL[0]); index++)
+  {
+    if (!Coupling_g.set(RatiosL[index].Axis, RatiosL[index].Joint, RatiosL[index].Ratio))
+    {
+      DEBUGLOG("Wrong coupling of axis %d with %d.\r\n", RatiosL[index].Axis, RatiosL[index].Joint);
+    }
+  }
+}
+#endif // defined(ENABLE_JOINT_COUPLING)
+
+#if defined(ENABLE_POSITION_JOURNAL)
+/**
+ * @brief Open the position journal and restore the positions of the axises.
+ *
+ */
+void init_journal()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ARDUINO_ARCH_ESP32)
+  if (esp_reset_reason() == ESP_RST_BROWNOUT)
+  {
+    DEBUGLOG("Brown-out reset.\r\n");
+  }
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+  if (!Journal_g.begin(JOURNAL_NAME))
+  {
+    DEBUGLOG("Position journal is empty.\r\n");
+    return;
+  }
+
+  long PositionsL[Axises_t::COUNT];
+  uint8_t ValidL = 0;
+  if (!Journal_g.restore(PositionsL, ValidL))
+  {
+    // The reset came in a motion, the last positions are not the real ones.
+    DEBUGLOG("Position journal %lu is from a motion.\r\n", (unsigned long)Journal_g.sequence());
+    return;
+  }
+
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    Steppers_g[index].setCurrentPosition(PositionsL[index]);
+  }
+  PositionValid_g = ValidL;
+
+  DEBUGLOG("Position journal %lu restored, valid: %02X\r\n", (unsigned long)Journal_g.sequence(), ValidL);
+}
+
+/**
+ * @brief Write the positions to the journal at rest.
+ *
+ * The flash write stalls the step timer interrupt, so the start of the
+ * motion is marked by journal_motion() before the axises move. The records
+ * at rest are written at most once per JOURNAL_INTERVAL_MS, meanwhile the
+ * journal keeps the motion marker and the positions are not restored.
+ */
+void update_journal()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  if (MotorState_g != 0)
+  {
+    // A start without the marker, it is written late rather than never.
+    journal_motion();
+    return;
+  }
+
+  if ((millis() - JournalTime_g) < JOURNAL_INTERVAL_MS)
+  {
+    return;
+  }
+
+  long PositionsL[Axises_t::COUNT];
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    PositionsL[index] = Steppers_g[index].currentPosition();
+  }
+
+  // The journal writes only the changes.
+  if (Journal_g.write(PositionsL, PositionValid_g, false))
+  {
+    JournalTime_g = millis();
+  }
+}
+#endif // defined(ENABLE_POSITION_JOURNAL)
+
+#if defined(ENABLE_MOTORS)
+/**
+ * @brief Mark the start of a motion in the journal, before the motion is released.
+ *
+ * Called from the command paths while the axises stand, so the flash write
+ * does not stall the steps. A motion already marked writes nothing.
+ */
+void journal_motion()
+{
+#if defined(ENABLE_POSITION_JOURNAL)
+  long PositionsL[Axises_t::COUNT];
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    PositionsL[index] = Steppers_g[index].currentPosition();
+  }
+
+  if (Journal_g.write(PositionsL, PositionValid_g, true))
+  {
+    JournalTime_g = millis();
+  }
+#endif // defined(ENABLE_POSITION_JOURNAL)
+}
+#endif // defined(ENABLE_MOTORS)
+
+/**
+ * @brief Update the stepper drivers.
+ *
+ */
+void update_drivers()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableMotors_g)
+{
+  // Print cancel execution message.
+  // DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+  if (OperationMode_g == OperationModes::Positioning)
+  {
+    RunAxisAction RunL = {0};
+    Axises_t::each(RunL);
+    MotorState_g = (MotorState_g & ~Axises_t::BITS) | RunL.State;
+  }
+  else if (OperationMode_g == OperationModes::Speed)
+  {
+#if defined(ENABLE_STEP_TIMER)
+    RunSpeedAxisAction RunL = {0};
+#else
+    // Time since the last ramp update.
+    unsigned long NowL = micros();
+    float PeriodL = (float)(NowL - SpeedRampTime_g) / 1000000.0F;
+    SpeedRampTime_g = NowL;
+    if (PeriodL > SPEED_RAMP_MAX_PERIOD)
+    {
+      PeriodL = SPEED_RAMP_MAX_PERIOD;
+    }
+    RunSpeedAxisAction RunL = {0, PeriodL};
+#endif // defined(ENABLE_STEP_TIMER)
+    Axises_t::each(RunL);
+    MotorState_g = (MotorState_g & ~Axises_t::BITS) | RunL.State;
+  }
+#if defined(ENABLE_COORDINATED_MOTION)
+  else if (OperationMode_g == OperationModes::Coordinated)
+  {
+    CoordinatedStateAxisAction StateL = {0};
+    if (Coordinated_g.run())
+    {
+      Axises_t::each(StateL);
+    }
+    MotorState_g = (MotorState_g & ~Axises_t::BITS) | StateL.State;
+  }
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_PVT_STREAM)
+  else if (OperationMode_g == OperationModes::Stream)
+  {
+    // The stream holds all axises until it ends.
+    uint8_t StateL = Pvt_g.isRunning() ? Axises_t::BITS : 0;
+    MotorState_g = (MotorState_g & ~Axises_t::BITS) | StateL;
+  }
+#endif // defined(ENABLE_PVT_STREAM)
+#if defined(ENABLE_SHMR)
+  else if (OperationMode_g == OperationModes::Synchronized)
+  {
+    RunAxisAction RunL = {0};
+    Axises_t::each(RunL);
+    MotorState_g = (MotorState_g & ~Axises_t::BITS) | RunL.State;
+    if ((RunL.State & SHMRAxises_t::BITS) == 0)
+    {
+      // Arrived, the axises hold on the targets with their own limits.
+      SHMRLimitsAxisAction LimitsL;
+      SHMRAxises_t::each(LimitsL);
+      OperationMode_g = OperationModes::Positioning;
+    }
+  }
+#endif // defined(ENABLE_SHMR)
+
+#if defined(ENABLE_INPUT_SHAPER)
+  // The output follows the planner with the delay of the shaper.
+  ShaperStateAxisAction ShaperL = {0};
+  Axises_t::each(ShaperL);
+  MotorState_g |= ShaperL.State;
+#endif // defined(ENABLE_INPUT_SHAPER)
+
+#if defined(ENABLE_JOINT_COUPLING)
+  // The motors follow the joints with the coupled steps.
+  CouplingStateAxisAction CouplingL = {0};
+  Axises_t::each(CouplingL);
+  MotorState_g |= CouplingL.State;
+#endif // defined(ENABLE_JOINT_COUPLING)
+}
+
+/**
+ * @brief Set the maximum speed and the acceleration of the axis.
+ *
+ * @param stepper Stepper driver of the axis.
+ * @param maxSpeed Maximum speed. [steps/s]
+ * @param acceleration Acceleration. [steps/s^2]
+ */
+void set_axis_limits(Stepper_t &stepper, float maxSpeed, float acceleration)
+{
+#if defined(ENABLE_STEP_TIMER)
+  // One locked swap, a moving axis takes both limits together.
+  stepper.setLimits(maxSpeed, acceleration);
+#else
+  // The ramp tables are built again only on a change.
+  if (stepper.maxSpeed() != maxSpeed)
+  {
+    stepper.setMaxSpeed(maxSpeed);
+  }
+  if (stepper.acceleration() != acceleration)
+  {
+    stepper.setAcceleration(acceleration);
+  }
+#endif // defined(ENABLE_STEP_TIMER)
+}
+
+/**
+ * @brief Command the speed of the axis, it ramps there with the axis acceleration.
+ *
+ * @param index Axis index.
+ * @param speed Speed. [steps/s]
+ */
+void set_axis_speed(uint8_t index, float speed)
+{
+  if (speed != 0.0F)
+  {
+    journal_motion();
+  }
+
+#if defined(ENABLE_WRIST_TRANSFORM)
+  if ((index == Axis4_t::INDEX) || (index == Axis5_t::INDEX))
+  {
+    // The speed mode runs the wrist motors with their own limits.
+    sync_wrist(0, 0);
+  }
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+
+#if defined(ENABLE_STEP_TIMER)
+  // The step engine ramps in the interrupt.
+  Steppers_g[index].setSpeed(speed);
+#else
+  float MaxSpeedL = Steppers_g[index].maxSpeed();
+  SpeedTargets_g[index] = constrain(speed, -MaxSpeedL, MaxSpeedL);
+#endif // defined(ENABLE_STEP_TIMER)
+}
+
+#if defined(ENABLE_WRIST_TRANSFORM)
+/**
+ * @brief Limits of the wrist motors, so both of them arrive together.
+ *
+ * The shorter move gets the speed and the acceleration of the longer one
+ * scaled with the ratio of the distances, so the two ramps take the same time.
+ * Without distances the motors take their own limits.
+ *
+ * @param left Distance of the left motor. [steps]
+ * @param right Distance of the right motor. [steps]
+ * @param maxSpeeds Maximum speeds of the left and the right motor. [steps/s]
+ * @param accels Accelerations of the left and the right motor. [steps/s^2]
+ */
+void wrist_limits(long left, long right, float *maxSpeeds, float *accels)
+{
+  static const float MaxSpeedsL[2] = {Axis4_t::MAX_SPEED, Axis5_t::MAX_SPEED};
+  static const float AccelsL[2] = {Axis4_t::ACCEL, Axis5_t::ACCEL};
+  long DistancesL[2] = {labs(left), labs(right)};
+  long LongestL = (DistancesL[0] > DistancesL[1]) ? DistancesL[0] : DistancesL[1];
+
+  for (uint8_t index = 0; index < 2; index++)
+  {
+    maxSpeeds[index] = MaxSpeedsL[index];
+    accels[index] = AccelsL[index];
+    if (LongestL != 0)
+    {
+      // Both motors start from the slower limits of the two.
+      float RatioL = (DistancesL[index] == 0) ? 1.0F : (float)DistancesL[index] / (float)LongestL;
+      maxSpeeds[index] = ((MaxSpeedsL[0] < MaxSpeedsL[1]) ? MaxSpeedsL[0] : MaxSpeedsL[1]) * RatioL;
+      accels[index] = ((AccelsL[0] < AccelsL[1]) ? AccelsL[0] : AccelsL[1]) * RatioL;
+    }
+  }
+}
+
+/**
+ * @brief Scale the limits of the wrist motors, so both of them arrive together.
+ *
+ * @param left Distance of the left motor. [steps]
+ * @param right Distance of the right motor. [steps]
+ */
+void sync_wrist(long left, long right)
+{
+  static const uint8_t IndexesL[2] = {Axis4_t::INDEX, Axis5_t::INDEX};
+  float MaxSpeedsL[2];
+  float AccelsL[2];
+  wrist_limits(left, right, MaxSpeedsL, AccelsL);
+
+  for (uint8_t index = 0; index < 2; index++)
+  {
+    set_axis_limits(Steppers_g[IndexesL[index]], MaxSpeedsL[index], AccelsL[index]);
+  }
+}
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+
+#if defined(ENABLE_DRIVERS_BENCHMARK)
+/**
+ * @brief Update the stepper drivers, hand written version for the benchmark.
+ *
+ */
+void update_drivers_legacy()
+{
+  static bool state = false;
+  if (OperationMode_g == OperationModes::Positioning)
+  {
+    state = stepper1.run();
+    bitWrite(MotorState_g, 0, state);
+    state = stepper2.run();
+    bitWrite(MotorState_g, 1, state);
+    state = stepper3.run();
+    bitWrite(MotorState_g, 2, state);
+    state = stepper4.run();
+    bitWrite(MotorState_g, 3, state);
+    state = stepper5.run();
+    bitWrite(MotorState_g, 4, state);
+    state = stepper6.run();
+    bitWrite(MotorState_g, 5, state);
+    // DEBUGLOG("%d, %d, %d, %d, %d, %d\r\n",
+    //   stepper1.currentPosition(),
+    //   stepper2.currentPosition(),
+    //   stepper3.currentPosition(),
+    //   stepper4.currentPosition(),
+    //   stepper5.currentPosition(),
+    //   stepper6.currentPosition());
+  }
+  else if (OperationMode_g == OperationModes::Speed)
+  {
+    state = stepper1.runSpeed();
+    bitWrite(MotorState_g, 0, state);
+    state = stepper2.runSpeed();
+    bitWrite(MotorState_g, 1, state);
+    state = stepper3.runSpeed();
+    bitWrite(MotorState_g, 2, state);
+    state = stepper4.runSpeed();
+    bitWrite(MotorState_g, 3, state);
+    state = stepper5.runSpeed();
+    bitWrite(MotorState_g, 4, state);
+    state = stepper6.runSpeed();
+    bitWrite(MotorState_g, 5, state);
+    // DEBUGLOG("MotorState_g: %d\r\n", MotorState_g);
+  }
+}
+
+/**
+ * @brief Measure the CPU cycles of update_drivers().
+ *
+ */
+void benchmark_drivers()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  uint8_t ModeL = OperationMode_g;
+  uint32_t BeginL = 0;
+  uint32_t TableCyclesL = 0;
+  uint32_t LegacyCyclesL = 0;
+  static const uint8_t ModesL[2] = {OperationModes::Positioning, OperationModes::Speed};
+
+  for (uint8_t mode = 0; mode < 2; mode++)
+  {
+    OperationMode_g = ModesL[mode];
+
+    BeginL = ESP.getCycleCount();
+    for (uint32_t index = 0; index < DRIVERS_BENCHMARK_COUNT; index++)
+    {
+      update_drivers();
+    }
+    TableCyclesL = ESP.getCycleCount() - BeginL;
+
+    BeginL = ESP.getCycleCount();
+    for (uint32_t index = 0; index < DRIVERS_BENCHMARK_COUNT; index++)
+    {
+      update_drivers_legacy();
+    }
+    LegacyCyclesL = ESP.getCycleCount() - BeginL;
+
+    DEBUGLOG("update_drivers() mode %d: table %d, legacy %d [cycles/call]\r\n",
+             ModesL[mode],
+             TableCyclesL / DRIVERS_BENCHMARK_COUNT,
+             LegacyCyclesL / DRIVERS_BENCHMARK_COUNT);
+  }
+
+  OperationMode_g = ModeL;
+}
+#endif // defined(ENABLE_DRIVERS_BENCHMARK)
+#endif // defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_MOTION_QUEUE)
+/**
+ * @brief Hand the queued segments to the stepper drivers.
+ *
+ */
+void update_motion_queue()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableMotors_g)
+{
+  // Print cancel execution message.
+  // DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+  if (MotionQueue_g.count() == 0)
+  {
+    return;
+  }
+
+#if defined(ENABLE_COORDINATED_MOTION)
+  // The axises follow the coordinated move.
+  if (Coordinated_g.isRunning())
+  {
+    return;
+  }
+#endif // defined(ENABLE_COORDINATED_MOTION)
+
+#if defined(ENABLE_PVT_STREAM)
+  // The axises follow the stream.
+  if (Pvt_g.isRunning())
+  {
+    return;
+  }
+#endif // defined(ENABLE_PVT_STREAM)
+
+  // Every axis holds one segment ahead, wait until all of them took it.
+  LookAheadAxisAction LookAheadL = {true};
+  Axises_t::each(LookAheadL);
+  if (!LookAheadL.Free)
+  {
+    return;
+  }
+
+  journal_motion();
+  QueueToAxisAction QueueL = {MotionQueue_g.front()};
+  Axises_t::each(QueueL);
+  MotionQueue_g.pop();
+
+  OperationMode_g = OperationModes::Positioning;
+}
+
+/**
+ * @brief Add segment to the motion queue.
+ *
+ * @param value Joint positions.
+ * @param relative The positions are relative to the end of the queue.
+ * @return true Queued.
+ * @return false The queue is full.
+ */
+bool enqueue_segment(JointPosition_t &value, bool relative)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  if (MotionQueue_g.available() == 0)
+  {
+    return false;
+  }
+
+  MotionSegment_t SegmentL;
+  SegmentAxisAction SegmentActionL = {SegmentL, value, relative};
+  Axises_t::each(SegmentActionL);
+
+#if defined(ENABLE_WRIST_TRANSFORM)
+  // The wrist limits go with the segment, they apply from its start.
+  bool EmptyL = (MotionQueue_g.count() == 0);
+  long LeftL = EmptyL ? stepper4.finalPosition() : MotionQueue_g.back().Target[Axis4_t::INDEX];
+  long RightL = EmptyL ? stepper5.finalPosition() : MotionQueue_g.back().Target[Axis5_t::INDEX];
+  float MaxSpeedsL[2];
+  float AccelsL[2];
+  wrist_limits(SegmentL.Target[Axis4_t::INDEX] - LeftL, SegmentL.Target[Axis5_t::INDEX] - RightL, MaxSpeedsL, AccelsL);
+  SegmentL.MaxSpeed[Axis4_t::INDEX] = MaxSpeedsL[0];
+  SegmentL.Acceleration[Axis4_t::INDEX] = AccelsL[0];
+  SegmentL.MaxSpeed[Axis5_t::INDEX] = MaxSpeedsL[1];
+  SegmentL.Acceleration[Axis5_t::INDEX] = AccelsL[1];
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+
+  return MotionQueue_g.push(SegmentL);
+}
+#endif // defined(ENABLE_MOTION_QUEUE)
+
+#if defined(ENABLE_COORDINATED_MOTION)
+/**
+ * @brief Start coordinated move of all axises.
+ *
+ * @param value Joint positions, the speeds limit the axises.
+ * @return true The move is started.
+ * @return false Nothing to move.
+ */
+bool move_coordinated(JointPosition_t &value)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_WRIST_TRANSFORM)
+  // The coordinated move times the axises, the wrist motors take their own limits.
+  sync_wrist(0, 0);
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+
+  CoordinatedAxisAction CoordinatedL = {value};
+  Axises_t::each(CoordinatedL);
+
+  OperationMode_g = OperationModes::Coordinated;
+
+  journal_motion();
+  return Coordinated_g.start();
+}
+#endif // defined(ENABLE_COORDINATED_MOTION)
+
+#if defined(ENABLE_PVT_STREAM)
+/**
+ * @brief Prepare the next PVT segment for the step timer.
+ *
+ */
+void update_pvt_stream()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableMotors_g)
+{
+  // Print cancel execution message.
+  // DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+  Pvt_g.update();
+}
+
+/**
+ * @brief Start the PVT stream from the current positions.
+ *
+ */
+void begin_pvt_stream()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  long PositionsL[PVT_AXISES] = {0};
+  PvtAxisAction PvtL = {PositionsL};
+  Axises_t::each(PvtL);
+  journal_motion();
+  Pvt_g.begin(PositionsL, StepTimer::frequency());
+
+  OperationMode_g = OperationModes::Stream;
+}
+
+/**
+ * @brief Fill the status of the PVT stream.
+ *
+ * @param payload Response buffer, 7 bytes.
+ * @return uint8_t Length of the status.
+ */
+uint8_t pvt_stream_status(uint8_t *payload)
+{
+  uint32_t BufferedL = Pvt_g.buffered();
+  if (BufferedL > 0xFFFF)
+  {
+    BufferedL = 0xFFFF;
+  }
+  uint16_t UnderrunsL = Pvt_g.underruns();
+
+  payload[0] = (uint8_t)Pvt_g.state();
+  payload[1] = Pvt_g.count();
+  payload[2] = Pvt_g.available();
+  payload[3] = (uint8_t)(BufferedL);
+  payload[4] = (uint8_t)(BufferedL >> 8);
+  payload[5] = (uint8_t)(UnderrunsL);
+  payload[6] = (uint8_t)(UnderrunsL >> 8);
+
+  return 7;
+}
+#endif // defined(ENABLE_PVT_STREAM)
+
+#if defined(ENABLE_KINEMATICS)
+/**
+ * @brief Initialize the kinematics with the calibration.
+ *
+ */
+void init_kinematics()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  Kinematics_g.setLinks(KIN_BASE_HEIGHT, KIN_UPPER_ARM, KIN_FOREARM, KIN_TOOL);
+  Kinematics_g.setJoint(0, KIN_BASE_STEPS, KIN_BASE_ZERO);
+  Kinematics_g.setJoint(1, KIN_SHOULDER_STEPS, KIN_SHOULDER_ZERO);
+  Kinematics_g.setJoint(2, KIN_ELBOW_STEPS, KIN_ELBOW_ZERO);
+  Kinematics_g.setJoint(3, KIN_PITCH_STEPS, KIN_PITCH_ZERO);
+  Kinematics_g.setJoint(4, KIN_ROLL_STEPS, KIN_ROLL_ZERO);
+}
+
+/**
+ * @brief Joint positions of the arm, the wrist as the pitch and the roll.
+ *
+ * @param steps Joint positions. [steps]
+ */
+void joint_steps(long *steps)
+{
+  // The wrist joints are the pitch and the roll of the differential.
+  steps[0] = stepper1.currentPosition();
+  steps[1] = stepper2.currentPosition();
+  steps[2] = stepper3.currentPosition();
+  steps[3] = wrist_pitch(stepper4.currentPosition(), stepper5.currentPosition());
+  steps[4] = wrist_roll(stepper4.currentPosition(), stepper5.currentPosition());
+}
+
+/**
+ * @brief Pose of the tool on the current positions.
+ *
+ * @return const KinematicsPose& Tool pose.
+ */
+const KinematicsPose &read_pose()
+{
+  long StepsL[KINEMATICS_JOINTS];
+  joint_steps(StepsL);
+
+  return Kinematics_g.pose(StepsL);
+}
+
+/**
+ * @brief Fill the pose of the tool.
+ *
+ * @param payload Response buffer, 20 bytes.
+ * @return uint8_t Length of the pose.
+ */
+uint8_t pose_payload(uint8_t *payload)
+{
+  const KinematicsPose &PoseL = read_pose();
+
+  // X, Y, Z [0.01 mm], pitch and roll [0.01 deg].
+  const float ValuesL[5] = {PoseL.X, PoseL.Y, PoseL.Z, PoseL.Pitch, PoseL.Roll};
+  for (uint8_t index = 0; index < 5; index++)
+  {
+    int32_t ValueL = (int32_t)lroundf(ValuesL[index] * 100.0F);
+    payload[index * 4 + 0] = (uint8_t)(ValueL);
+    payload[index * 4 + 1] = (uint8_t)(ValueL >> 8);
+    payload[index * 4 + 2] = (uint8_t)(ValueL >> 16);
+    payload[index * 4 + 3] = (uint8_t)(ValueL >> 24);
+  }
+
+  return 20;
+}
+#endif // defined(ENABLE_KINEMATICS)
+
+#if defined(ENABLE_LINEAR_MOVE)
+/**
+ * @brief Motor positions of a pose.
+ *
+ * @param pose Tool pose.
+ * @param angles Joint angles near the solution in, the solution out. [deg]
+ * @param motors Motor positions of all axises. [steps]
+ * @return true Solved.
+ * @return false The pose is out of reach.
+ */
+bool pose_motors(const KinematicsPose &pose, float *angles, long *motors)
+{
+  if (!Kinematics_g.inverse(pose, angles))
+  {
+    return false;
+  }
+
+  long StepsL[KINEMATICS_JOINTS];
+  Kinematics_g.steps(angles, StepsL);
+  motors[Axis1_t::INDEX] = StepsL[0];
+  motors[Axis2_t::INDEX] = StepsL[1];
+  motors[Axis3_t::INDEX] = StepsL[2];
+  motors[Axis4_t::INDEX] = wrist_left(StepsL[3], StepsL[4]);
+  motors[Axis5_t::INDEX] = wrist_right(StepsL[3], StepsL[4]);
+  motors[Axis6_t::INDEX] = stepper6.currentPosition();
+
+  return true;
+}
+
+/**
+ * @brief Start a straight line move of the tool.
+ *
+ * The move is slowed down when a joint would run over its maximum speed.
+ *
+ * @param target Target pose.
+ * @param speed Tool point speed. [mm/s]
+ * @return true The move is started.
+ * @return false Nothing to move or a pose of the line is out of reach.
+ */
+bool move_linear(const KinematicsPose &target, float speed)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  long StepsL[KINEMATICS_JOINTS];
+  joint_steps(StepsL);
+  float StartL[KINEMATICS_JOINTS];
+  Kinematics_g.angles(StepsL, StartL);
+  const KinematicsPose FromL = read_pose();
+
+  float SpeedL = speed;
+  float AccelL = LINEAR_ACCEL;
+  float AngularSpeedL = LINEAR_ANGULAR_SPEED;
+  for (uint8_t pass = 0; pass < LINEAR_PLAN_PASSES; pass++)
+  {
+    if (!Linear_g.begin(FromL, target, SpeedL, AccelL, AngularSpeedL, LINEAR_PERIOD_MS / 1000.0F))
+    {
+      return false;
+    }
+
+    // Solve the whole line before the start, find the fastest joint.
+    float AnglesL[KINEMATICS_JOINTS];
+    long LastL[Axises_t::COUNT];
+    long MotorsL[Axises_t::COUNT];
+    memcpy(AnglesL, StartL, sizeof(AnglesL));
+    for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+    {
+      LastL[index] = Steppers_g[index].currentPosition();
+    }
+    float RatioL = 0.0F;
+    for (uint16_t point = 1; point <= Linear_g.points(); point++)
+    {
+      KinematicsPose PoseL;
+      Linear_g.sample(Linear_g.time(point), PoseL);
+      if (!pose_motors(PoseL, AnglesL, MotorsL))
+      {
+        Linear_g.stop();
+        return false;
+      }
+      float PeriodL = Linear_g.time(point) - Linear_g.time(point - 1);
+      for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+      {
+        float JointSpeedL = (float)labs(MotorsL[index] - LastL[index]) / PeriodL;
+        RatioL = fmaxf(RatioL, JointSpeedL / Steppers_g[index].maxSpeed());
+        LastL[index] = MotorsL[index];
+      }
+    }
+
+    if (RatioL <= 1.0F)
+    {
+      memcpy(LinearAngles_g, StartL, sizeof(LinearAngles_g));
+      begin_pvt_stream();
+      return true;
+    }
+
+    // Slow the whole line down, the path stays the same.
+    RatioL *= LINEAR_SPEED_MARGIN;
+    SpeedL /= RatioL;
+    AngularSpeedL /= RatioL;
+    AccelL /= RatioL * RatioL;
+  }
+
+  Linear_g.stop();
+  return false;
+}
+
+/**
+ * @brief Feed the points of the straight line move to the PVT stream.
+ *
+ */
+void update_linear_move()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  if (!Linear_g.isRunning())
+  {
+    return;
+  }
+
+  // The stream is dropped, so is the line.
+  if (!Pvt_g.isRunning())
+  {
+    Linear_g.stop();
+    return;
+  }
+
+  while (Linear_g.isRunning() && (Pvt_g.available() > 0))
+  {
+    uint16_t PointL = Linear_g.next();
+    float TimeL = Linear_g.time(PointL);
+    KinematicsPose PoseL;
+    long MotorsL[Axises_t::COUNT];
+    Linear_g.sample(TimeL, PoseL);
+    if (!pose_motors(PoseL, LinearAngles_g, MotorsL))
+    {
+      // Solved before the start, it does not happen.
+      Linear_g.stop();
+      Pvt_g.stop();
+      return;
+    }
+
+    PvtPoint ValueL;
+    for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+    {
+      ValueL.Position[index] = MotorsL[index];
+      ValueL.Velocity[index] = 0;
+    }
+
+    // Joint speeds of the middle points from the poses around them.
+    if (PointL < Linear_g.points())
+    {
+      const float DeltaL = LINEAR_VELOCITY_DELTA_MS / 1000.0F;
+      float AnglesL[KINEMATICS_JOINTS];
+      long BeforeL[Axises_t::COUNT];
+      long AfterL[Axises_t::COUNT];
+      memcpy(AnglesL, LinearAngles_g, sizeof(AnglesL));
+      Linear_g.sample(TimeL - DeltaL, PoseL);
+      bool SolvedL = pose_motors(PoseL, AnglesL, BeforeL);
+      memcpy(AnglesL, LinearAngles_g, sizeof(AnglesL));
+      Linear_g.sample(TimeL + DeltaL, PoseL);
+      SolvedL = SolvedL && pose_motors(PoseL, AnglesL, AfterL);
+      for (uint8_t index = 0; SolvedL && (index < Axises_t::COUNT); index++)
+      {
+        ValueL.Velocity[index] = lroundf((float)(AfterL[index] - BeforeL[index]) / (2.0F * DeltaL));
+      }
+    }
+
+    uint32_t DurationL = lroundf((TimeL - Linear_g.time(PointL - 1)) * 1000.0F);
+    ValueL.Duration = (DurationL > 0) ? DurationL : 1;
+    Pvt_g.push(ValueL);
+    Linear_g.advance();
+  }
+}
+#endif // defined(ENABLE_LINEAR_MOVE)
+
+#if defined(ENABLE_STEP_TIMER)
+/**
+ * @brief Initialize the step timer.
+ *
+ */
+void init_step_timer()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
   DEBUGLOG(__PRETTY_FUNCTION__);
   DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
@@ -1262,117 +3824,102 @@ if (!EnableMotors_g)
 }
 #endif // defined(ENABLE_FEATURES_FLAGS)
 
-#if defined(ENABLE_STATUS_LCD)
-  sprintf(LCDFirstLine_g, __FUNCTION__);
-  draw_lcd();
-#endif // defined(ENABLE_STATUS_LCD)
+  // From here on the pulses are timed by the interrupt,
+  // update_drivers() only hands the speeds to the step engine.
+  StepTimer::begin(STEP_TIMER_ID, STEP_TIMER_PERIOD_US, &isr_step_timer);
+}
 
-  if (state)
-  {
-#if defined(ENABLE_MOTORS_IO)
-    // Enable stepper drivers.
-    digitalWrite(PIN_ENABLE, LOW);
-#endif // #if defined(ENABLE_MOTORS_IO)
-#if defined(ENABLE_MOTORS)
-    stepper1.enableOutputs();
-    stepper2.enableOutputs();
-    stepper3.enableOutputs();
-    stepper4.enableOutputs();
-    stepper5.enableOutputs();
-    stepper6.enableOutputs();
-#endif // defined(ENABLE_MOTORS)
-  }
-  else
-  {
-#if defined(ENABLE_MOTORS_IO)
-    // Disable stepper drivers.
-    digitalWrite(PIN_ENABLE, HIGH);
-#endif // #if defined(ENABLE_MOTORS_IO)
+/**
+ * @brief Step timer interrupt, generates the step pulses of all axises.
+ *
+ */
+void IRAM_ATTR isr_step_timer()
+{
+  // End the pulses of the previous period.
+  constexpr StepOutputMask STEP_MASK_ALL = step_output_pins(Axises_t::STEP_PINS);
+  StepOutput::clear(STEP_MASK_ALL);
 
-#if defined(ENABLE_MOTORS)
-    stepper1.disableOutputs();
-    stepper2.disableOutputs();
-    stepper3.disableOutputs();
-    stepper4.disableOutputs();
-    stepper5.disableOutputs();
-    stepper6.disableOutputs();
-
-    stepper1.setSpeed(0);
-    stepper2.setSpeed(0);
-    stepper3.setSpeed(0);
-    stepper4.setSpeed(0);
-    stepper5.setSpeed(0);
-    stepper6.setSpeed(0);
-#endif // defined(ENABLE_MOTORS)
+#if defined(ENABLE_ESTOP)
+  // No step while the E-Stop fault is latched.
+  if (EStop_g.latched())
+  {
+    return;
   }
+#endif // defined(ENABLE_ESTOP)
 
-  MotorsEnabled_g = state;
+  StepOutput OutputL;
+  OutputAxisAction ActionL = {OutputL};
+#if defined(ENABLE_COORDINATED_MOTION)
+  ActionL.Lead = Coordinated_g.tick();
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_PVT_STREAM)
+  ActionL.Stream = Pvt_g.tick();
+#endif // defined(ENABLE_PVT_STREAM)
+  Axises_t::each(ActionL);
+#if defined(ENABLE_JOINT_COUPLING)
+  // All joints are added, the motors take their compensation in the same period.
+  CouplingOutputAxisAction CouplingL = {OutputL};
+  Axises_t::each(CouplingL);
+#endif // defined(ENABLE_JOINT_COUPLING)
+  OutputL.write();
 }
+#endif // defined(ENABLE_STEP_TIMER)
 
+#if defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
 /**
- * @brief Update the stepper drivers.
+ * @brief Start the scan of the inputs, after the inputs are set.
  *
  */
-void update_drivers()
+void init_inputs()
 {
-#if defined(SHOW_FUNC_NAMES_S)
+#if defined(SHOW_FUNC_NAMES)
   DEBUGLOG("\r\n");
   DEBUGLOG(__PRETTY_FUNCTION__);
   DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-#if defined(ENABLE_FEATURES_FLAGS)
-// If the flag is false.
-if (!EnableMotors_g)
-{
-  // Print cancel execution message.
-  // DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
-  // Exit from the function.
-  return;
+  Inputs_g.begin();
+  InputsState_g = Inputs_g.state();
+
+  InputsScanTimer_g = new FxTimer();
+  InputsScanTimer_g->setExpirationTime(INPUTS_SCAN_TIME_MS);
+  InputsScanTimer_g->updateLastTime();
 }
-#endif // defined(ENABLE_FEATURES_FLAGS)
 
-  static bool state = false;
-  if (OperationMode_g == OperationModes::Positioning)
+/**
+ * @brief Scan the inputs at their fixed rate.
+ *
+ * All inputs are read in one pass and debounced together,
+ * InputsState_g takes the new state in one write.
+ */
+void update_inputs()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  InputsScanTimer_g->update();
+  if (!InputsScanTimer_g->expired())
   {
-    state = stepper1.run();
-    bitWrite(MotorState_g, 0, state);
-    state = stepper2.run();
-    bitWrite(MotorState_g, 1, state);
-    state = stepper3.run();
-    bitWrite(MotorState_g, 2, state);
-    state = stepper4.run();
-    bitWrite(MotorState_g, 3, state);
-    state = stepper5.run();
-    bitWrite(MotorState_g, 4, state);
-    state = stepper6.run();
-    bitWrite(MotorState_g, 5, state);
-    // DEBUGLOG("%d, %d, %d, %d, %d, %d\r\n",
-    //   stepper1.currentPosition(),
-    //   stepper2.currentPosition(),
-    //   stepper3.currentPosition(),
-    //   stepper4.currentPosition(),
-    //   stepper5.currentPosition(),
-    //   stepper6.currentPosition());
+    return;
   }
-  else if (OperationMode_g == OperationModes::Speed)
+  InputsScanTimer_g->updateLastTime();
+  InputsScanTimer_g->clear();
+
+  uint8_t ChangedL = Inputs_g.scan();
+  InputsState_g = Inputs_g.state();
+
+#if defined(ENABLE_ESTOP)
+  // The E-Stop is normally closed, its input is active while released.
+  if (bitRead(ChangedL, ESTOP_INPUT))
   {
-    state = stepper1.runSpeed();
-    bitWrite(MotorState_g, 0, state);
-    state = stepper2.runSpeed();
-    bitWrite(MotorState_g, 1, state);
-    state = stepper3.runSpeed();
-    bitWrite(MotorState_g, 2, state);
-    state = stepper4.runSpeed();
-    bitWrite(MotorState_g, 3, state);
-    state = stepper5.runSpeed();
-    bitWrite(MotorState_g, 4, state);
-    state = stepper6.runSpeed();
-    bitWrite(MotorState_g, 5, state);
-    // DEBUGLOG("MotorState_g: %d\r\n", MotorState_g);
+    DEBUGLOG(bitRead(InputsState_g, ESTOP_INPUT) ? "E-STOP Released!\r\n" : "E-STOP Pressed!\r\n");
   }
+#endif // defined(ENABLE_ESTOP)
 }
-#endif // defined(ENABLE_MOTORS)
+#endif // defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
 
 #if defined(ENABLE_LIMITS)
 /**
@@ -1412,55 +3959,68 @@ if (!EnableLimits_g)
   //
   pinMode(M6_LIMIT, INPUT_PULLUP);
 
-  M1LimitSwitch_g.begin(M1_LIMIT);
-  M1LimitSwitch_g.setDebounceTime(DEBOUNCE_TIME_MS);
-  M2LimitSwitch_g.begin(M2_LIMIT);
-  M2LimitSwitch_g.setDebounceTime(DEBOUNCE_TIME_MS);
-  M3LimitSwitch_g.begin(M3_LIMIT);
-  M3LimitSwitch_g.setDebounceTime(DEBOUNCE_TIME_MS);
-  M6LimitSwitch_g.begin(M6_LIMIT);
-  M6LimitSwitch_g.setDebounceTime(DEBOUNCE_TIME_MS);
+  Inputs_g.setInput(M1_LIMIT_INPUT, M1_LIMIT);
+  Inputs_g.setInput(M2_LIMIT_INPUT, M2_LIMIT);
+  Inputs_g.setInput(M3_LIMIT_INPUT, M3_LIMIT);
+  Inputs_g.setInput(M6_LIMIT_INPUT, M6_LIMIT);
 }
 
+#if defined(ENABLE_MOTORS)
 /**
- * @brief Update limit switches input state.
+ * @brief Pressed limit switches.
  *
+ * @return uint8_t Bit per axis index.
  */
-void update_limits()
+uint8_t limits_pressed()
 {
-#if defined(SHOW_FUNC_NAMES_S)
+  uint8_t PressedL = 0;
+  uint8_t InputsL = InputsState_g;
+  bitWrite(PressedL, Axis1_t::INDEX, bitRead(InputsL, M1_LIMIT_INPUT));
+  bitWrite(PressedL, Axis2_t::INDEX, bitRead(InputsL, M2_LIMIT_INPUT));
+  bitWrite(PressedL, Axis3_t::INDEX, bitRead(InputsL, M3_LIMIT_INPUT));
+  bitWrite(PressedL, Axis6_t::INDEX, bitRead(InputsL, M6_LIMIT_INPUT));
+
+  return PressedL;
+}
+
+/**
+ * @brief Initialize the homing of the axises with a limit switch.
+ *
+ */
+void init_homing()
+{
+#if defined(SHOW_FUNC_NAMES)
   DEBUGLOG("\r\n");
   DEBUGLOG(__PRETTY_FUNCTION__);
   DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-#if defined(ENABLE_FEATURES_FLAGS)
-// If the flag is false.
-if (!EnableLimits_g)
-{
-  // Print cancel execution message.
-  // DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
-  // Exit from the function.
-  return;
-}
-#endif // defined(ENABLE_FEATURES_FLAGS)
-
-  M1LimitSwitch_g.loop();
-  M2LimitSwitch_g.loop();
-  M3LimitSwitch_g.loop();
-  M6LimitSwitch_g.loop();
-
-  bitWrite(InputsState_g, 4, M1LimitSwitch_g.isPressed());
-  bitWrite(InputsState_g, 5, M2LimitSwitch_g.isPressed());
-  bitWrite(InputsState_g, 6, M3LimitSwitch_g.isPressed());
-  bitWrite(InputsState_g, 7, M6LimitSwitch_g.isPressed());
+#if defined(ENABLE_LIMIT_1)
+  Homing_g.setAxis(Axis1_t::INDEX, M1_HOME_SPEED, M1_HOME_PRESSED, M1_HOME_BACK_SPEED, M1_HOME_AFTER, M1_TIMEOUT_MS);
+  Homing_g.setApproach(Axis1_t::INDEX, M1_HOME_APPROACH_SPEED, M1_HOME_MARGIN);
+#endif // defined(ENABLE_LIMIT_1)
+#if defined(ENABLE_LIMIT_2)
+  Homing_g.setAxis(Axis2_t::INDEX, M2_HOME_SPEED, M2_HOME_PRESSED, M2_HOME_BACK_SPEED, M2_HOME_AFTER, M2_TIMEOUT_MS);
+  Homing_g.setApproach(Axis2_t::INDEX, M2_HOME_APPROACH_SPEED, M2_HOME_MARGIN);
+#endif // defined(ENABLE_LIMIT_2)
+#if defined(ENABLE_LIMIT_3)
+  Homing_g.setAxis(Axis3_t::INDEX, M3_HOME_SPEED, M3_HOME_PRESSED, M3_HOME_BACK_SPEED, M3_HOME_AFTER, M3_TIMEOUT_MS);
+  Homing_g.setApproach(Axis3_t::INDEX, M3_HOME_APPROACH_SPEED, M3_HOME_MARGIN);
+#endif // defined(ENABLE_LIMIT_3)
+#if defined(ENABLE_LIMIT_6)
+  Homing_g.setAxis(Axis6_t::INDEX, M6_HOME_SPEED, M6_HOME_PRESSED, M6_HOME_BACK_SPEED, M6_HOME_AFTER, M6_TIMEOUT_MS);
+  Homing_g.setApproach(Axis6_t::INDEX, M6_HOME_APPROACH_SPEED, M6_HOME_MARGIN);
+#endif // defined(ENABLE_LIMIT_6)
 }
 
 /**
- * @brief Find the limits of the axises.
+ * @brief Start the homing.
  *
+ * @param axises Axises to home, bit per axis index, the ones without a switch are left out.
+ * @return true Started.
+ * @return false No axis to home.
  */
-void find_limits()
+bool start_homing(uint8_t axises)
 {
 #if defined(SHOW_FUNC_NAMES)
   DEBUGLOG("\r\n");
@@ -1475,7 +4035,7 @@ if (!EnableLimits_g)
   // Print cancel execution message.
   DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
   // Exit from the function.
-  return;
+  return false;
 }
 #endif // defined(ENABLE_FEATURES_FLAGS)
 
@@ -1484,288 +4044,287 @@ if (!EnableLimits_g)
   draw_lcd();
 #endif // defined(ENABLE_STATUS_LCD)
 
-#if defined(ENABLE_LIMIT_1) || \
-    defined(ENABLE_LIMIT_2) || \
-    defined(ENABLE_LIMIT_3) || \
-    defined(ENABLE_LIMIT_6)
-  unsigned long t0 = 0;
-  unsigned long t1 = 0;
-  unsigned long dt = 0;
-  bool timeout_flag = false;
-#endif
-
-#if defined(ENABLE_MOTORS)
-  enable_drivers(true);
-#endif // defined(ENABLE_MOTORS)
-
-#if defined(ENABLE_LIMIT_1)
-
-#if defined(ENABLE_MOTORS)
-  // Set stepper direction and speed.
-  stepper1.setSpeed(-FAST_FORWARD_SPS);
-#endif // defined(ENABLE_MOTORS)
-
-  // Begin time.
-  t0 = millis();
-
-  // This is in case the switch is already hit.
-  M1LimitSwitch_g.loop();
-  while (!M1LimitSwitch_g.isPressed())
-  {
-    // Read the limit switch state.
-    M1LimitSwitch_g.loop();
-
-#if defined(ENABLE_MOTORS)
-    // Run the stepper motor.
-    stepper1.runSpeed();
-#endif // defined(ENABLE_MOTORS)
-
-    // Update the clock for the timeout flag.
-    t1 = millis();
-    dt = t1 - t0;
-    if (dt >= M2_TIMEOUT_MS)
-    {
-      timeout_flag = true;
-      break;
-    }
-  }
-
-  // Do something with the flag.
-  if (timeout_flag)
-  {
-    DEBUGLOG("Overdue time for reaching position on axis Base\r\n");
-#if defined(ENABLE_MOTORS)
-    enable_drivers(false);
-#endif // defined(ENABLE_MOTORS)
-    return;
-  }
-
-#if defined(ENABLE_MOTORS)
-  // Flip stepper direction and speed.
-  stepper1.setSpeed(SLOW_BACKWARD_SPS);
-#endif // defined(ENABLE_MOTORS)
-
-  // This is in case the switch is already hit.
-  M1LimitSwitch_g.loop();
-  while (M1LimitSwitch_g.isPressed() == 1)
-  {
-    // Read the limit switch state.
-    M1LimitSwitch_g.loop();
-
-#if defined(ENABLE_MOTORS)
-    // Run the stepper motor.
-    stepper1.runSpeed();
-#endif // defined(ENABLE_MOTORS)
-  }
-
-#if defined(ENABLE_MOTORS)
-  // Clear software way the homed position.
-  stepper1.setCurrentPosition(0);
-#endif // defined(ENABLE_MOTORS)
-#endif // defined(ENABLE_LIMIT_1)
-
-#if defined(ENABLE_LIMIT_2)
-#if defined(ENABLE_MOTORS)
-  // Set stepper direction and speed.
-  stepper2.setSpeed(FAST_FORWARD_SPS);
-#endif // defined(ENABLE_MOTORS)
-
-  // Begin time.
-  t0 = millis();
-
-  // This is in case the switch is already hit.
-  M2LimitSwitch_g.loop();
-  while (!M2LimitSwitch_g.isPressed())
-  {
-    // Read the limit switch state.
-    M2LimitSwitch_g.loop();
-
-#if defined(ENABLE_MOTORS)
-    // Run the stepper motor.
-    stepper2.runSpeed();
-#endif // defined(ENABLE_MOTORS)
-
-    // Update the clock for the timeout flag.
-    t1 = millis();
-    dt = t1 - t0;
-    if (dt >= M2_TIMEOUT_MS)
-    {
-      timeout_flag = true;
-      break;
-    }
-  }
-
-  // Do something with the flag.
-  if (timeout_flag)
-  {
-    DEBUGLOG("Overdue time for reaching position on axis Shoulder\r\n");
-#if defined(ENABLE_MOTORS)
-    enable_drivers(false);
-#endif // defined(ENABLE_MOTORS)
-    return;
-  }
-
-#if defined(ENABLE_MOTORS)
-  // Flip stepper direction and speed.
-  stepper2.setSpeed(-SLOW_BACKWARD_SPS);
-#endif // defined(ENABLE_MOTORS)
-
-  // This is in case the switch is already hit.
-  M2LimitSwitch_g.loop();
-  while (M2LimitSwitch_g.isPressed() == 1)
+#if defined(ENABLE_LIMIT_LATCH)
+  // The edges of this homing are the ones from now on.
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
   {
-    // Read the limit switch state.
-    M2LimitSwitch_g.loop();
+    HomingEdges_g[index] = LimitLatches_g[index].Edges;
+  }
+#endif // defined(ENABLE_LIMIT_LATCH)
 
-#if defined(ENABLE_MOTORS)
-    // Run the stepper motor.
-    stepper2.runSpeed();
-#endif // defined(ENABLE_MOTORS)
+  // The axises with a known position run fast to their last zero, the
+  // windows hold the deceleration with the accelerations of now.
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    Homing_g.setAcceleration(index, Steppers_g[index].acceleration());
+  }
+  if (!Homing_g.begin(axises, PositionValid_g, millis()))
+  {
+    return false;
   }
 
-#if defined(ENABLE_MOTORS)
-  // Clear software way the homed position.
-  stepper2.setCurrentPosition(0);
-#endif // defined(ENABLE_MOTORS)
-#endif // defined(ENABLE_LIMIT_2)
+  enable_drivers(true);
+  OperationMode_g = OperationModes::Speed;
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    set_axis_speed(index, Homing_g.speed(index));
+  }
 
-#if defined(ENABLE_LIMIT_3)
-#if defined(ENABLE_MOTORS)
-  // Set stepper direction and speed.
-  stepper3.setSpeed(FAST_FORWARD_SPS);
-#endif // defined(ENABLE_MOTORS)
+  return true;
+}
 
-  // This is in case the switch is already hit.
-  M3LimitSwitch_g.loop();
-  while (M3LimitSwitch_g.isPressed())
+/**
+ * @brief Stop the homing, the axises stop with their acceleration.
+ *
+ */
+void stop_homing()
+{
+  if (!Homing_g.isRunning())
   {
-    // Read the limit switch state.
-    M3LimitSwitch_g.loop();
+    return;
+  }
 
-#if defined(ENABLE_MOTORS)
-    // Run the stepper motor.
-    stepper3.runSpeed();
-#endif // defined(ENABLE_MOTORS)
+  Homing_g.stop();
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    set_axis_speed(index, 0);
   }
+}
 
-#if defined(ENABLE_MOTORS)
-  // Flip stepper direction and speed.
-  stepper3.setSpeed(-SLOW_BACKWARD_SPS);
-#endif // defined(ENABLE_MOTORS)
+/**
+ * @brief Advance the homing, called from the main loop.
+ *
+ */
+void update_homing()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
 
-  // Begin time.
-  t0 = millis();
+  if (!Homing_g.isRunning())
+  {
+    return;
+  }
 
-  // This is in case the switch is already hit.
-  M3LimitSwitch_g.loop();
-  while (!M3LimitSwitch_g.isPressed() == 1)
+  long PositionsL[Axises_t::COUNT];
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
   {
-    // Read the limit switch state.
-    M3LimitSwitch_g.loop();
+    PositionsL[index] = Steppers_g[index].currentPosition();
+  }
 
-#if defined(ENABLE_MOTORS)
-    // Run the stepper motor.
-    stepper3.runSpeed();
-#endif // defined(ENABLE_MOTORS)
+  // The switch edge is the zero of the axis.
+  uint8_t ZeroL = Homing_g.update(limits_pressed(), PositionsL, millis());
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    if (ZeroL & (1U << index))
+    {
+      set_axis_speed(index, 0);
+#if defined(ENABLE_LIMIT_LATCH)
+      // The edge is latched by the interrupt, without an edge in this
+      // homing the debounced position is the zero.
+      long EdgeL = PositionsL[index];
+      limit_latch_edge(index, Homing_g.zeroPressed(index), HomingEdges_g[index], EdgeL);
+      // The steps after the edge are kept, the axis ramps down meanwhile.
+      Steppers_g[index].shiftPosition(EdgeL);
+#else
+      Steppers_g[index].setCurrentPosition(0);
+#endif // defined(ENABLE_LIMIT_LATCH)
+      PositionValid_g |= (1U << index);
+    }
+  }
 
-    // Update the clock for the timeout flag.
-    t1 = millis();
-    dt = t1 - t0;
-    if (dt >= M3_TIMEOUT_MS)
+  if (Homing_g.isRunning())
+  {
+    for (uint8_t index = 0; index < Axises_t::COUNT; index++)
     {
-      timeout_flag = true;
-      break;
+      if (Homing_g.axises() & (1U << index))
+      {
+        set_axis_speed(index, Homing_g.speed(index));
+      }
     }
+    return;
   }
 
-  // Do something with the flag.
-  if (timeout_flag)
+  if (Homing_g.state() == Homing::FAILED)
   {
-    DEBUGLOG("Overdue time for reaching position on axis Elbow\r\n");
-#if defined(ENABLE_MOTORS)
+    DEBUGLOG("Overdue time for reaching position on axises 0x%02X\r\n", Homing_g.failed());
     enable_drivers(false);
-#endif // defined(ENABLE_MOTORS)
     return;
   }
 
-#if defined(ENABLE_MOTORS)
-  // Clear software way the homed position.
-  stepper3.setCurrentPosition(0);
-#endif // defined(ENABLE_MOTORS)
-#endif // defined(ENABLE_LIMIT_2)
+  // Homed, move to the positions after the homing.
+  static const long ParkL[Axises_t::COUNT] = {M1_HOME_PARK, M2_HOME_PARK, M3_HOME_PARK, 0, 0, M6_HOME_PARK};
+  OperationMode_g = OperationModes::Positioning;
+  journal_motion();
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    if (Homing_g.axises() & (1U << index))
+    {
+      Steppers_g[index].moveTo(ParkL[index]);
+    }
+  }
+}
 
-#if defined(ENABLE_LIMIT_6)
-#if defined(ENABLE_MOTORS)
-  // Set stepper direction and speed.
-  stepper6.setSpeed(-FAST_FORWARD_SPS);
-#endif // defined(ENABLE_MOTORS)
+/**
+ * @brief Fill the status of the homing.
+ *
+ * @param payload Response buffer, 5 bytes.
+ * @return uint8_t Length of the status.
+ */
+uint8_t homing_status(uint8_t *payload)
+{
+  payload[0] = (uint8_t)Homing_g.state();
+  payload[1] = Homing_g.axises();
+  payload[2] = Homing_g.homed();
+  payload[3] = Homing_g.failed();
+  payload[4] = Homing_g.missed();
 
-  // Begin time.
-  t0 = millis();
+  return 5;
+}
 
-  // This is in case the switch is already hit.
-  M6LimitSwitch_g.loop();
-  while (M6LimitSwitch_g.isPressed())
-  {
-    // Read the limit switch state.
-    M6LimitSwitch_g.loop();
+#if defined(ENABLE_LIMIT_LATCH)
+/**
+ * @brief Attach the latch interrupts to the limit switches.
+ *
+ */
+void init_limit_latch()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
 
-#if defined(ENABLE_MOTORS)
-    // Run the stepper motor.
-    stepper6.runSpeed();
-#endif // defined(ENABLE_MOTORS)
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableLimits_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
 
-    // Update the clock for the timeout flag.
-    t1 = millis();
-    dt = t1 - t0;
-    if (dt >= M6_TIMEOUT_MS)
-    {
-      timeout_flag = true;
-      break;
-    }
-  }
+  memset((void *)LimitLatches_g, 0, sizeof(LimitLatches_g));
+  memset((void *)OutputLags_g, 0, sizeof(OutputLags_g));
 
-  // Do something with the flag.
-  if (timeout_flag)
+  attachInterrupt(digitalPinToInterrupt(M1_LIMIT), isr_limit_latch<Axis1_t, M1_LIMIT>, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(M2_LIMIT), isr_limit_latch<Axis2_t, M2_LIMIT>, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(M3_LIMIT), isr_limit_latch<Axis3_t, M3_LIMIT>, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(M6_LIMIT), isr_limit_latch<Axis6_t, M6_LIMIT>, CHANGE);
+}
+
+/**
+ * @brief Limit switch interrupt, latch the position of the axis on the edge.
+ *
+ * The step timer interrupt owns the position, it is read here as it is
+ * on the edge, without the loop time and the debounce of the switch.
+ * The first edge is latched, the bounces after it are dropped for
+ * LIMIT_LATCH_LOCKOUT_US.
+ *
+ * @tparam A Axis.
+ * @tparam PIN Limit switch pin.
+ */
+template <typename A, uint8_t PIN>
+void IRAM_ATTR isr_limit_latch()
+{
+  LimitLatch_t &LatchL = LimitLatches_g[A::INDEX];
+  uint32_t TimeL = micros();
+  if ((LatchL.Edges != 0) && ((TimeL - LatchL.Time) < LIMIT_LATCH_LOCKOUT_US))
   {
-    DEBUGLOG("Overdue time for reaching position on axis Gripper\r\n");
-#if defined(ENABLE_MOTORS)
-    enable_drivers(false);
-#endif // defined(ENABLE_MOTORS)
     return;
   }
 
-#if defined(ENABLE_MOTORS)
-  // Flip stepper direction and speed.
-  stepper6.setSpeed(SLOW_BACKWARD_SPS);
-#endif // defined(ENABLE_MOTORS)
+  // The motor is behind the planner with the steps still in the output.
+  long PositionL = Steppers_g[A::INDEX].currentPosition() - OutputLags_g[A::INDEX];
+  uint16_t EdgeL = LatchL.Edges + 1;
 
-  // This is in case the switch is already hit.
-  M6LimitSwitch_g.loop();
-  while (!M6LimitSwitch_g.isPressed() == 1)
+  // The switches are active low.
+  if (digitalRead(PIN) == LOW)
   {
-    // Read the limit switch state.
-    M6LimitSwitch_g.loop();
+    LatchL.Pressed = PositionL;
+    LatchL.PressedEdge = EdgeL;
+  }
+  else
+  {
+    LatchL.Released = PositionL;
+    LatchL.ReleasedEdge = EdgeL;
+  }
+  LatchL.Time = TimeL;
+  LatchL.Edges = EdgeL;
+}
 
-#if defined(ENABLE_MOTORS)
-    // Run the stepper motor.
-    stepper6.runSpeed();
-#endif // defined(ENABLE_MOTORS)
+/**
+ * @brief Position of the axis on the last latched edge after the given one.
+ *
+ * @param index Axis index.
+ * @param pressed Edge to pressed, else to released.
+ * @param since Number of the edges before.
+ * @param position Latched position, unchanged without such edge. [steps]
+ * @return true There is such edge.
+ * @return false No edge latched since.
+ */
+bool limit_latch_edge(uint8_t index, bool pressed, uint16_t since, long &position)
+{
+  const LimitLatch_t &LatchL = LimitLatches_g[index];
+  uint16_t EdgesL;
+  uint16_t EdgeL;
+  long PositionL;
+  do
+  {
+    // Read again when the interrupt latched meanwhile.
+    EdgesL = LatchL.Edges;
+    EdgeL = pressed ? LatchL.PressedEdge : LatchL.ReleasedEdge;
+    PositionL = pressed ? LatchL.Pressed : LatchL.Released;
+  } while (EdgesL != LatchL.Edges);
+
+  // The counters wrap, the edge is one of the edges since.
+  if ((uint16_t)(EdgeL - since - 1) >= (uint16_t)(EdgesL - since))
+  {
+    return false;
   }
-#if defined(ENABLE_MOTORS)
-  // Clear software way the homed position.
-  stepper6.setCurrentPosition(0);
+  position = PositionL;
 
-  // Move to standard opening.
-  stepper6.setSpeed(40);
-  stepper6.runToNewPosition(300);
-#endif // defined(ENABLE_MOTORS)
-#endif // defined(ENABLE_LIMIT_6)
+  return true;
+}
 
-#if defined(ENABLE_MOTORS)
-  enable_drivers(false);
-#endif // defined(ENABLE_MOTORS)
+/**
+ * @brief Fill the latched positions of the limit switches.
+ *
+ * Axises 1, 2, 3 and 6 in turn: position on the edge to pressed, position on
+ * the edge to released [steps], time of the last edge [us] as little endian
+ * int32 / uint32 and the number of the edges as uint16.
+ *
+ * @param payload Response buffer, 56 bytes.
+ * @return uint8_t Length of the positions.
+ */
+uint8_t limit_latch_payload(uint8_t *payload)
+{
+  static const uint8_t AxisesL[4] = {Axis1_t::INDEX, Axis2_t::INDEX, Axis3_t::INDEX, Axis6_t::INDEX};
+
+  uint8_t LengthL = 0;
+  for (uint8_t index = 0; index < 4; index++)
+  {
+    const LimitLatch_t &LatchL = LimitLatches_g[AxisesL[index]];
+    const uint32_t ValuesL[3] = {(uint32_t)LatchL.Pressed, (uint32_t)LatchL.Released, LatchL.Time};
+    for (uint8_t value = 0; value < 3; value++)
+    {
+      payload[LengthL++] = (uint8_t)(ValuesL[value]);
+      payload[LengthL++] = (uint8_t)(ValuesL[value] >> 8);
+      payload[LengthL++] = (uint8_t)(ValuesL[value] >> 16);
+      payload[LengthL++] = (uint8_t)(ValuesL[value] >> 24);
+    }
+    payload[LengthL++] = (uint8_t)(LatchL.Edges);
+    payload[LengthL++] = (uint8_t)(LatchL.Edges >> 8);
+  }
+
+  return LengthL;
 }
+#endif // defined(ENABLE_LIMIT_LATCH)
+#endif // defined(ENABLE_MOTORS)
 #endif // defined(ENABLE_LIMITS)
 
 #if defined(ENABLE_ESTOP)
@@ -1797,22 +4356,20 @@ if (!EnableEStop_g)
   draw_lcd();
 #endif // defined(ENABLE_STATUS_LCD)
   //
-  // pinMode(E_STOP, INPUT_PULLUP);
+  pinMode(E_STOP, INPUT_PULLUP);
 
-  EStopSwitch_g.begin(E_STOP, INPUT_PULLUP);
-  EStopSwitch_g.setDebounceTime(DEBOUNCE_TIME_MS);
-  EStopSwitch_g.setPressedHandler([](Button2& btn) {
-#if defined(ENABLE_LIMITS)
-    bitWrite(InputsState_g, 3, EStopSwitch_g.isPressed());
-    DEBUGLOG("E-STOP Released!\r\n");
-#endif
-  });
-    EStopSwitch_g.setReleasedHandler([](Button2& btn) {
-#if defined(ENABLE_LIMITS)
-    bitWrite(InputsState_g, 3, EStopSwitch_g.isPressed());
-    DEBUGLOG("E-STOP Pressed!\r\n");
-#endif
-  });
+  Inputs_g.setInput(ESTOP_INPUT, E_STOP);
+
+#if defined(ENABLE_MOTORS_IO)
+  EStop_g.begin(E_STOP, PIN_ENABLE);
+#else
+  EStop_g.begin(E_STOP, ESTOP_NO_PIN);
+#endif // defined(ENABLE_MOTORS_IO)
+
+  // The stop does not wait for the loop and the debounce.
+  attachInterrupt(digitalPinToInterrupt(E_STOP), isr_estop, RISING);
+  // The switch may be open before the interrupt.
+  EStop_g.trip();
 }
 
 /**
@@ -1837,7 +4394,50 @@ if (!EnableEStop_g)
   return;
 }
 #endif // defined(ENABLE_FEATURES_FLAGS)
-  EStopSwitch_g.loop();
+
+#if defined(ENABLE_MOTORS)
+  // The interrupt stopped the steps and the drivers, the rest of the stop is done here once.
+  if (EStop_g.latched() && MotorsEnabled_g)
+  {
+    DEBUGLOG("E-STOP fault latched!\r\n");
+    HaltAxisAction HaltL;
+    Axises_t::each(HaltL);
+    enable_drivers(false);
+  }
+  if (EStop_g.latched())
+  {
+    // update_drivers() is skipped while the fault is latched, the axises stand.
+    MotorState_g = 0;
+  }
+#endif // defined(ENABLE_MOTORS)
+}
+
+/**
+ * @brief E-Stop interrupt, latch the fault and stop the steps and the drivers.
+ *
+ * The switch is normally closed, the input goes HIGH on the stop and on
+ * a broken wire. The fault stays until reset_estop().
+ */
+void IRAM_ATTR isr_estop()
+{
+  EStop_g.trip();
+}
+
+/**
+ * @brief Clear the E-Stop fault, the drivers stay disabled until enabled again.
+ *
+ * @return true Cleared.
+ * @return false The E-Stop is still active.
+ */
+bool reset_estop()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  return EStop_g.reset();
 }
 #endif // defined(ENABLE_ESTOP)
 
@@ -2155,11 +4755,103 @@ if (!EnableOTA_g)
         }
       });
 
-  ArduinoOTA.begin();
+  ArduinoOTA.begin();
+}
+#endif // defined(ENABLE_OTA)
+
+#if defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
+/**
+ * @brief Read the extended telemetry.
+ *
+ * The positions and the speeds are the joint ones, as in the current
+ * position reading, without the 16 bit limit.
+ *
+ * @param telemetry Telemetry.
+ */
+void read_telemetry(Telemetry_t &telemetry)
+{
+  telemetry.Time = micros();
+  telemetry.MotorState = 0;
+  telemetry.Inputs = 0;
+  telemetry.Valid = 0;
+  telemetry.Flags = 0;
+  for (uint8_t index = 0; index < TELEMETRY_AXISES; index++)
+  {
+    telemetry.Position[index] = 0;
+    telemetry.Speed[index] = 0;
+  }
+
+#if defined(ENABLE_MOTORS)
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    telemetry.Position[index] = (int32_t)axis_position(index);
+    telemetry.Speed[index] = (int32_t)lroundf(axis_speed(index) * (float)(1L << TELEMETRY_SPEED_SHIFT));
+  }
+  telemetry.MotorState = MotorState_g;
+  telemetry.Valid = PositionValid_g;
+  if (MotorsEnabled_g)
+  {
+    telemetry.Flags |= TELEMETRY_FLAG_ENABLED;
+  }
+  if (EStop_g.latched())
+  {
+    telemetry.Flags |= TELEMETRY_FLAG_ESTOP;
+  }
+#if defined(ENABLE_WDT)
+  if (WatchDogStop_g)
+  {
+    telemetry.Flags |= TELEMETRY_FLAG_WDT_STOP;
+  }
+#endif // defined(ENABLE_WDT)
+#endif // defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
+  telemetry.Inputs = InputsState_g;
+#endif // defined(ENABLE_ESTOP) || defined(ENABLE_LIMITS)
+}
+#endif // defined(ENABLE_SUPER) || defined(ENABLE_TCM_COMMANDS)
+
+#if defined(ENABLE_SUPER)
+/**
+ * @brief Fill the extended telemetry frame.
+ *
+ * Time [us] as little endian uint32, the positions [steps] and the speeds
+ * [steps/s, TELEMETRY_SPEED_SHIFT fraction bits] of the six joints as
+ * little endian int32, then the motor state, the inputs, the valid axises
+ * and the flags as one byte each.
+ *
+ * @param payload Response buffer, TELEMETRY_LENGTH bytes.
+ * @return uint8_t Length of the frame.
+ */
+uint8_t telemetry_payload(uint8_t *payload)
+{
+  Telemetry_t TelemetryL;
+  read_telemetry(TelemetryL);
+
+  uint32_t ValuesL[1 + 2 * TELEMETRY_AXISES];
+  ValuesL[0] = TelemetryL.Time;
+  for (uint8_t index = 0; index < TELEMETRY_AXISES; index++)
+  {
+    ValuesL[1 + index] = (uint32_t)TelemetryL.Position[index];
+    ValuesL[1 + TELEMETRY_AXISES + index] = (uint32_t)TelemetryL.Speed[index];
+  }
+
+  uint8_t LengthL = 0;
+  for (uint8_t value = 0; value < 1 + 2 * TELEMETRY_AXISES; value++)
+  {
+    payload[LengthL++] = (uint8_t)(ValuesL[value]);
+    payload[LengthL++] = (uint8_t)(ValuesL[value] >> 8);
+    payload[LengthL++] = (uint8_t)(ValuesL[value] >> 16);
+    payload[LengthL++] = (uint8_t)(ValuesL[value] >> 24);
+  }
+  payload[LengthL++] = TelemetryL.MotorState;
+  payload[LengthL++] = TelemetryL.Inputs;
+  payload[LengthL++] = TelemetryL.Valid;
+  payload[LengthL++] = TelemetryL.Flags;
+
+  return LengthL;
 }
-#endif // defined(ENABLE_OTA)
 
-#if defined(ENABLE_SUPER)
 /**
  * @brief Initialize the communication.
  *
@@ -2244,6 +4936,9 @@ if (!EnableSUPER_g)
 #endif // ENABLE_MOTORS_IO
 #if defined(ENABLE_WDT)
       feed_wdt();
+#if defined(ENABLE_MOTORS)
+      wdt_resume();
+#endif // ENABLE_MOTORS
 #endif // ENABLE_WDT
     }
   }
@@ -2270,7 +4965,10 @@ if (!EnableSUPER_g)
     ClientL.stop();
     StateL = 0;
     DEBUGLOG("Disconnected: %s\r\n", ClientL.remoteIP().toString().c_str());
-#if defined(ENABLE_MOTORS_IO)
+#if defined(ENABLE_WDT) && defined(ENABLE_MOTORS)
+    // The axises stop on the path and the positions are kept for the next client.
+    wdt_stop();
+#elif defined(ENABLE_MOTORS_IO)
     enable_drivers(false);
 #endif // ENABLE_MOTORS_IO
   }
@@ -2291,20 +4989,20 @@ if (!EnableSUPER_g)
   if (wdt_expired())
   {
 #if defined(ENABLE_MOTORS)
-    if (MotorsEnabled_g == true)
+    if ((MotorsEnabled_g == true) && (WatchDogStop_g == false))
     {
       DEBUGLOG("WDT EXPIRED...\r\n");
-      enable_drivers(false);
+      wdt_stop();
     }
 #endif // ENABLE_MOTORS
   }
   else
   {
 #if defined(ENABLE_MOTORS)
-    if (MotorsEnabled_g == false)
+    if ((WatchDogStop_g == true) || (MotorsEnabled_g == false))
     {
       DEBUGLOG("WDT RESET BY NEW UDP PACKAGE...\r\n");
-      enable_drivers(true);
+      wdt_resume();
     }
 #endif // ENABLE_MOTORS
   }
@@ -2349,12 +5047,26 @@ if (!EnableSUPER_g)
   {
 #if defined(ENABLE_MOTORS)
     // Robko01.stop_motors();
-    stepper1.stop();
-    stepper2.stop();
-    stepper3.stop();
-    stepper4.stop();
-    stepper5.stop();
-    stepper6.stop();
+#if defined(ENABLE_MOTION_QUEUE)
+    MotionQueue_g.clear();
+#endif // defined(ENABLE_MOTION_QUEUE)
+#if defined(ENABLE_COORDINATED_MOTION)
+    Coordinated_g.stop();
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_PVT_STREAM)
+    Pvt_g.stop();
+#endif // defined(ENABLE_PVT_STREAM)
+#if defined(ENABLE_LINEAR_MOVE)
+    Linear_g.stop();
+#endif // defined(ENABLE_LINEAR_MOVE)
+#if defined(ENABLE_LIMITS)
+    stop_homing();
+#endif // defined(ENABLE_LIMITS)
+#if defined(ENABLE_SHMR)
+    stop_gripper();
+#endif // defined(ENABLE_SHMR)
+    StopAxisAction StopL;
+    Axises_t::each(StopL);
 #endif // SHOW_FUNC_NAMES
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   }
@@ -2371,6 +5083,13 @@ if (!EnableSUPER_g)
 #if defined(ENABLE_MOTORS)
     // Robko01.enable_motors();
     enable_drivers(true);
+#if defined(ENABLE_ESTOP)
+    if (EStop_g.latched())
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+#endif // defined(ENABLE_ESTOP)
 #endif // SHOW_FUNC_NAMES
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   }
@@ -2378,12 +5097,27 @@ if (!EnableSUPER_g)
   {
 #if defined(ENABLE_MOTORS)
     // Robko01.clear_motors();
-    stepper1.setCurrentPosition(0);
-    stepper2.setCurrentPosition(0);
-    stepper3.setCurrentPosition(0);
-    stepper4.setCurrentPosition(0);
-    stepper5.setCurrentPosition(0);
-    stepper6.setCurrentPosition(0);
+#if defined(ENABLE_MOTION_QUEUE)
+    MotionQueue_g.clear();
+#endif // defined(ENABLE_MOTION_QUEUE)
+#if defined(ENABLE_COORDINATED_MOTION)
+    Coordinated_g.reset();
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_PVT_STREAM)
+    Pvt_g.reset();
+#endif // defined(ENABLE_PVT_STREAM)
+#if defined(ENABLE_LINEAR_MOVE)
+    Linear_g.stop();
+#endif // defined(ENABLE_LINEAR_MOVE)
+#if defined(ENABLE_LIMITS)
+    stop_homing();
+#endif // defined(ENABLE_LIMITS)
+#if defined(ENABLE_INPUT_SHAPER)
+    ShaperResetAxisAction ShaperL;
+    Axises_t::each(ShaperL);
+#endif // defined(ENABLE_INPUT_SHAPER)
+    ClearAxisAction ClearL;
+    Axises_t::each(ClearL);
 #endif // SHOW_FUNC_NAMES
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   }
@@ -2395,6 +5129,7 @@ if (!EnableSUPER_g)
       SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
       return;
     }
+#if !defined(ENABLE_MOTION_QUEUE)
     // If it is move, do not execute the command.
     if (MotorState_g != 0)
     {
@@ -2402,6 +5137,7 @@ if (!EnableSUPER_g)
       SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
       return;
     }
+#endif // !defined(ENABLE_MOTION_QUEUE)
 
     // TODO: Move to function.
     size_t DataLengthL = sizeof(JointPosition_t);
@@ -2409,23 +5145,25 @@ if (!EnableSUPER_g)
     {
       MoveRelative_g.Buffer[index] = payload[index];
     }
-#if defined(ENABLE_MOTORS)
+#if defined(ENABLE_MOTION_QUEUE)
+    // Queue the motion after the last queued segment.
+    if (!enqueue_segment(MoveRelative_g.Value, true))
+    {
+      uint8_t m_payloadResponse[1] = {MotionQueue_g.count()};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
+#elif defined(ENABLE_MOTORS)
     // Set motion data.
     // Robko01.move_relative(MoveRelative_g.Value);
     OperationMode_g = OperationModes::Positioning;
 
-    stepper1.setSpeed(MoveRelative_g.Value.BaseSpeed);
-    stepper1.move(MoveRelative_g.Value.BasePos);
-    stepper2.setSpeed(MoveRelative_g.Value.ShoulderSpeed);
-    stepper2.move(MoveRelative_g.Value.ShoulderPos);
-    stepper3.setSpeed(MoveRelative_g.Value.ElbowSpeed);
-    stepper3.move(MoveRelative_g.Value.ElbowPos);
-    stepper4.setSpeed(MoveRelative_g.Value.LeftDiffSpeed);
-    stepper4.move(MoveRelative_g.Value.LeftDiffPos);
-    stepper5.setSpeed(MoveRelative_g.Value.RightDiffSpeed);
-    stepper5.move(MoveRelative_g.Value.RightDiffPos);
-    stepper6.setSpeed(MoveRelative_g.Value.GripperSpeed);
-    stepper6.move(MoveRelative_g.Value.GripperPos);
+    journal_motion();
+    MoveRelativeAxisAction MoveL = {MoveRelative_g.Value};
+    Axises_t::each(MoveL);
+#if defined(ENABLE_WRIST_TRANSFORM)
+    sync_wrist(stepper4.distanceToGo(), stepper5.distanceToGo());
+#endif // defined(ENABLE_WRIST_TRANSFORM)
 #endif // SHOW_FUNC_NAMES
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
@@ -2441,6 +5179,7 @@ if (!EnableSUPER_g)
       // Exit
       return;
     }
+#if !defined(ENABLE_MOTION_QUEUE)
     // If it is move, do not execute the command.
     if (MotorState_g != 0)
     {
@@ -2452,6 +5191,7 @@ if (!EnableSUPER_g)
       // Exit
       return;
     }
+#endif // !defined(ENABLE_MOTION_QUEUE)
 
     // Extract motion data.
     size_t DataLengthL = sizeof(JointPosition_t);
@@ -2459,40 +5199,28 @@ if (!EnableSUPER_g)
     {
       MoveAbsolute_g.Buffer[index] = payload[index];
     }
-#if defined(ENABLE_MOTORS)
+#if defined(ENABLE_MOTION_QUEUE)
+    // Queue the motion, it blends with the running one.
+    if (!enqueue_segment(MoveAbsolute_g.Value, false))
+    {
+      // Respond with busy, the queue is full.
+      uint8_t m_payloadResponse[1];
+      m_payloadResponse[0] = MotionQueue_g.count();
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+
+      // Exit
+      return;
+    }
+#elif defined(ENABLE_MOTORS)
     // Set motion data.
     // Robko01.move_absolute(MoveAbsolute_g.Value);
     OperationMode_g = OperationModes::Positioning;
-    if (stepper1.currentPosition() != MoveAbsolute_g.Value.BasePos)
-    {
-      stepper1.setSpeed(MoveAbsolute_g.Value.BaseSpeed);
-      stepper1.moveTo(MoveAbsolute_g.Value.BasePos);  
-    }
-    if (stepper2.currentPosition() != MoveAbsolute_g.Value.ShoulderPos)
-    {
-      stepper2.setSpeed(MoveAbsolute_g.Value.ShoulderSpeed);
-      stepper2.moveTo(MoveAbsolute_g.Value.ShoulderPos); 
-    }
-    if (stepper3.currentPosition() != MoveAbsolute_g.Value.ElbowPos)
-    {
-      stepper3.setSpeed(MoveAbsolute_g.Value.ElbowSpeed);
-      stepper3.moveTo(MoveAbsolute_g.Value.ElbowPos);
-    }
-    if (stepper4.currentPosition() != MoveAbsolute_g.Value.LeftDiffPos)
-    {
-      stepper4.setSpeed(MoveAbsolute_g.Value.LeftDiffSpeed);
-      stepper4.moveTo(MoveAbsolute_g.Value.LeftDiffPos);
-    }
-    if (stepper5.currentPosition() != MoveAbsolute_g.Value.RightDiffPos)
-    {
-      stepper5.setSpeed(MoveAbsolute_g.Value.RightDiffSpeed);
-      stepper5.moveTo(MoveAbsolute_g.Value.RightDiffPos);
-    }
-    if (stepper6.currentPosition() != MoveAbsolute_g.Value.GripperPos)
-    {
-      stepper6.setSpeed(MoveAbsolute_g.Value.GripperSpeed);
-      stepper6.moveTo(MoveAbsolute_g.Value.GripperPos);
-    }
+    journal_motion();
+    MoveAbsoluteAxisAction MoveL = {MoveAbsolute_g.Value};
+    Axises_t::each(MoveL);
+#if defined(ENABLE_WRIST_TRANSFORM)
+    sync_wrist(stepper4.distanceToGo(), stepper5.distanceToGo());
+#endif // defined(ENABLE_WRIST_TRANSFORM)
 #endif // SHOW_FUNC_NAMES
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
@@ -2545,18 +5273,8 @@ if (!EnableSUPER_g)
   {
 #if defined(ENABLE_MOTORS)
     // CurrentPositions_g.Value = Robko01.get_position();
-    CurrentPositions_g.Value.BasePos = (int16_t)stepper1.currentPosition();
-    CurrentPositions_g.Value.BaseSpeed = (int16_t)stepper1.speed();
-    CurrentPositions_g.Value.ShoulderPos = (int16_t)stepper2.currentPosition();
-    CurrentPositions_g.Value.ShoulderSpeed = (int16_t)stepper2.speed();
-    CurrentPositions_g.Value.ElbowPos = (int16_t)stepper3.currentPosition();
-    CurrentPositions_g.Value.ElbowSpeed = (int16_t)stepper3.speed();
-    CurrentPositions_g.Value.LeftDiffPos = (int16_t)stepper4.currentPosition();
-    CurrentPositions_g.Value.LeftDiffSpeed = (int16_t)stepper4.speed();
-    CurrentPositions_g.Value.RightDiffPos = (int16_t)stepper5.currentPosition();
-    CurrentPositions_g.Value.RightDiffSpeed = (int16_t)stepper5.speed();
-    CurrentPositions_g.Value.GripperPos = (int16_t)stepper6.currentPosition();
-    CurrentPositions_g.Value.GripperSpeed = (int16_t)stepper6.speed();
+    ReadAxisAction ReadL = {CurrentPositions_g.Value};
+    Axises_t::each(ReadL);
 #endif // SHOW_FUNC_NAMES
 #if defined(ENABLE_WDT)
     feed_wdt();
@@ -2564,6 +5282,14 @@ if (!EnableSUPER_g)
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, CurrentPositions_g.Buffer, sizeof(JointPosition_t));
   }
+  else if (opcode == TELEMETRY)
+  {
+#if defined(ENABLE_WDT)
+    feed_wdt();
+#endif // ENABLE_WDT
+    uint8_t m_payloadResponse[TELEMETRY_LENGTH];
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, telemetry_payload(m_payloadResponse));
+  }
   else if (opcode == OpCodes::MoveSpeed)
   {
     // If it is not enabled, do not execute.
@@ -2582,12 +5308,9 @@ if (!EnableSUPER_g)
     // Robko01.move_speed(MoveSpeed_g.Value);
     OperationMode_g = OperationModes::Speed;
 
-    stepper1.setSpeed(MoveSpeed_g.Value.BaseSpeed);
-    stepper2.setSpeed(MoveSpeed_g.Value.ShoulderSpeed);
-    stepper3.setSpeed(MoveSpeed_g.Value.ElbowSpeed);
-    stepper4.setSpeed(MoveSpeed_g.Value.LeftDiffSpeed);
-    stepper5.setSpeed(MoveSpeed_g.Value.RightDiffSpeed);
-    stepper6.setSpeed(MoveSpeed_g.Value.GripperSpeed);
+    journal_motion();
+    MoveSpeedAxisAction MoveL = {MoveSpeed_g.Value};
+    Axises_t::each(MoveL);
 #endif // defined(ENABLE_MOTORS)
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
@@ -2604,21 +5327,408 @@ if (!EnableSUPER_g)
   }
   else if (opcode == OpCodes::GetRobotID)
   {
-    // TODO: Read from I2C EEPROM.
-    // for (uint8_t index = 0; index < DataLengthL; index++)
-    //{
-    //	m_payloadRequest[index] = Motion.Buffer[index];
-    //}
-
-    SUPER.send_raw_response(opcode, StatusCodes::Ok, payload, size - 1);
+    // TODO: Read from I2C EEPROM.
+    // for (uint8_t index = 0; index < DataLengthL; index++)
+    //{
+    //	m_payloadRequest[index] = Motion.Buffer[index];
+    //}
+
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, payload, size - 1);
+  }
+#if defined(ENABLE_MOTION_QUEUE)
+  else if (opcode == ENQUEUE_ABSOLUTE)
+  {
+    // If it is not enabled, do not execute.
+    if (MotorsEnabled_g == false)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+
+    // Payload: segments count, then the segments.
+    if (size < 1)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    uint8_t CountL = payload[0];
+    size_t DataLengthL = sizeof(JointPosition_t);
+    if ((CountL == 0) || ((1 + CountL * DataLengthL) > size))
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+
+    // All or nothing, the host retries with the same batch.
+    uint8_t m_payloadResponse[2];
+    if (CountL > MotionQueue_g.available())
+    {
+      m_payloadResponse[0] = MotionQueue_g.count();
+      m_payloadResponse[1] = MotionQueue_g.available();
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 2);
+      return;
+    }
+
+    for (uint8_t segment = 0; segment < CountL; segment++)
+    {
+      for (uint8_t index = 0; index < DataLengthL; index++)
+      {
+        MoveAbsolute_g.Buffer[index] = payload[1 + segment * DataLengthL + index];
+      }
+      enqueue_segment(MoveAbsolute_g.Value, false);
+    }
+
+    m_payloadResponse[0] = MotionQueue_g.count();
+    m_payloadResponse[1] = MotionQueue_g.available();
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 2);
+  }
+  else if (opcode == QUEUE_DEPTH)
+  {
+    uint8_t m_payloadResponse[3];
+    m_payloadResponse[0] = MotionQueue_g.count();
+    m_payloadResponse[1] = MotionQueue_g.capacity();
+    m_payloadResponse[2] = MotorState_g;
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 3);
+  }
+#endif // defined(ENABLE_MOTION_QUEUE)
+#if defined(ENABLE_COORDINATED_MOTION)
+  else if (opcode == MOVE_COORDINATED)
+  {
+    // If it is not enabled, do not execute.
+    if (MotorsEnabled_g == false)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    // If it is move, do not execute the command.
+    if (MotorState_g != 0)
+    {
+      uint8_t m_payloadResponse[1] = {MotorState_g};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
+
+    // Extract motion data.
+    size_t DataLengthL = sizeof(JointPosition_t);
+    for (uint8_t index = 0; index < DataLengthL; index++)
+    {
+      MoveAbsolute_g.Buffer[index] = payload[index];
+    }
+
+    // Respond with the planned duration of the move. [ms]
+    uint32_t DurationL = 0;
+    if (move_coordinated(MoveAbsolute_g.Value))
+    {
+      DurationL = (uint32_t)(Coordinated_g.duration() * 1000.0F + 0.5F);
+    }
+    uint8_t m_payloadResponse[4];
+    m_payloadResponse[0] = (uint8_t)(DurationL);
+    m_payloadResponse[1] = (uint8_t)(DurationL >> 8);
+    m_payloadResponse[2] = (uint8_t)(DurationL >> 16);
+    m_payloadResponse[3] = (uint8_t)(DurationL >> 24);
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 4);
+  }
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_SCURVE)
+  else if (opcode == SET_PROFILE)
+  {
+    // The ramp is changed only while the axises stand.
+    if (MotorState_g != 0)
+    {
+      uint8_t m_payloadResponse[1] = {MotorState_g};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
+    if (size < 1)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+
+    SCurveAxises_g = payload[0] & Axises_t::BITS;
+    ProfileAxisAction ProfileL = {SCurveAxises_g};
+    Axises_t::each(ProfileL);
+
+    uint8_t m_payloadResponse[1] = {SCurveAxises_g};
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 1);
+  }
+#endif // defined(ENABLE_SCURVE)
+#if defined(ENABLE_INPUT_SHAPER)
+  else if (opcode == SET_SHAPER)
+  {
+    // Payload: axis, type, frequency [0.01 Hz], damping [0.001].
+    if (size < 6)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    uint8_t AxisL = payload[0];
+    InputShaper::Type TypeL = (InputShaper::Type)payload[1];
+    float FrequencyL = (float)(payload[2] | (payload[3] << 8)) / 100.0F;
+    float DampingL = (float)(payload[4] | (payload[5] << 8)) / 1000.0F;
+    if ((AxisL >= Axises_t::COUNT) || (TypeL > InputShaper::ZVD))
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    // The shaper is changed only while the axis stands.
+    if (MotorState_g & (1U << AxisL))
+    {
+      uint8_t m_payloadResponse[1] = {MotorState_g};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
+    if (!Shapers_g[AxisL].set(TypeL, FrequencyL, DampingL, StepTimer::frequency()))
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, payload, 6);
+  }
+#endif // defined(ENABLE_INPUT_SHAPER)
+#if defined(ENABLE_JOINT_COUPLING)
+  else if (opcode == SET_COUPLING)
+  {
+    // Payload: motor axis, joint axis, then the ratio [0.0001 steps/step] to set it.
+    if (size < 2)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    uint8_t AxisL = payload[0];
+    uint8_t JointL = payload[1];
+    if ((AxisL >= Axises_t::COUNT) || (JointL >= Axises_t::COUNT) || (AxisL == JointL))
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    if (size >= 6)
+    {
+      // The coupling is changed only while both axises stand.
+      if (MotorState_g & ((1U << AxisL) | (1U << JointL)))
+      {
+        uint8_t m_payloadResponse[1] = {MotorState_g};
+        SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+        return;
+      }
+      int32_t ValueL = (int32_t)((uint32_t)payload[2] | ((uint32_t)payload[3] << 8) | ((uint32_t)payload[4] << 16) | ((uint32_t)payload[5] << 24));
+      if (!Coupling_g.set(AxisL, JointL, (float)ValueL / 10000.0F))
+      {
+        SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+        return;
+      }
+    }
+    float RatioL = Coupling_g.ratio(AxisL, JointL) * 10000.0F;
+    int32_t ValueL = (int32_t)((RatioL >= 0.0F) ? (RatioL + 0.5F) : (RatioL - 0.5F));
+    uint8_t m_payloadResponse[6] = {
+      AxisL,
+      JointL,
+      (uint8_t)(ValueL & 0xFF),
+      (uint8_t)((ValueL >> 8) & 0xFF),
+      (uint8_t)((ValueL >> 16) & 0xFF),
+      (uint8_t)((ValueL >> 24) & 0xFF),
+    };
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 6);
+  }
+#endif // defined(ENABLE_JOINT_COUPLING)
+#if defined(ENABLE_PVT_STREAM)
+  else if (opcode == PVT_STREAM)
+  {
+    // Payload: count, then the points, joint positions and speeds and duration [ms].
+    // Count of zero only reads the status.
+    const size_t DataLengthL = sizeof(JointPosition_t);
+    const size_t PointLengthL = DataLengthL + 2;
+    if (size < 1)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    uint8_t CountL = payload[0];
+    uint8_t m_payloadResponse[7];
+    if ((1 + CountL * PointLengthL) > size)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    if (CountL == 0)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, pvt_stream_status(m_payloadResponse));
+      return;
+    }
+    // If it is not enabled, do not execute.
+    if (MotorsEnabled_g == false)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+#if defined(ENABLE_LINEAR_MOVE)
+    // The line feeds the stream.
+    if (Linear_g.isRunning())
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, pvt_stream_status(m_payloadResponse));
+      return;
+    }
+#endif // defined(ENABLE_LINEAR_MOVE)
+    if (!Pvt_g.isRunning())
+    {
+      // The stream takes the axises only while they stand.
+      if (MotorState_g != 0)
+      {
+        SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, pvt_stream_status(m_payloadResponse));
+        return;
+      }
+      begin_pvt_stream();
+    }
+    // All or nothing, the host retries with the same batch.
+    if (CountL > Pvt_g.available())
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, pvt_stream_status(m_payloadResponse));
+      return;
+    }
+
+    for (uint8_t point = 0; point < CountL; point++)
+    {
+      const uint8_t *DataL = payload + 1 + point * PointLengthL;
+      for (uint8_t index = 0; index < DataLengthL; index++)
+      {
+        MoveAbsolute_g.Buffer[index] = DataL[index];
+      }
+      PvtPoint PointL;
+      for (uint8_t index = 0; index < PVT_AXISES; index++)
+      {
+        PointL.Position[index] = motor_position(MoveAbsolute_g.Value, index);
+        PointL.Velocity[index] = motor_speed(MoveAbsolute_g.Value, index);
+      }
+      PointL.Duration = DataL[DataLengthL] | (DataL[DataLengthL + 1] << 8);
+      Pvt_g.push(PointL);
+    }
+
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, pvt_stream_status(m_payloadResponse));
+  }
+  else if (opcode == PVT_LATENCY)
+  {
+    // Payload: latency window [ms].
+    if ((size < 2) || !Pvt_g.setLatency(payload[0] | (payload[1] << 8)))
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    uint8_t m_payloadResponse[7];
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, pvt_stream_status(m_payloadResponse));
+  }
+#endif // defined(ENABLE_PVT_STREAM)
+#if defined(ENABLE_KINEMATICS)
+  else if (opcode == READ_POSE)
+  {
+    // The pose is computed here, only when it is asked for.
+    uint8_t m_payloadResponse[20];
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, pose_payload(m_payloadResponse));
+  }
+#endif // defined(ENABLE_KINEMATICS)
+#if defined(ENABLE_LINEAR_MOVE)
+  else if (opcode == MOVE_LINEAR)
+  {
+    // If it is not enabled, do not execute.
+    if (MotorsEnabled_g == false)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    // If it is move, do not execute the command.
+    if ((MotorState_g != 0) || Pvt_g.isRunning())
+    {
+      uint8_t m_payloadResponse[1] = {MotorState_g};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
+
+    // Payload: X, Y, Z [0.01 mm], pitch and roll [0.01 deg], speed [mm/s].
+    if (size < 22)
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    float ValuesL[5];
+    for (uint8_t index = 0; index < 5; index++)
+    {
+      const uint8_t *DataL = payload + index * 4;
+      int32_t ValueL = (int32_t)((uint32_t)DataL[0] | ((uint32_t)DataL[1] << 8) | ((uint32_t)DataL[2] << 16) | ((uint32_t)DataL[3] << 24));
+      ValuesL[index] = (float)ValueL / 100.0F;
+    }
+    KinematicsPose TargetL = {ValuesL[0], ValuesL[1], ValuesL[2], ValuesL[3], ValuesL[4]};
+    float SpeedL = (float)(payload[20] | (payload[21] << 8));
+
+    if (!move_linear(TargetL, SpeedL))
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+
+    // Respond with the planned duration of the move. [ms]
+    uint32_t DurationL = (uint32_t)(Linear_g.duration() * 1000.0F + 0.5F);
+    uint8_t m_payloadResponse[4];
+    m_payloadResponse[0] = (uint8_t)(DurationL);
+    m_payloadResponse[1] = (uint8_t)(DurationL >> 8);
+    m_payloadResponse[2] = (uint8_t)(DurationL >> 16);
+    m_payloadResponse[3] = (uint8_t)(DurationL >> 24);
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 4);
+  }
+#endif // defined(ENABLE_LINEAR_MOVE)
+#if defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+  else if (opcode == HOME)
+  {
+    // Payload: axises to home, bit per axis index, zero is all of them.
+    uint8_t m_payloadResponse[5];
+    if ((MotorState_g != 0) || Homing_g.isRunning())
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, homing_status(m_payloadResponse));
+      return;
+    }
+    uint8_t AxisesL = ((size > 0) && (payload[0] != 0)) ? payload[0] : Axises_t::BITS;
+    if (!start_homing(AxisesL))
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, m_payloadResponse, homing_status(m_payloadResponse));
+      return;
+    }
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, homing_status(m_payloadResponse));
+  }
+  else if (opcode == HOME_STATUS)
+  {
+    uint8_t m_payloadResponse[5];
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, homing_status(m_payloadResponse));
+  }
+#if defined(ENABLE_LIMIT_LATCH)
+  else if (opcode == LIMIT_LATCH)
+  {
+    uint8_t m_payloadResponse[56];
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, limit_latch_payload(m_payloadResponse));
+  }
+#endif // defined(ENABLE_LIMIT_LATCH)
+#endif // defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+#if defined(ENABLE_ESTOP)
+  else if (opcode == ESTOP_RESET)
+  {
+    // The fault is cleared only when the E-Stop is released.
+    if (!reset_estop())
+    {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   }
+#endif // defined(ENABLE_ESTOP)
 #if defined(ENABLE_SHMR)
   else if (opcode == MOVE_TO_ABSOLUTE_ANGLES_Q1Q2Q3)
   {
     float q[3];
     getAbsolute_Angles_q1q2q3_FromPayload(payload, q);
     DEBUGLOG("Q1: %f; Q2: %f; Q3: %f\r\n", q[0], q[1], q[2]);
-    sendTaskToSteppers(q[0], q[1], q[2], A6_ZERO);
+    if (!sendTaskToSteppers(q[0], q[1], q[2], A6_ZERO))
+    {
+      uint8_t m_payloadResponse[1] = {(uint8_t)GripperJob_g};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   }
@@ -2630,13 +5740,25 @@ if (!EnableSUPER_g)
   }
   else if (opcode == GRIPPER_GRIP)
   {
-    gripperGrip();
+    // The gripper moves from the main loop, GRIPPER_STATUS gives the end.
+    if (!gripperGrip())
+    {
+      uint8_t m_payloadResponse[1] = {(uint8_t)GripperJob_g};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   }
   else if (opcode == GRIPPER_UNGRIP)
   {
-    gripperUngrip();
+    // The gripper moves from the main loop, GRIPPER_STATUS gives the end.
+    if (!gripperUngrip())
+    {
+      uint8_t m_payloadResponse[1] = {(uint8_t)GripperJob_g};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   }
@@ -2644,10 +5766,20 @@ if (!EnableSUPER_g)
   {
     float a;
     a = getGripperAbsoluteDistance_FromPayload(payload);
-    gripperOpenTo(a);
+    if (!gripperOpenTo(a))
+    {
+      uint8_t m_payloadResponse[1] = {(uint8_t)GripperJob_g};
+      SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+      return;
+    }
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   }
+  else if (opcode == GRIPPER_STATUS)
+  {
+    uint8_t m_payloadResponse[2] = {(uint8_t)GripperJob_g, (uint8_t)GripperResult_g};
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 2);
+  }
 #endif // defined(ENABLE_SHMR)
   else
   {
@@ -2693,9 +5825,23 @@ if (!EnableTCM_g)
   CommandParser_g.registerCommand(CMD_FREE, NO_ARGS, &cmd_free);
   CommandParser_g.registerCommand(CMD_CLOSE, NO_ARGS, &cmd_close);
   CommandParser_g.registerCommand(CMD_READ, NO_ARGS, &cmd_read);
+  CommandParser_g.registerCommand(CMD_READX, NO_ARGS, &cmd_readx);
   CommandParser_g.registerCommand(CMD_RESET, NO_ARGS, &cmd_reset);
   CommandParser_g.registerCommand(CMD_SET, SET_ARGS, &cmd_set);
   CommandParser_g.registerCommand(CMD_STEP, STEP_ARGS, &cmd_step);
+#if defined(ENABLE_COORDINATED_MOTION)
+  CommandParser_g.registerCommand(CMD_STEPC, STEP_ARGS, &cmd_stepc);
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_KINEMATICS)
+  CommandParser_g.registerCommand(CMD_POSE, NO_ARGS, &cmd_pose);
+#endif // defined(ENABLE_KINEMATICS)
+#if defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+  CommandParser_g.registerCommand(CMD_HOME, NO_ARGS, &cmd_home);
+  CommandParser_g.registerCommand(CMD_HOMING, NO_ARGS, &cmd_homing);
+#endif // defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+#if defined(ENABLE_ESTOP)
+  CommandParser_g.registerCommand(CMD_ESTOP_RESET, NO_ARGS, &cmd_estop_reset);
+#endif // defined(ENABLE_ESTOP)
 }
 
 /**
@@ -2836,20 +5982,20 @@ if (!EnableTCM_g)
   if (wdt_expired())
   {
 #if defined(ENABLE_MOTORS)
-    if (MotorsEnabled_g == true)
+    if ((MotorsEnabled_g == true) && (WatchDogStop_g == false))
     {
       DEBUGLOG("WDT EXPIRED...\r\n");
-      enable_drivers(false);
+      wdt_stop();
     }
 #endif // ENABLE_MOTORS
   }
   else
   {
 #if defined(ENABLE_MOTORS)
-    if (MotorsEnabled_g == false)
+    if ((WatchDogStop_g == true) || (MotorsEnabled_g == false))
     {
       DEBUGLOG("WDT RESET BY NEW TCM PACKAGE...\r\n");
-      enable_drivers(true);
+      wdt_resume();
     }
 #endif // ENABLE_MOTORS
   }
@@ -2932,6 +6078,7 @@ if (!EnableTCM_g)
 #if defined(ENABLE_LIMIT_6)
 #if defined(ENABLE_MOTORS)
   // Set stepper direction and speed.
+  journal_motion();
   stepper6.setSpeed(-FAST_FORWARD_SPS);
 #endif // defined(ENABLE_MOTORS)
 
@@ -2939,11 +6086,11 @@ if (!EnableTCM_g)
   t0 = millis();
 
   // This is in case the switch is already hit.
-  M6LimitSwitch_g.loop();
-  while (M6LimitSwitch_g.isPressed())
+  update_inputs();
+  while (bitRead(InputsState_g, M6_LIMIT_INPUT))
   {
     // Read the limit switch state.
-    M6LimitSwitch_g.loop();
+    update_inputs();
 
 #if defined(ENABLE_MOTORS)
     // Run the stepper motor.
@@ -2976,11 +6123,11 @@ if (!EnableTCM_g)
 #endif // defined(ENABLE_MOTORS)
 
   // This is in case the switch is already hit.
-  M6LimitSwitch_g.loop();
-  while (!M6LimitSwitch_g.isPressed() == 1)
+  update_inputs();
+  while (!bitRead(InputsState_g, M6_LIMIT_INPUT))
   {
     // Read the limit switch state.
-    M6LimitSwitch_g.loop();
+    update_inputs();
 
 #if defined(ENABLE_MOTORS)
     // Run the stepper motor.
@@ -3031,8 +6178,8 @@ if (!EnableTCM_g)
   CurPos1 = (int16_t)stepper1.currentPosition(),
   CurPos2 = (int16_t)stepper2.currentPosition(),
   CurPos3 = (int16_t)stepper3.currentPosition(),
-  CurPos4 = (int16_t)stepper4.currentPosition(),
-  CurPos5 = (int16_t)stepper5.currentPosition(),
+  CurPos4 = (int16_t)axis_position(Axis4_t::INDEX),
+  CurPos5 = (int16_t)axis_position(Axis5_t::INDEX),
   CurPos6 = (int16_t)stepper6.currentPosition(),
 #endif // defined(ENABLE_MOTORS)
 
@@ -3053,12 +6200,302 @@ if (!EnableTCM_g)
 }
 
 /**
- * @brief 221 / 228 Reset Command F.6 (@RESET)
+ * @brief Read Command with the extended telemetry (@READX)
+ *
+ * Time [us], the six positions [steps], the six speeds [steps/s, fixed
+ * point with TELEMETRY_SPEED_SHIFT fraction bits], the motor state, the
+ * inputs, the valid axises and the flags, the same as the SUPER frame.
+ *
+ * @param args
+ * @param response
+ */
+void cmd_readx(CommandParser_t::Argument *args, char *response)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableTCM_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+  Telemetry_t TelemetryL;
+  read_telemetry(TelemetryL);
+
+  const int32_t *P = TelemetryL.Position;
+  const int32_t *S = TelemetryL.Speed;
+  snprintf(response,
+           CommandParser_t::MAX_RESPONSE_SIZE,
+           "\r\n%lu, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %u, %u, %u, %u\r\n",
+           (unsigned long)TelemetryL.Time,
+           (long)P[0], (long)P[1], (long)P[2], (long)P[3], (long)P[4], (long)P[5],
+           (long)S[0], (long)S[1], (long)S[2], (long)S[3], (long)S[4], (long)S[5],
+           TelemetryL.MotorState,
+           TelemetryL.Inputs,
+           TelemetryL.Valid,
+           TelemetryL.Flags);
+}
+
+/**
+ * @brief 221 / 228 Reset Command F.6 (@RESET)
+ *
+ * @param args
+ * @param response
+ */
+void cmd_reset(CommandParser_t::Argument *args, char *response)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableTCM_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+#if defined(ENABLE_MOTORS)
+  // Clear software way the homed position.
+  ClearAxisAction ClearL;
+  Axises_t::each(ClearL);
+#endif // defined(ENABLE_MOTORS)
+
+  snprintf(response,
+           CommandParser_t::MAX_RESPONSE_SIZE,
+           "\r\nOK\r\n");
+}
+
+/**
+ * @brief 221 / 228 Set Command F.6 (@SET)
+ *
+ * @param args
+ * @param response
+ */
+void cmd_set(CommandParser_t::Argument *args, char *response)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableTCM_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+  // DEBUGLOG("Set the robot\r\n");
+  MotorsSpeed_g = args[0].asDouble;
+  snprintf(response,
+           CommandParser_t::MAX_RESPONSE_SIZE,
+           "\r\nOK\r\n");
+}
+
+/**
+ * @brief 221 / 228 Set Command F.6 (@STEP)
+ *
+ * @param args
+ * @param response
+ */
+void cmd_step(CommandParser_t::Argument *args, char *response)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableTCM_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+  // DEBUGLOG("@STEP ");
+  // DEBUGLOG("D: %d ", (int32_t)args[0].asDouble);
+  // DEBUGLOG("J1: %d ", (int32_t)args[1].asDouble);
+  // DEBUGLOG("J2: %d ", (int32_t)args[2].asDouble);
+  // DEBUGLOG("J3: %d ", (int32_t)args[3].asDouble);
+  // DEBUGLOG("J4: %d ", (int32_t)args[4].asDouble);
+  // DEBUGLOG("J5: %d ", (int32_t)args[5].asDouble);
+  // DEBUGLOG("J6: %d ", (int32_t)args[6].asDouble);
+  MotorsSpeed_g = args[0].asDouble;
+
+#if defined(ENABLE_MOTORS)
+  JointPosition_t TargetL;
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    // The first argument is the speed.
+    joint_position(TargetL, index) = (int16_t)args[index + 1].asDouble;
+  }
+
+  journal_motion();
+  StepAxisAction StepL = {(float)MotorsSpeed_g, TargetL};
+  Axises_t::each(StepL);
+#if defined(ENABLE_WRIST_TRANSFORM)
+  sync_wrist(stepper4.distanceToGo(), stepper5.distanceToGo());
+#endif // defined(ENABLE_WRIST_TRANSFORM)
+
+  OperationMode_g = OperationModes::Positioning;
+
+  enable_drivers(true);
+#endif // defined(ENABLE_MOTORS)
+
+#if defined(ENABLE_WDT)
+    feed_wdt();
+#endif // ENABLE_WDT
+
+  snprintf(response,
+           CommandParser_t::MAX_RESPONSE_SIZE,
+           "\r\nOK\r\n");
+  // DEBUGLOG("DOs %d\r\n", (int32_t)args[7].asDouble);
+}
+
+#if defined(ENABLE_COORDINATED_MOTION)
+/**
+ * @brief Coordinated variant of @STEP (@STEPC)
+ *
+ * The arguments are the same as @STEP, the speed limits every axis
+ * and all of them arrive together.
+ *
+ * @param args
+ * @param response
+ */
+void cmd_stepc(CommandParser_t::Argument *args, char *response)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableTCM_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+  if (MotorState_g != 0)
+  {
+    snprintf(response,
+             CommandParser_t::MAX_RESPONSE_SIZE,
+             "\r\nBUSY\r\n");
+    return;
+  }
+
+  MotorsSpeed_g = args[0].asDouble;
+
+  JointPosition_t TargetL;
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    // The first argument is the speed.
+    joint_position(TargetL, index) = (int16_t)args[index + 1].asDouble;
+    joint_speed(TargetL, index) = (int16_t)MotorsSpeed_g;
+  }
+
+  enable_drivers(true);
+
+  // Planned duration of the move. [ms]
+  unsigned long DurationL = 0;
+  if (move_coordinated(TargetL))
+  {
+    DurationL = (unsigned long)(Coordinated_g.duration() * 1000.0F + 0.5F);
+  }
+
+#if defined(ENABLE_WDT)
+    feed_wdt();
+#endif // ENABLE_WDT
+
+  snprintf(response,
+           CommandParser_t::MAX_RESPONSE_SIZE,
+           "\r\nOK %lu\r\n",
+           DurationL);
+}
+#endif // defined(ENABLE_COORDINATED_MOTION)
+
+#if defined(ENABLE_KINEMATICS)
+/**
+ * @brief Read the pose of the tool (@POSE)
+ *
+ * The response is X, Y, Z [mm], the pitch and the roll [deg].
+ *
+ * @param args
+ * @param response
+ */
+void cmd_pose(CommandParser_t::Argument *args, char *response)
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#if defined(ENABLE_FEATURES_FLAGS)
+// If the flag is false.
+if (!EnableTCM_g)
+{
+  // Print cancel execution message.
+  DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
+  // Exit from the function.
+  return;
+}
+#endif // defined(ENABLE_FEATURES_FLAGS)
+
+  const KinematicsPose &PoseL = read_pose();
+
+  snprintf(response,
+           CommandParser_t::MAX_RESPONSE_SIZE,
+           "\r\n%.2f, %.2f, %.2f, %.2f, %.2f\r\n",
+           PoseL.X,
+           PoseL.Y,
+           PoseL.Z,
+           PoseL.Pitch,
+           PoseL.Roll);
+}
+#endif // defined(ENABLE_KINEMATICS)
+
+#if defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
+/**
+ * @brief Start the homing of all axises with a limit switch (HOME)
+ *
+ * The homing runs from the main loop, @HOMING reads its progress.
  *
  * @param args
  * @param response
  */
-void cmd_reset(CommandParser_t::Argument *args, char *response)
+void cmd_home(CommandParser_t::Argument *args, char *response)
 {
 #if defined(SHOW_FUNC_NAMES_S)
   DEBUGLOG("\r\n");
@@ -3077,15 +6514,25 @@ if (!EnableTCM_g)
 }
 #endif // defined(ENABLE_FEATURES_FLAGS)
 
-#if defined(ENABLE_MOTORS)
-  // Clear software way the homed position.
-  stepper1.setCurrentPosition(0);
-  stepper2.setCurrentPosition(0);
-  stepper3.setCurrentPosition(0);
-  stepper4.setCurrentPosition(0);
-  stepper5.setCurrentPosition(0);
-  stepper6.setCurrentPosition(0);
-#endif // defined(ENABLE_MOTORS)
+  if ((MotorState_g != 0) || Homing_g.isRunning())
+  {
+    snprintf(response,
+             CommandParser_t::MAX_RESPONSE_SIZE,
+             "\r\nBUSY\r\n");
+    return;
+  }
+
+  if (!start_homing(Axises_t::BITS))
+  {
+    snprintf(response,
+             CommandParser_t::MAX_RESPONSE_SIZE,
+             "\r\nERROR\r\n");
+    return;
+  }
+
+#if defined(ENABLE_WDT)
+    feed_wdt();
+#endif // ENABLE_WDT
 
   snprintf(response,
            CommandParser_t::MAX_RESPONSE_SIZE,
@@ -3093,12 +6540,16 @@ if (!EnableTCM_g)
 }
 
 /**
- * @brief 221 / 228 Set Command F.6 (@SET)
+ * @brief Read the progress of the homing (@HOMING)
+ *
+ * The response is the state, the axises of the homing, the homed axises,
+ * the axises out of time and the axises that missed their known zero,
+ * bit per axis index.
  *
  * @param args
  * @param response
  */
-void cmd_set(CommandParser_t::Argument *args, char *response)
+void cmd_homing(CommandParser_t::Argument *args, char *response)
 {
 #if defined(SHOW_FUNC_NAMES_S)
   DEBUGLOG("\r\n");
@@ -3117,20 +6568,27 @@ if (!EnableTCM_g)
 }
 #endif // defined(ENABLE_FEATURES_FLAGS)
 
-  // DEBUGLOG("Set the robot\r\n");
-  MotorsSpeed_g = args[0].asDouble;
   snprintf(response,
            CommandParser_t::MAX_RESPONSE_SIZE,
-           "\r\nOK\r\n");
+           "\r\n%d, %d, %d, %d, %d\r\n",
+           Homing_g.state(),
+           Homing_g.axises(),
+           Homing_g.homed(),
+           Homing_g.failed(),
+           Homing_g.missed());
 }
+#endif // defined(ENABLE_LIMITS) && defined(ENABLE_MOTORS)
 
+#if defined(ENABLE_ESTOP)
 /**
- * @brief 221 / 228 Set Command F.6 (@STEP)
+ * @brief Clear the E-Stop fault (@ESRESET)
+ *
+ * ERROR while the E-Stop is still active.
  *
  * @param args
  * @param response
  */
-void cmd_step(CommandParser_t::Argument *args, char *response)
+void cmd_estop_reset(CommandParser_t::Argument *args, char *response)
 {
 #if defined(SHOW_FUNC_NAMES_S)
   DEBUGLOG("\r\n");
@@ -3149,45 +6607,19 @@ if (!EnableTCM_g)
 }
 #endif // defined(ENABLE_FEATURES_FLAGS)
 
-  // DEBUGLOG("@STEP ");
-  // DEBUGLOG("D: %d ", (int32_t)args[0].asDouble);
-  // DEBUGLOG("J1: %d ", (int32_t)args[1].asDouble);
-  // DEBUGLOG("J2: %d ", (int32_t)args[2].asDouble);
-  // DEBUGLOG("J3: %d ", (int32_t)args[3].asDouble);
-  // DEBUGLOG("J4: %d ", (int32_t)args[4].asDouble);
-  // DEBUGLOG("J5: %d ", (int32_t)args[5].asDouble);
-  // DEBUGLOG("J6: %d ", (int32_t)args[6].asDouble);
-  MotorsSpeed_g = args[0].asDouble;
-
-#if defined(ENABLE_MOTORS)
-  stepper1.setSpeed(MotorsSpeed_g);
-  stepper2.setSpeed(MotorsSpeed_g);
-  stepper3.setSpeed(MotorsSpeed_g);
-  stepper4.setSpeed(MotorsSpeed_g);
-  stepper5.setSpeed(MotorsSpeed_g);
-  stepper6.setSpeed(MotorsSpeed_g);
-
-  stepper1.moveTo(args[1].asDouble);
-  stepper2.moveTo(args[2].asDouble);
-  stepper3.moveTo(args[3].asDouble);
-  stepper4.moveTo(args[4].asDouble);
-  stepper5.moveTo(args[5].asDouble);
-  stepper6.moveTo(args[6].asDouble);
-
-  OperationMode_g = OperationModes::Positioning;
-
-  enable_drivers(true);
-#endif // defined(ENABLE_MOTORS)
-
-#if defined(ENABLE_WDT)
-    feed_wdt();
-#endif // ENABLE_WDT
+  if (!reset_estop())
+  {
+    snprintf(response,
+             CommandParser_t::MAX_RESPONSE_SIZE,
+             "\r\nERROR\r\n");
+    return;
+  }
 
   snprintf(response,
            CommandParser_t::MAX_RESPONSE_SIZE,
            "\r\nOK\r\n");
-  // DEBUGLOG("DOs %d\r\n", (int32_t)args[7].asDouble);
 }
+#endif // defined(ENABLE_ESTOP)
 #endif // defined(ENABLE_TCM_COMMANDS)
 
 #if defined(ENABLE_WDT)
@@ -3226,6 +6658,9 @@ if (!EnableWDT_g)
 
   // Feed the watchdog  timer.
   WatchDogCounter_g = WDT_TIMEOUT;
+
+  // No WDT stop.
+  WatchDogStop_g = false;
 }
 
 /**
@@ -3261,6 +6696,15 @@ if (!EnableWDT_g)
       WatchDogCounter_g--;
     }
   }
+
+#if defined(ENABLE_MOTORS) && defined(WDT_STOP_DISABLE)
+  // The drivers are disabled only after the deceleration.
+  if (WatchDogStop_g && (MotorsEnabled_g == true) && (MotorState_g == 0))
+  {
+    DEBUGLOG("WDT STOPPED, DRIVERS DISABLED...\r\n");
+    enable_drivers(false);
+  }
+#endif // defined(ENABLE_MOTORS) && defined(WDT_STOP_DISABLE)
 }
 
 /**
@@ -3310,12 +6754,88 @@ if (!EnableWDT_g)
   // Print cancel execution message.
   // DEBUGLOG("Cancel execution: %s\r\n", __PRETTY_FUNCTION__);
   // Exit from the function.
-  return;
+  return false;
 }
 #endif // defined(ENABLE_FEATURES_FLAGS)
 
   return (bool)(WatchDogCounter_g <= 0);
 }
+
+/**
+ * @brief Stop the motion with the deceleration of the axises, on the WDT expiration.
+ *
+ * The drivers stay enabled, so the axises hold and the positions stay valid.
+ * With WDT_STOP_DISABLE the drivers are disabled by update_wdt() when the
+ * axises stopped.
+ */
+void wdt_stop()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  WatchDogStop_g = true;
+
+#if defined(ENABLE_MOTORS)
+  // The planned motion is dropped, the axises stop from where they are.
+#if defined(ENABLE_MOTION_QUEUE)
+  MotionQueue_g.clear();
+#endif // defined(ENABLE_MOTION_QUEUE)
+#if defined(ENABLE_COORDINATED_MOTION)
+  Coordinated_g.stop();
+#endif // defined(ENABLE_COORDINATED_MOTION)
+#if defined(ENABLE_PVT_STREAM)
+  Pvt_g.stop();
+#endif // defined(ENABLE_PVT_STREAM)
+#if defined(ENABLE_LINEAR_MOVE)
+  Linear_g.stop();
+#endif // defined(ENABLE_LINEAR_MOVE)
+#if defined(ENABLE_LIMITS)
+  stop_homing();
+#endif // defined(ENABLE_LIMITS)
+#if defined(ENABLE_SHMR)
+  stop_gripper();
+#endif // defined(ENABLE_SHMR)
+
+  if (OperationMode_g == OperationModes::Speed)
+  {
+    // The speed mode ramps down to zero with the axis acceleration.
+    for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+    {
+      set_axis_speed(index, 0.0F);
+    }
+  }
+  else
+  {
+    StopAxisAction StopL;
+    Axises_t::each(StopL);
+  }
+#endif // defined(ENABLE_MOTORS)
+}
+
+/**
+ * @brief Continue after the WDT stop, the positions are kept.
+ *
+ */
+void wdt_resume()
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  WatchDogStop_g = false;
+
+#if defined(ENABLE_MOTORS)
+  if (MotorsEnabled_g == false)
+  {
+    enable_drivers(true);
+  }
+#endif // defined(ENABLE_MOTORS)
+}
 #endif // defined(ENABLE_WDT)
 
 #if defined(ENABLE_STATUS_LCD)
@@ -3541,10 +7061,9 @@ void setMotorsSpeed(float motorSpeed_[])
   DEBUGLOG(__PRETTY_FUNCTION__);
   DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
-  stepper1.setSpeed(motorSpeed_[0]);
-  stepper2.setSpeed(motorSpeed_[1]);
-  stepper4.setSpeed(motorSpeed_[3]);
-  stepper6.setSpeed(motorSpeed_[4]);
+  journal_motion();
+  SHMRSpeedAxisAction SpeedL = {motorSpeed_, 0};
+  SHMRAxises_t::each(SpeedL);
 }
 
 void ResetGripper()
@@ -3556,16 +7075,24 @@ void ResetGripper()
   oldA3 = 0;
 }
 
-void sendTaskToSteppers(float a1, float a2, float a3, float a6)
+bool sendTaskToSteppers(float a1, float a2, float a3, float a6)
 {
 #if defined(SHOW_FUNC_NAMES)
   DEBUGLOG("\r\n");
   DEBUGLOG(__PRETTY_FUNCTION__);
   DEBUGLOG("\r\n");
 #endif                                                                             // SHOW_FUNC_NAMES
+  // The gripper job owns the gripper until it ends.
+  if (GripperJob_g != GripperJobs::Idle)
+  {
+    return false;
+  }
+
   a6 = a6 * S6;                                                                    // перевод расстояния между губками (мм) в количество шагов
+#if !defined(ENABLE_JOINT_COUPLING)
   a6_offset_a2_a3_ = a6_offset_a2_a3_ + S6A2 * (a2 - oldA2) + S6A3 * (a3 - oldA3); // поправка для сжатия схвата//??для нуля слишком большие цифры
   a6 = a6 + a6_offset_a2_a3_;
+#endif // !defined(ENABLE_JOINT_COUPLING)
   oldA2 = a2;
   oldA3 = a3;
 
@@ -3573,7 +7100,31 @@ void sendTaskToSteppers(float a1, float a2, float a3, float a6)
   positions_[1] = round(a2 * S2);
   positions_[2] = round(a3 * S3);
   positions_[3] = round(a6);
-  steppers.moveTo(positions_);
+  move_synchronized(positions_);
+
+  return true;
+}
+
+void move_synchronized(const long *targets)
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  SHMRPlanAxisAction PlanL = {targets, 0, 0.0F, 0.0F};
+  SHMRAxises_t::each(PlanL);
+  if (PlanL.SpeedPerStep == 0.0F)
+  {
+    // Already there.
+    return;
+  }
+
+  journal_motion();
+  SHMRMoveAxisAction MoveL = {targets, 0, PlanL.SpeedPerStep, PlanL.AccelPerStep};
+  SHMRAxises_t::each(MoveL);
+  OperationMode_g = OperationModes::Synchronized;
 }
 
 void goToStartPositions()
@@ -3587,63 +7138,167 @@ void goToStartPositions()
   setMotorsSpeed(speeds);
 }
 
-void gripperGrip()
+/**
+ * @brief Start the gripper job with the gripper speed and acceleration.
+ *
+ * @param job Job, GripperJobs.
+ */
+void start_gripper(GripperJobs job)
+{
+  journal_motion();
+  // One locked swap, the gripper may still move.
+  set_axis_limits(stepper6, MOTOR_SPEED_6, MOTOR_ACCEL);
+  GripperJob_g = job;
+  GripperResult_g = GripperResults::Running;
+  GripperTime_g = millis();
+}
+
+/**
+ * @brief End the gripper job, the axis takes its own limits back.
+ *
+ * @param result Result, GripperResults.
+ */
+void end_gripper(GripperResults result)
+{
+  set_axis_limits(stepper6, Axis6_t::MAX_SPEED, Axis6_t::ACCEL);
+  DEBUGLOG("Gripper job %d ended: %d\r\n", (int)GripperJob_g, (int)result);
+  GripperJob_g = GripperJobs::Idle;
+  GripperResult_g = result;
+}
+
+bool gripper_closed()
+{
+  return bitRead(InputsState_g, M6_LIMIT_INPUT);
+}
+
+bool gripperGrip()
 {
 #if defined(SHOW_FUNC_NAMES)
   DEBUGLOG("\r\n");
   DEBUGLOG(__PRETTY_FUNCTION__);
   DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
-  checkLimit(4);
-  if (!mLimit_[4].currentValue) // схват разжат
+  if ((GripperJob_g != GripperJobs::Idle) || (OperationMode_g == OperationModes::Synchronized))
   {
-    stepper6.setSpeed(MOTOR_SPEED_6);
-    stepper6.setAcceleration(MOTOR_ACCEL);
-    stepper6.move(-100 * S6);
-    while (!mLimit_[4].currentValue) // закончит когда: схват сомкнулся - сработал концевик
-    {
-      stepper6.run();
-      checkLimit(4);
-    }
-    stepper6.stop(); //??
-    ResetGripper();  //----tmp----!!
+    return false;
+  }
+  if (gripper_closed()) // схват сжат
+  {
+    GripperResult_g = GripperResults::Done;
+    return true;
   }
+  // закончит когда: схват сомкнулся - сработал концевик
+  start_gripper(GripperJobs::Grip);
+  stepper6.move(-100 * S6);
+
+  return true;
 }
 
-void gripperUngrip()
+bool gripperUngrip()
 {
 #if defined(SHOW_FUNC_NAMES)
   DEBUGLOG("\r\n");
   DEBUGLOG(__PRETTY_FUNCTION__);
   DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
-  checkLimit(4);
-  if (mLimit_[4].currentValue) // схват сжат
+  if ((GripperJob_g != GripperJobs::Idle) || (OperationMode_g == OperationModes::Synchronized))
+  {
+    return false;
+  }
+  if (!gripper_closed()) // схват разжат
+  {
+    GripperResult_g = GripperResults::Done;
+    return true;
+  }
+  // закончит когда: схват разжат
+  start_gripper(GripperJobs::Ungrip);
+  stepper6.move(100 * S6);
+
+  return true;
+}
+
+bool gripperOpenTo(float a6)
+{
+#if defined(SHOW_FUNC_NAMES)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+  if ((GripperJob_g != GripperJobs::Idle) || (OperationMode_g == OperationModes::Synchronized))
+  {
+    return false;
+  }
+  start_gripper(GripperJobs::OpenTo);
+  stepper6.moveTo(a6 * S6);
+
+  return true;
+}
+
+/**
+ * @brief Advance the gripper job, called from the main loop.
+ *
+ * The grip runs until the switch is pressed, the ungrip until it is
+ * released and then spreads the jaws A6_UNGRIP_DIST more. A job that ends
+ * its move without the switch, or runs out of M6_TIMEOUT_MS, fails.
+ */
+void update_gripper()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+  if (GripperJob_g == GripperJobs::Idle)
+  {
+    return;
+  }
+
+  stepper6.run();
+
+  bool ClosedL = gripper_closed();
+  if ((GripperJob_g == GripperJobs::Grip) && ClosedL)
+  {
+    ResetGripper(); //----tmp----!!
+    end_gripper(GripperResults::Done);
+    return;
+  }
+  if ((GripperJob_g == GripperJobs::Ungrip) && !ClosedL)
   {
-    stepper6.setSpeed(MOTOR_SPEED_6);
-    stepper6.setAcceleration(MOTOR_ACCEL);
-    stepper6.move(100 * S6);
-    while (mLimit_[4].currentValue) // закончит когда: схват разжат
-    {
-      stepper6.run();
-      checkLimit(4);
-    }
-    stepper6.stop(); //??
     // еще немного пусть разожмет
     stepper6.move(A6_UNGRIP_DIST * S6);
-    stepper6.runToPosition();
+    GripperJob_g = GripperJobs::Spread;
+    return;
+  }
+  if ((GripperJob_g == GripperJobs::Spread) && (stepper6.distanceToGo() == 0))
+  {
     ResetGripper(); //----tmp----!!
+    end_gripper(GripperResults::Done);
+    return;
+  }
+  if ((GripperJob_g == GripperJobs::OpenTo) && (stepper6.distanceToGo() == 0))
+  {
+    end_gripper(GripperResults::Done);
+    return;
+  }
+
+  if ((stepper6.distanceToGo() == 0) || ((millis() - GripperTime_g) >= M6_TIMEOUT_MS))
+  {
+    DEBUGLOG("Overdue time for reaching position on axis Gripper\r\n");
+    stepper6.stop();
+    end_gripper(GripperResults::Failed);
   }
 }
 
-void gripperOpenTo(float a6)
+void stop_gripper()
 {
-  stepper6.setSpeed(MOTOR_SPEED_6);
-  stepper6.setAcceleration(MOTOR_ACCEL);
-  stepper6.moveTo(a6 * S6);
+  if (GripperJob_g == GripperJobs::Idle)
+  {
+    return;
+  }
 
-  stepper6.runToPosition();
-  // stepper6.runSpeedToPosition();
+  stepper6.stop();
+  end_gripper(GripperResults::Stopped);
 }
 
 #endif // defined(ENABLE_SHMR)
@@ -3674,6 +7329,10 @@ void init_ps4()
 
   // Clear the flag.
   PS4TimeToUpdate_g = false;
+#if defined(ENABLE_PS4_CARTESIAN)
+  // Start with the joint jog.
+  PS4Cartesian_g = false;
+#endif // defined(ENABLE_PS4_CARTESIAN)
 #if defined(ENABLE_SLEEP_MODE)
   // Feed the timer.
   PS4SleepCounter_g = PS4_SLEEP_COUNT;
@@ -3806,6 +7465,27 @@ void update_ps4()
     }
 #endif // defined(ENABLE_MOTORS)
 
+#if defined(ENABLE_PS4_CARTESIAN)
+    // Options toggles the Cartesian jog, the axises stop on the change.
+    static bool OptionsL = false;
+    if (PS4.Options() && !OptionsL)
+    {
+      PS4Cartesian_g = !PS4Cartesian_g;
+      DEBUGLOG("Cartesian jog: %d\r\n", PS4Cartesian_g);
+      for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+      {
+        set_axis_speed(index, 0);
+      }
+    }
+    OptionsL = PS4.Options();
+
+    if (PS4Cartesian_g)
+    {
+      jog_ps4_cartesian();
+      return;
+    }
+#endif // defined(ENABLE_PS4_CARTESIAN)
+
     // Base
     if (PS4.LStickX()) {
       BaseSpeedL = map(PS4.LStickX(), X_MIN, X_MAX, PRC_MAX, PRC_MIN);
@@ -3816,7 +7496,7 @@ void update_ps4()
       {
         DEBUGLOG("Left Stick X at %d\n", BaseSpeedL);
 #if defined(ENABLE_MOTORS)
-        stepper1.setSpeed(BaseSpeedL);
+        set_axis_speed(Axis1_t::INDEX, BaseSpeedL);
 #endif // defined(ENABLE_MOTORS)
 #if defined(ENABLE_SLEEP_MODE)
         PS4SleepCounter_g = PS4_SLEEP_COUNT;
@@ -3825,14 +7505,14 @@ void update_ps4()
       else
       {
 #if defined(ENABLE_MOTORS)
-        stepper1.setSpeed(0);
+        set_axis_speed(Axis1_t::INDEX, 0);
 #endif // defined(ENABLE_MOTORS)
       }
     }
     else
     {
 #if defined(ENABLE_MOTORS)
-      stepper1.setSpeed(0);
+      set_axis_speed(Axis1_t::INDEX, 0);
 #endif // defined(ENABLE_MOTORS)
     }
 
@@ -3846,7 +7526,7 @@ void update_ps4()
       {
         DEBUGLOG("Left Stick Y at %d\n", ShoulderSpeedL);
 #if defined(ENABLE_MOTORS)
-        stepper2.setSpeed(ShoulderSpeedL);
+        set_axis_speed(Axis2_t::INDEX, ShoulderSpeedL);
 #endif // defined(ENABLE_MOTORS)
 #if defined(ENABLE_SLEEP_MODE)
         PS4SleepCounter_g = PS4_SLEEP_COUNT;
@@ -3855,14 +7535,14 @@ void update_ps4()
       else
       {
 #if defined(ENABLE_MOTORS)
-        stepper2.setSpeed(0);
+        set_axis_speed(Axis2_t::INDEX, 0);
 #endif // defined(ENABLE_MOTORS)
       }
     }
     else
     {
 #if defined(ENABLE_MOTORS)
-      stepper2.setSpeed(0);
+      set_axis_speed(Axis2_t::INDEX, 0);
 #endif // defined(ENABLE_MOTORS)
     }
 
@@ -3882,8 +7562,8 @@ void update_ps4()
       // DEBUGLOG("Stick X: %d; Y: %d\r\n", RL, PL);
 
       // Mix throttle and direction
-      LDL = PL + RL;
-      RDL = PL - RL;
+      LDL = wrist_left(PL, RL);
+      RDL = wrist_right(PL, RL);
 
       if (LDL > -DEAD_SPACE_LEFT_Y && LDL < DEAD_SPACE_LEFT_Y)
       {
@@ -3895,14 +7575,14 @@ void update_ps4()
         RDL = 0;
       }
 
-      DEBUGLOG("Differential L: %d; R: %d\r\n", LDL, -RDL);
+      DEBUGLOG("Differential L: %d; R: %d\r\n", LDL, RDL);
 
 #if defined(ENABLE_MOTORS)
       // Stop Elbow and Gripper if DF axis is running.
-      stepper4.setSpeed(LDL);
-      stepper5.setSpeed(-RDL);
-      stepper3.setSpeed(0);
-      stepper6.setSpeed(0);
+      set_axis_speed(Axis4_t::INDEX, LDL);
+      set_axis_speed(Axis5_t::INDEX, RDL);
+      set_axis_speed(Axis3_t::INDEX, 0);
+      set_axis_speed(Axis6_t::INDEX, 0);
 #endif // defined(ENABLE_MOTORS)
 #if defined(ENABLE_SLEEP_MODE)
       PS4SleepCounter_g = PS4_SLEEP_COUNT;
@@ -3919,8 +7599,11 @@ void update_ps4()
       {
         DEBUGLOG("Right Stick Y at %d\n", PS4.RStickY());
 #if defined(ENABLE_MOTORS)
-        stepper3.setSpeed(-ElbowSpeedL);
-        stepper6.setSpeed(ElbowSpeedL);
+        set_axis_speed(Axis3_t::INDEX, -ElbowSpeedL);
+#if !defined(ENABLE_JOINT_COUPLING)
+        // The coupling moves the gripper with the elbow.
+        set_axis_speed(Axis6_t::INDEX, ElbowSpeedL);
+#endif // !defined(ENABLE_JOINT_COUPLING)
 #endif // defined(ENABLE_MOTORS)
 #if defined(ENABLE_SLEEP_MODE)
         PS4SleepCounter_g = PS4_SLEEP_COUNT;
@@ -3929,13 +7612,13 @@ void update_ps4()
       else
       {
 #if defined(ENABLE_MOTORS)
-        stepper3.setSpeed(0);
-        stepper6.setSpeed(0);
+        set_axis_speed(Axis3_t::INDEX, 0);
+        set_axis_speed(Axis6_t::INDEX, 0);
 #endif // defined(ENABLE_MOTORS)
       }
 #if defined(ENABLE_MOTORS)
-      stepper4.setSpeed(0);
-      stepper5.setSpeed(0);
+      set_axis_speed(Axis4_t::INDEX, 0);
+      set_axis_speed(Axis5_t::INDEX, 0);
 #endif // defined(ENABLE_MOTORS)
     }
 
@@ -3952,7 +7635,7 @@ void update_ps4()
       {
 #if defined(ENABLE_MOTORS)
         GripperSpeedL = constrain(GripperSpeedL, -M6_MAX_SPEED, M6_MAX_SPEED);
-        stepper6.setSpeed(GripperSpeedL);
+        set_axis_speed(Axis6_t::INDEX, GripperSpeedL);
 #endif // defined(ENABLE_MOTORS)
 #if defined(ENABLE_SLEEP_MODE)
         PS4SleepCounter_g = PS4_SLEEP_COUNT;
@@ -3961,7 +7644,7 @@ void update_ps4()
       else
       {
 #if defined(ENABLE_MOTORS)
-        stepper6.setSpeed(0);
+        set_axis_speed(Axis6_t::INDEX, 0);
 #endif // defined(ENABLE_MOTORS)
       }
     }
@@ -3975,5 +7658,125 @@ void update_ps4()
     // DEBUGLOG("Battery Level : %d\n", PS4.Battery());
   }
 }
+
+#if defined(ENABLE_PS4_CARTESIAN)
+/**
+ * @brief Jog the tool in X, Y, Z, pitch and roll with the sticks.
+ *
+ * Left stick Y is X and left stick X is Y. Right stick Y is Z, or with R1
+ * held the right stick is the pitch and the roll. The joint speeds come
+ * from the Jacobian on the current angles at every PS4 update, all of them
+ * are scaled down together when one is over its maximum speed.
+ */
+void jog_ps4_cartesian()
+{
+#if defined(SHOW_FUNC_NAMES_S)
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif
+
+  long XL = map(PS4.LStickY(), Y_MIN, Y_MAX, PRC_MIN, PRC_MAX);
+  long YL = map(PS4.LStickX(), X_MIN, X_MAX, PRC_MAX, PRC_MIN);
+  long ZL = 0;
+  long PL = 0;
+  long RL = 0;
+  if (PS4.R1())
+  {
+    PL = map(PS4.RStickY(), Y_MIN, Y_MAX, PRC_MIN, PRC_MAX);
+    RL = map(PS4.RStickX(), X_MIN, X_MAX, PRC_MIN, PRC_MAX);
+  }
+  else
+  {
+    ZL = map(PS4.RStickY(), Y_MIN, Y_MAX, PRC_MIN, PRC_MAX);
+  }
+
+  if ((XL > -DEAD_SPACE_LEFT_Y) && (XL < DEAD_SPACE_LEFT_Y))
+  {
+    XL = 0;
+  }
+  if ((YL > -DEAD_SPACE_LEFT_X) && (YL < DEAD_SPACE_LEFT_X))
+  {
+    YL = 0;
+  }
+  if ((ZL > -DEAD_SPACE_RIGHT_Y) && (ZL < DEAD_SPACE_RIGHT_Y))
+  {
+    ZL = 0;
+  }
+  if ((PL > -DEAD_SPACE_RIGHT_Y) && (PL < DEAD_SPACE_RIGHT_Y))
+  {
+    PL = 0;
+  }
+  if ((RL > -DEAD_SPACE_RIGHT_X) && (RL < DEAD_SPACE_RIGHT_X))
+  {
+    RL = 0;
+  }
+
+  KinematicsPose VelocityL;
+  VelocityL.X = XL * PS4_JOG_SPEED / PRC_MAX;
+  VelocityL.Y = YL * PS4_JOG_SPEED / PRC_MAX;
+  VelocityL.Z = ZL * PS4_JOG_SPEED / PRC_MAX;
+  VelocityL.Pitch = PL * PS4_JOG_ANGULAR_SPEED / PRC_MAX;
+  VelocityL.Roll = RL * PS4_JOG_ANGULAR_SPEED / PRC_MAX;
+
+  long StepsL[KINEMATICS_JOINTS];
+  float AnglesL[KINEMATICS_JOINTS];
+  float RatesL[KINEMATICS_JOINTS];
+  float StepRatesL[KINEMATICS_JOINTS];
+  joint_steps(StepsL);
+  Kinematics_g.angles(StepsL, AnglesL);
+  Kinematics_g.inverseRate(AnglesL, VelocityL, RatesL);
+  Kinematics_g.stepRates(RatesL, StepRatesL);
+
+  float SpeedsL[Axises_t::COUNT];
+  SpeedsL[Axis1_t::INDEX] = StepRatesL[0];
+  SpeedsL[Axis2_t::INDEX] = StepRatesL[1];
+  SpeedsL[Axis3_t::INDEX] = StepRatesL[2];
+  SpeedsL[Axis4_t::INDEX] = wrist_left(StepRatesL[3], StepRatesL[4]);
+  SpeedsL[Axis5_t::INDEX] = wrist_right(StepRatesL[3], StepRatesL[4]);
+#if defined(ENABLE_JOINT_COUPLING)
+  // The coupling moves the gripper with the elbow.
+  SpeedsL[Axis6_t::INDEX] = 0.0F;
+#else
+  // The gripper follows the elbow as in the joint jog.
+  SpeedsL[Axis6_t::INDEX] = -StepRatesL[2];
+#endif // defined(ENABLE_JOINT_COUPLING)
+
+  // Gripper
+  if (PS4.L2())
+  {
+    long GripperSpeedL = map(PS4.L2Value(), 0, 255, 0, PRC_MAX);
+    if (PS4.L1())
+    {
+      GripperSpeedL *= -1;
+    }
+    if ((GripperSpeedL > DEAD_SPACE_LEFT_Y) || (GripperSpeedL < -DEAD_SPACE_LEFT_Y))
+    {
+      SpeedsL[Axis6_t::INDEX] = GripperSpeedL;
+    }
+  }
+
+  // Keep the direction of the tool, slow all joints together.
+  float RatioL = 1.0F;
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    RatioL = fmaxf(RatioL, fabsf(SpeedsL[index]) / Steppers_g[index].maxSpeed());
+  }
+
+  bool MovingL = false;
+  for (uint8_t index = 0; index < Axises_t::COUNT; index++)
+  {
+    set_axis_speed(index, SpeedsL[index] / RatioL);
+    MovingL = MovingL || (SpeedsL[index] != 0.0F);
+  }
+
+#if defined(ENABLE_SLEEP_MODE)
+  if (MovingL)
+  {
+    PS4SleepCounter_g = PS4_SLEEP_COUNT;
+  }
+#endif // defined(ENABLE_SLEEP_MODE)
+}
+#endif // defined(ENABLE_PS4_CARTESIAN)
 #endif // defined(ENABLE_PS4)
 #pragma endregion // Functions
@@ -0,0 +1,239 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <unity.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "JointCoupling.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Axis index of the elbow.
+ *
+ */
+#define ELBOW 2
+
+/**
+ * @brief Axis index of the gripper.
+ *
+ */
+#define GRIPPER 5
+
+#pragma endregion // Definitions
+
+#pragma region Variables
+
+/**
+ * @brief Positions of the motors. [steps]
+ *
+ */
+static long Motors_g[COUPLING_AXISES];
+
+#pragma endregion // Variables
+
+#pragma region Functions
+
+/**
+ * @brief One step timer period, as the firmware.
+ *
+ * @param coupling Coupling under the test.
+ * @param joint Axis index of the stepping joint, COUPLING_AXISES for none.
+ * @param forward Direction of the joint.
+ */
+static void period(JointCoupling &coupling, uint8_t joint, bool forward)
+{
+  for (uint8_t index = 0; index < COUPLING_AXISES; index++)
+  {
+    coupling.add(index, (index == joint), forward);
+  }
+
+  for (uint8_t index = 0; index < COUPLING_AXISES; index++)
+  {
+    if (coupling.follow(index) == JointCoupling::STEP)
+    {
+      Motors_g[index] += coupling.forward(index) ? 1 : -1;
+    }
+  }
+}
+
+/**
+ * @brief Let the motors take the rest of the pending steps.
+ *
+ * @param coupling Coupling under the test.
+ */
+static void settle(JointCoupling &coupling)
+{
+  for (uint16_t tick = 0; tick < 10000; tick++)
+  {
+    period(coupling, COUPLING_AXISES, true);
+  }
+}
+
+/**
+ * @brief Step the joint and let the motors settle.
+ *
+ * @param coupling Coupling under the test.
+ * @param joint Axis index of the joint.
+ * @param steps Joint steps, the sign is the direction.
+ * @param every Periods per joint step.
+ */
+static void move_joint(JointCoupling &coupling, uint8_t joint, long steps, uint8_t every)
+{
+  long CountL = labs(steps) * every;
+  for (long tick = 0; tick < CountL; tick++)
+  {
+    period(coupling, ((tick % every) == 0) ? joint : COUPLING_AXISES, (steps > 0));
+  }
+
+  settle(coupling);
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+  memset(Motors_g, 0, sizeof(Motors_g));
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief The ratios are set in range and read back.
+ *
+ */
+void test_coupling_set()
+{
+  JointCoupling CouplingL;
+  TEST_ASSERT_TRUE(CouplingL.set(GRIPPER, ELBOW, -1.0F));
+  TEST_ASSERT_FLOAT_WITHIN(1.0F / 65536.0F, -1.0F, CouplingL.ratio(GRIPPER, ELBOW));
+  TEST_ASSERT_TRUE(CouplingL.set(GRIPPER, 1, 0.3712F));
+  TEST_ASSERT_FLOAT_WITHIN(1.0F / 65536.0F, 0.3712F, CouplingL.ratio(GRIPPER, 1));
+  TEST_ASSERT_FLOAT_WITHIN(0.0F, 0.0F, CouplingL.ratio(ELBOW, GRIPPER));
+
+  // A motor is not coupled with itself, the ratios are limited.
+  TEST_ASSERT_FALSE(CouplingL.set(ELBOW, ELBOW, 1.0F));
+  TEST_ASSERT_FALSE(CouplingL.set(GRIPPER, ELBOW, 100.0F));
+  TEST_ASSERT_FALSE(CouplingL.set(COUPLING_AXISES, ELBOW, 1.0F));
+
+  CouplingL.clear();
+  TEST_ASSERT_FLOAT_WITHIN(0.0F, 0.0F, CouplingL.ratio(GRIPPER, ELBOW));
+}
+
+/**
+ * @brief Without the coupling every motor follows its joint only.
+ *
+ */
+void test_coupling_none()
+{
+  JointCoupling CouplingL;
+  move_joint(CouplingL, ELBOW, 1000, 1);
+  move_joint(CouplingL, ELBOW, -300, 1);
+
+  TEST_ASSERT_EQUAL_INT32(700, Motors_g[ELBOW]);
+  TEST_ASSERT_EQUAL_INT32(0, Motors_g[GRIPPER]);
+  TEST_ASSERT_FALSE(CouplingL.isRunning(ELBOW));
+}
+
+/**
+ * @brief The elbow steps compensate the gripper motor.
+ *
+ */
+void test_coupling_compensation()
+{
+  JointCoupling CouplingL;
+  CouplingL.set(GRIPPER, ELBOW, -1.0F);
+
+  move_joint(CouplingL, ELBOW, 1000, 2);
+  TEST_ASSERT_EQUAL_INT32(1000, Motors_g[ELBOW]);
+  TEST_ASSERT_EQUAL_INT32(-1000, Motors_g[GRIPPER]);
+
+  // A fraction of a step waits for the next joint steps.
+  CouplingL.set(GRIPPER, ELBOW, 0.37F);
+  move_joint(CouplingL, ELBOW, 1000, 2);
+  TEST_ASSERT_EQUAL_INT32(2000, Motors_g[ELBOW]);
+  TEST_ASSERT_EQUAL_INT32(-1000 + 370, Motors_g[GRIPPER]);
+  TEST_ASSERT_FALSE(CouplingL.isRunning(GRIPPER));
+
+  // Back and forth, the gripper does not drift.
+  for (uint8_t pass = 0; pass < 10; pass++)
+  {
+    move_joint(CouplingL, ELBOW, 333, 2);
+    move_joint(CouplingL, ELBOW, -333, 2);
+  }
+  TEST_ASSERT_EQUAL_INT32(2000, Motors_g[ELBOW]);
+  TEST_ASSERT_INT_WITHIN(1, -1000 + 370, Motors_g[GRIPPER]);
+}
+
+/**
+ * @brief A motor gives one step per period, the rest follows later.
+ *
+ */
+void test_coupling_rate()
+{
+  JointCoupling CouplingL;
+  CouplingL.set(GRIPPER, ELBOW, 2.0F);
+  for (uint16_t tick = 0; tick < 500; tick++)
+  {
+    period(CouplingL, ELBOW, true);
+  }
+  TEST_ASSERT_EQUAL_INT32(500, Motors_g[ELBOW]);
+  TEST_ASSERT_LESS_OR_EQUAL(500, Motors_g[GRIPPER]);
+  TEST_ASSERT_TRUE(CouplingL.isRunning(GRIPPER));
+
+  settle(CouplingL);
+  TEST_ASSERT_EQUAL_INT32(1000, Motors_g[GRIPPER]);
+
+  // Dropped pending steps are not output.
+  for (uint8_t tick = 0; tick < 100; tick++)
+  {
+    period(CouplingL, ELBOW, true);
+  }
+  TEST_ASSERT_TRUE(CouplingL.isRunning(GRIPPER));
+  CouplingL.reset();
+  TEST_ASSERT_FALSE(CouplingL.isRunning(GRIPPER));
+  long GripperL = Motors_g[GRIPPER];
+  period(CouplingL, COUPLING_AXISES, true);
+  TEST_ASSERT_EQUAL_INT32(GripperL, Motors_g[GRIPPER]);
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_coupling_set);
+  RUN_TEST(test_coupling_none);
+  RUN_TEST(test_coupling_compensation);
+  RUN_TEST(test_coupling_rate);
+
+  return UNITY_END();
+}
@@ -0,0 +1,280 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <unity.h>
+
+#include <vector>
+
+#include "EStop.h"
+#include "StepOutput.h"
+#include "TimerStepper.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Step timer period of the firmware. [us]
+ *
+ */
+#define TIMER_PERIOD_US 20
+
+/**
+ * @brief Pin bit of the step output of the axis.
+ *
+ */
+#define STEP_PIN_BIT (1ULL << 4)
+
+/**
+ * @brief Pin bit of the direction output of the axis.
+ *
+ */
+#define DIR_PIN_BIT (1ULL << 5)
+
+/**
+ * @brief Speed of the axis on the edge. [steps/s]
+ *
+ */
+#define MAX_SPEED 5000.0F
+
+/**
+ * @brief Pins of the E-Stop input and the drivers enable output.
+ *
+ */
+#define E_STOP 15
+#define PIN_ENABLE 13
+
+#pragma endregion // Definitions
+
+#pragma region Variables
+
+/**
+ * @brief Axis under the test.
+ *
+ */
+static TimerStepper *Stepper_g = NULL;
+
+/**
+ * @brief E-Stop fault latch.
+ *
+ */
+static EStop EStop_g;
+
+/**
+ * @brief Timer ticks of the step pulses.
+ *
+ */
+static std::vector<uint32_t> Steps_g;
+
+#pragma endregion // Variables
+
+#pragma region Functions
+
+/**
+ * @brief Step timer interrupt, the gate of isr_step_timer() of the firmware.
+ *
+ */
+static void isr_step_timer()
+{
+  constexpr StepOutputMask STEP_MASK = step_output_pins(STEP_PIN_BIT);
+  constexpr StepOutputMask DIR_MASK = step_output_pins(DIR_PIN_BIT);
+  StepOutput::clear(STEP_MASK);
+
+  if (EStop_g.latched())
+  {
+    return;
+  }
+
+  StepOutput OutputL;
+  OutputL.add(Stepper_g->tick(), Stepper_g->dirLevel(), STEP_MASK, DIR_MASK);
+  OutputL.write();
+
+  const StepOutputRecord &RecordL = StepOutput::records()[(StepOutput::recordsCount() - 1) % STEP_OUTPUT_RECORDS];
+  if ((RecordL.Step.Low & STEP_MASK.Low) != 0)
+  {
+    Steps_g.push_back(StepTimer::ticks());
+  }
+}
+
+/**
+ * @brief Bring the axis to its maximum speed.
+ *
+ * @param stepper Axis.
+ */
+static void start_axis(TimerStepper &stepper)
+{
+  Stepper_g = &stepper;
+  Steps_g.clear();
+  EStop::inputLevel() = 0;
+  EStop::enableLevel() = 0;
+  EStop_g.begin(E_STOP, PIN_ENABLE);
+
+  StepTimer::begin(0, TIMER_PERIOD_US, &isr_step_timer);
+  stepper.setMaxSpeed(MAX_SPEED);
+  stepper.setAcceleration(20000.0F);
+  stepper.moveTo(1000000);
+  stepper.run();
+  StepTimer::simulate(50000);
+  TEST_ASSERT_FLOAT_WITHIN(50.0F, MAX_SPEED, stepper.speed());
+}
+
+/**
+ * @brief Open the E-Stop between two timer periods.
+ *
+ * @return uint32_t Timer ticks on the edge.
+ */
+static uint32_t open_estop()
+{
+  EStop::inputLevel() = 1;
+  EStop_g.trip();
+
+  return StepTimer::ticks();
+}
+
+/**
+ * @brief Steps after the given time.
+ *
+ * @param ticks Timer ticks.
+ * @return size_t Steps count.
+ */
+static size_t steps_after(uint32_t ticks)
+{
+  size_t CountL = 0;
+  for (size_t index = 0; index < Steps_g.size(); index++)
+  {
+    if (Steps_g[index] > ticks)
+    {
+      CountL++;
+    }
+  }
+
+  return CountL;
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+  StepTimer::end();
+}
+
+/**
+ * @brief The axis on the maximum speed stops in the timer period of the edge.
+ *
+ * The edge is put on every phase of the step interval. The reaction is the
+ * time from the edge to the end of the last step pulse, a pulse ends at the
+ * start of the next timer period.
+ */
+void test_estop_reaction()
+{
+  uint32_t ReactionL = 0;
+  const uint32_t IntervalL = (uint32_t)(1000000.0F / MAX_SPEED) / TIMER_PERIOD_US;
+  for (uint32_t phase = 0; phase < IntervalL; phase++)
+  {
+    TimerStepper StepperL(TimerStepper::DRIVER, 4, 5);
+    start_axis(StepperL);
+    StepTimer::simulate(phase);
+
+    long PositionL = StepperL.currentPosition();
+    uint32_t EdgeL = open_estop();
+    TEST_ASSERT_EQUAL_UINT8(1, EStop::enableLevel());
+
+    StepTimer::simulate(1000);
+    TEST_ASSERT_EQUAL_UINT32(0, steps_after(EdgeL));
+    TEST_ASSERT_EQUAL_INT32(PositionL, StepperL.currentPosition());
+
+    uint32_t EndL = Steps_g.back() + 1;
+    uint32_t DelayL = (EndL > EdgeL) ? (EndL - EdgeL) * TIMER_PERIOD_US : 0;
+    if (DelayL > ReactionL)
+    {
+      ReactionL = DelayL;
+    }
+    StepTimer::end();
+  }
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TIMER_PERIOD_US, ReactionL);
+}
+
+/**
+ * @brief A glitch on the input, the switch reads closed in the interrupt.
+ *
+ */
+void test_estop_glitch()
+{
+  TimerStepper StepperL(TimerStepper::DRIVER, 4, 5);
+  start_axis(StepperL);
+
+  uint32_t EdgeL = StepTimer::ticks();
+  EStop_g.trip();
+  StepTimer::simulate(1000);
+
+  TEST_ASSERT_FALSE(EStop_g.latched());
+  TEST_ASSERT_EQUAL_UINT8(0, EStop::enableLevel());
+  TEST_ASSERT_TRUE(steps_after(EdgeL) > 0);
+}
+
+/**
+ * @brief The fault stays after the switch closes, until the reset.
+ *
+ */
+void test_estop_latched()
+{
+  TimerStepper StepperL(TimerStepper::DRIVER, 4, 5);
+  start_axis(StepperL);
+
+  uint32_t EdgeL = open_estop();
+  StepTimer::simulate(100);
+  TEST_ASSERT_FALSE(EStop_g.reset());
+
+  // The switch is closed again, the fault stays.
+  EStop::inputLevel() = 0;
+  StepTimer::simulate(1000);
+  TEST_ASSERT_TRUE(EStop_g.latched());
+  TEST_ASSERT_EQUAL_UINT32(0, steps_after(EdgeL));
+
+  // The loop halts the step engine on its position, as update_estop().
+  long PositionL = StepperL.currentPosition();
+  StepperL.setCurrentPosition(PositionL);
+  TEST_ASSERT_TRUE(EStop_g.reset());
+  StepTimer::simulate(1000);
+  TEST_ASSERT_EQUAL_UINT32(0, steps_after(EdgeL));
+  TEST_ASSERT_FALSE(StepperL.run());
+  TEST_ASSERT_EQUAL_INT32(PositionL, StepperL.currentPosition());
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_estop_reaction);
+  RUN_TEST(test_estop_glitch);
+  RUN_TEST(test_estop_latched);
+
+  return UNITY_END();
+}
@@ -0,0 +1,400 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <unity.h>
+
+#include <math.h>
+
+#include "Homing.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Axises of the test.
+ *
+ */
+#define AXISES 3
+
+/**
+ * @brief Main loop period of the simulation. [ms]
+ *
+ */
+#define LOOP_MS 1
+
+/**
+ * @brief Time of a phase. [ms]
+ *
+ */
+#define TIMEOUT_MS 10000
+
+/**
+ * @brief Longest simulation. [ms]
+ *
+ */
+#define SIMULATION_MS 120000
+
+/**
+ * @brief Approach of the known zero, as the firmware defaults. [steps/s] [steps/s^2]
+ *
+ */
+#define APPROACH_SPEED 200.0F
+#define APPROACH_ACCEL 75.0F
+
+/**
+ * @brief Seek and back speeds of the approach tests. [steps/s]
+ *
+ */
+#define SEEK_SPEED 100.0F
+#define BACK_SPEED 20.0F
+
+/**
+ * @brief Margin of the window. [steps]
+ *
+ */
+#define MARGIN 10
+
+#pragma endregion // Definitions
+
+#pragma region Types
+
+/**
+ * @brief Simulated axis with a limit switch.
+ *
+ */
+struct SimAxis
+{
+  double Position;     ///< Position to the last zero. [steps]
+  double Speed;        ///< Speed. [steps/s]
+  double Acceleration; ///< Acceleration. [steps/s^2]
+  double Switch;       ///< Position of the switch edge. [steps]
+  bool Negative;       ///< The switch is on the negative side.
+  double Edge;         ///< Position of the zero, on the switch edge. [steps]
+  double HitSpeed;     ///< Speed on the first press of the switch. [steps/s]
+  uint32_t Homed;      ///< Time of the zero. [ms]
+};
+
+#pragma endregion // Types
+
+#pragma region Variables
+
+/**
+ * @brief Axises of the test.
+ *
+ */
+static SimAxis Axises_g[AXISES];
+
+#pragma endregion // Variables
+
+#pragma region Functions
+
+/**
+ * @brief Set a simulated axis.
+ *
+ * @param index Axis index.
+ * @param position Position to the last zero. [steps]
+ * @param sw Position of the switch edge. [steps]
+ * @param acceleration Acceleration. [steps/s^2]
+ */
+static void set_axis(uint8_t index, double position, double sw, double acceleration)
+{
+  Axises_g[index].Position = position;
+  Axises_g[index].Speed = 0.0;
+  Axises_g[index].Acceleration = acceleration;
+  Axises_g[index].Switch = sw;
+  Axises_g[index].Negative = (sw < position);
+  Axises_g[index].Edge = NAN;
+  Axises_g[index].HitSpeed = NAN;
+  Axises_g[index].Homed = 0;
+}
+
+/**
+ * @brief Switches of the axises.
+ *
+ * @return uint8_t Pressed switches, bit per axis index.
+ */
+static uint8_t pressed()
+{
+  uint8_t PressedL = 0;
+  for (uint8_t index = 0; index < AXISES; index++)
+  {
+    const SimAxis &AxisL = Axises_g[index];
+    bool PressedAxisL = AxisL.Negative ? (AxisL.Position <= AxisL.Switch) : (AxisL.Position >= AxisL.Switch);
+    if (PressedAxisL)
+    {
+      PressedL |= (1U << index);
+    }
+  }
+
+  return PressedL;
+}
+
+/**
+ * @brief Run the homing as the main loop of the firmware.
+ *
+ * The axises run in speed mode and ramp to the speeds of the homing with
+ * their accelerations. The zero of an axis is set on the switch edge.
+ *
+ * @param homing Homing under the test.
+ * @return uint32_t Time of the homing. [ms]
+ */
+static uint32_t run_homing(Homing &homing)
+{
+  uint32_t NowL = 0;
+  for (; homing.isRunning() && (NowL < SIMULATION_MS); NowL += LOOP_MS)
+  {
+    long PositionsL[HOMING_AXISES] = {0};
+    for (uint8_t index = 0; index < AXISES; index++)
+    {
+      PositionsL[index] = lround(Axises_g[index].Position);
+    }
+
+    uint8_t PressedL = pressed();
+    uint8_t ZeroL = homing.update(PressedL, PositionsL, NowL);
+    for (uint8_t index = 0; index < AXISES; index++)
+    {
+      SimAxis &AxisL = Axises_g[index];
+      if (((PressedL & (1U << index)) != 0) && isnan(AxisL.HitSpeed))
+      {
+        AxisL.HitSpeed = fabs(AxisL.Speed);
+      }
+      if ((ZeroL & (1U << index)) != 0)
+      {
+        AxisL.Edge = AxisL.Position;
+        AxisL.Homed = NowL;
+        AxisL.Switch -= AxisL.Position;
+        AxisL.Position = 0.0;
+      }
+
+      // Speed mode, ramp to the speed of the homing.
+      const double DT = LOOP_MS / 1000.0;
+      double TargetL = homing.speed(index);
+      double StepL = AxisL.Acceleration * DT;
+      if (fabs(TargetL - AxisL.Speed) <= StepL)
+      {
+        AxisL.Speed = TargetL;
+      }
+      else
+      {
+        AxisL.Speed += (TargetL > AxisL.Speed) ? StepL : -StepL;
+      }
+      AxisL.Position += AxisL.Speed * DT;
+    }
+  }
+
+  return NowL;
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief All axises are homed at once, each on its switch edge.
+ *
+ */
+void test_homing_parallel()
+{
+  Homing HomingL;
+  HomingL.setAxis(0, -500.0F, true, 50.0F, 0, TIMEOUT_MS);
+  HomingL.setAxis(1, 500.0F, true, -50.0F, 0, TIMEOUT_MS);
+  HomingL.setAxis(2, 500.0F, true, -50.0F, 0, TIMEOUT_MS);
+  set_axis(0, 0.0, -1000.0, 2000.0);
+  set_axis(1, 0.0, 1000.0, 2000.0);
+  set_axis(2, 0.0, 1000.0, 2000.0);
+
+  TEST_ASSERT_TRUE(HomingL.begin(0x07, 0, 0));
+  uint32_t TimeL = run_homing(HomingL);
+
+  TEST_ASSERT_EQUAL_INT(Homing::HOMED, HomingL.state());
+  TEST_ASSERT_EQUAL_UINT8(0x07, HomingL.homed());
+  TEST_ASSERT_EQUAL_UINT8(0, HomingL.failed());
+  for (uint8_t index = 0; index < AXISES; index++)
+  {
+    // Zeroed on the edge at the back speed, a step of a loop.
+    TEST_ASSERT_FLOAT_WITHIN(1.0F, 0.0F, (float)Axises_g[index].Switch);
+    TEST_ASSERT_FLOAT_WITHIN(0.1F, 0.0F, HomingL.speed(index));
+  }
+
+  // At once, the time of one axis: 2.1 s to the switch, 1.5 s back from
+  // the overrun of the deceleration. One after the other it is 11 s.
+  TEST_ASSERT_LESS_THAN_UINT32(4000, TimeL);
+}
+
+/**
+ * @brief An axis waits for the axises before it.
+ *
+ */
+void test_homing_after()
+{
+  Homing HomingL;
+  HomingL.setAxis(0, -500.0F, true, 50.0F, 0, TIMEOUT_MS);
+  HomingL.setAxis(2, 500.0F, true, -50.0F, (1U << 0), TIMEOUT_MS);
+  set_axis(0, 0.0, -1000.0, 2000.0);
+  set_axis(1, 0.0, 1000.0, 2000.0);
+  set_axis(2, 0.0, 1000.0, 2000.0);
+
+  // The axis without a homing is left out.
+  TEST_ASSERT_TRUE(HomingL.begin(0x07, 0, 0));
+  TEST_ASSERT_EQUAL_UINT8(0x05, HomingL.axises());
+  run_homing(HomingL);
+
+  TEST_ASSERT_EQUAL_INT(Homing::HOMED, HomingL.state());
+  TEST_ASSERT_EQUAL_UINT8(0x05, HomingL.homed());
+  TEST_ASSERT_TRUE(Axises_g[2].Homed > (Axises_g[0].Homed + 2000));
+  TEST_ASSERT_FLOAT_WITHIN(0.5F, 0.0F, (float)Axises_g[1].Position);
+
+  // Without the axis before it, it starts at once.
+  set_axis(2, 0.0, 1000.0, 2000.0);
+  TEST_ASSERT_TRUE(HomingL.begin((1U << 2), 0, 0));
+  TEST_ASSERT_LESS_THAN_UINT32(4000, run_homing(HomingL));
+  TEST_ASSERT_EQUAL_INT(Homing::HOMED, HomingL.state());
+}
+
+/**
+ * @brief An axis out of time stops all axises.
+ *
+ */
+void test_homing_timeout()
+{
+  Homing HomingL;
+  HomingL.setAxis(0, -500.0F, true, 50.0F, 0, TIMEOUT_MS);
+  HomingL.setAxis(1, 500.0F, true, -50.0F, 0, TIMEOUT_MS);
+  set_axis(0, 0.0, -1000.0, 2000.0);
+  set_axis(1, 0.0, 1000000.0, 2000.0);
+
+  TEST_ASSERT_TRUE(HomingL.begin(0x03, 0, 0));
+  uint32_t TimeL = run_homing(HomingL);
+
+  TEST_ASSERT_EQUAL_INT(Homing::FAILED, HomingL.state());
+  TEST_ASSERT_EQUAL_UINT8(0x01, HomingL.homed());
+  TEST_ASSERT_EQUAL_UINT8(0x02, HomingL.failed());
+  TEST_ASSERT_EQUAL_UINT32(TIMEOUT_MS, TimeL - LOOP_MS);
+  TEST_ASSERT_FLOAT_WITHIN(0.1F, 0.0F, HomingL.speed(1));
+
+  // Nothing to home.
+  TEST_ASSERT_FALSE(HomingL.begin((1U << 2), 0, 0));
+  TEST_ASSERT_EQUAL_INT(Homing::IDLE, HomingL.state());
+}
+
+/**
+ * @brief The window holds the deceleration from the approach speed.
+ *
+ */
+void test_homing_window()
+{
+  Homing HomingL;
+  HomingL.setAxis(0, -SEEK_SPEED, true, BACK_SPEED, 0, SIMULATION_MS);
+  HomingL.setApproach(0, APPROACH_SPEED, MARGIN);
+  TEST_ASSERT_EQUAL_INT32(MARGIN, HomingL.window(0));
+
+  // (200^2 - 20^2) / (2 * 75) = 264 steps.
+  HomingL.setAcceleration(0, APPROACH_ACCEL);
+  TEST_ASSERT_EQUAL_INT32(264 + MARGIN, HomingL.window(0));
+
+  // Twice the acceleration, half the window.
+  HomingL.setAcceleration(0, 2.0F * APPROACH_ACCEL);
+  TEST_ASSERT_EQUAL_INT32(132 + MARGIN, HomingL.window(0));
+}
+
+/**
+ * @brief An axis with a known position approaches fast and finds the
+ * switch at the back speed.
+ *
+ */
+void test_homing_approach()
+{
+  Homing HomingL;
+  HomingL.setAxis(0, -SEEK_SPEED, true, BACK_SPEED, 0, SIMULATION_MS);
+  HomingL.setApproach(0, APPROACH_SPEED, MARGIN);
+  HomingL.setAcceleration(0, APPROACH_ACCEL);
+
+  // Full search.
+  set_axis(0, 3000.0, 0.0, APPROACH_ACCEL);
+  TEST_ASSERT_TRUE(HomingL.begin(0x01, 0, 0));
+  uint32_t SearchL = run_homing(HomingL);
+  TEST_ASSERT_EQUAL_INT(Homing::HOMED, HomingL.state());
+
+  // Approach, the window holds the deceleration to the back speed.
+  set_axis(0, 3000.0, 0.0, APPROACH_ACCEL);
+  TEST_ASSERT_TRUE(HomingL.begin(0x01, 0x01, 0));
+  uint32_t ApproachL = run_homing(HomingL);
+  TEST_ASSERT_EQUAL_INT(Homing::HOMED, HomingL.state());
+  TEST_ASSERT_EQUAL_UINT8(0, HomingL.missed());
+  TEST_ASSERT_FLOAT_WITHIN(0.1F, BACK_SPEED, (float)Axises_g[0].HitSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(1.0F, 0.0F, (float)Axises_g[0].Switch);
+  TEST_ASSERT_LESS_THAN_UINT32(SearchL * 2 / 3, ApproachL);
+
+  // A window of the margin only runs into the switch fast.
+  HomingL.setAcceleration(0, 0.0F);
+  set_axis(0, 3000.0, 0.0, APPROACH_ACCEL);
+  TEST_ASSERT_TRUE(HomingL.begin(0x01, 0x01, 0));
+  run_homing(HomingL);
+  TEST_ASSERT_GREATER_THAN_FLOAT(2.0F * BACK_SPEED, (float)Axises_g[0].HitSpeed);
+}
+
+/**
+ * @brief A switch not in the window falls back to the full search.
+ *
+ */
+void test_homing_fallback()
+{
+  Homing HomingL;
+  HomingL.setAxis(0, -SEEK_SPEED, true, BACK_SPEED, 0, SIMULATION_MS);
+  HomingL.setApproach(0, APPROACH_SPEED, MARGIN);
+  HomingL.setAcceleration(0, APPROACH_ACCEL);
+
+  // The switch moved by 300 steps.
+  set_axis(0, 3000.0, -300.0, APPROACH_ACCEL);
+  TEST_ASSERT_TRUE(HomingL.begin(0x01, 0x01, 0));
+  run_homing(HomingL);
+
+  TEST_ASSERT_EQUAL_INT(Homing::HOMED, HomingL.state());
+  TEST_ASSERT_EQUAL_UINT8(0x01, HomingL.missed());
+  TEST_ASSERT_FLOAT_WITHIN(1.0F, 0.0F, (float)Axises_g[0].Switch);
+  TEST_ASSERT_FLOAT_WITHIN(1.0F, -300.0F, (float)Axises_g[0].Edge);
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_homing_parallel);
+  RUN_TEST(test_homing_after);
+  RUN_TEST(test_homing_timeout);
+  RUN_TEST(test_homing_window);
+  RUN_TEST(test_homing_approach);
+  RUN_TEST(test_homing_fallback);
+
+  return UNITY_END();
+}
@@ -0,0 +1,282 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <unity.h>
+
+#include <math.h>
+#include <time.h>
+
+#include "Kinematics.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Link lengths of the firmware. [mm]
+ *
+ */
+#define BASE_HEIGHT 190.0F
+#define UPPER_ARM 178.0F
+#define FOREARM 178.0F
+#define TOOL 100.0F
+
+/**
+ * @brief Tolerance of the positions. [mm]
+ *
+ */
+#define POSITION_TOLERANCE 0.01F
+
+/**
+ * @brief Tolerance of the angles. [deg]
+ *
+ */
+#define ANGLE_TOLERANCE 0.01F
+
+/**
+ * @brief Poses of the timing check.
+ *
+ */
+#define BENCH_POSES 100000L
+
+/**
+ * @brief Time budget of a computed pose on the host. [us]
+ *
+ */
+#define POSE_BUDGET_US 5.0
+
+#pragma endregion // Definitions
+
+#pragma region Variables
+
+/**
+ * @brief Kinematics under the test.
+ *
+ */
+static Kinematics Kinematics_g;
+
+#pragma endregion // Variables
+
+#pragma region Functions
+
+/**
+ * @brief Check the pose.
+ *
+ * @param x Expected X. [mm]
+ * @param y Expected Y. [mm]
+ * @param z Expected Z. [mm]
+ * @param pitch Expected pitch. [deg]
+ * @param roll Expected roll. [deg]
+ * @param pose Pose to check.
+ */
+static void check_pose(float x, float y, float z, float pitch, float roll, const KinematicsPose &pose)
+{
+  TEST_ASSERT_FLOAT_WITHIN(POSITION_TOLERANCE, x, pose.X);
+  TEST_ASSERT_FLOAT_WITHIN(POSITION_TOLERANCE, y, pose.Y);
+  TEST_ASSERT_FLOAT_WITHIN(POSITION_TOLERANCE, z, pose.Z);
+  TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE, pitch, pose.Pitch);
+  TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE, roll, pose.Roll);
+}
+
+/**
+ * @brief Pose of the joint angles.
+ *
+ * @param base Base angle. [deg]
+ * @param shoulder Shoulder angle. [deg]
+ * @param elbow Elbow angle. [deg]
+ * @param pitch Wrist pitch angle. [deg]
+ * @param roll Wrist roll angle. [deg]
+ * @return KinematicsPose Tool pose.
+ */
+static KinematicsPose forward(float base, float shoulder, float elbow, float pitch, float roll)
+{
+  const float AnglesL[KINEMATICS_JOINTS] = {base, shoulder, elbow, pitch, roll};
+  KinematicsPose PoseL;
+  Kinematics_g.forward(AnglesL, PoseL);
+
+  return PoseL;
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+  // Links and joints as the firmware defaults.
+  Kinematics_g = Kinematics();
+  Kinematics_g.setLinks(BASE_HEIGHT, UPPER_ARM, FOREARM, TOOL);
+  Kinematics_g.setJoint(0, -59800.0F / 90.0F, 0.0F);
+  Kinematics_g.setJoint(1, 59200.0F / 90.0F, 90.0F);
+  Kinematics_g.setJoint(2, -36100.0F / 90.7F, -90.0F);
+  Kinematics_g.setJoint(3, 55000.0F / 90.0F, 0.0F);
+  Kinematics_g.setJoint(4, 55000.0F / 90.0F, 0.0F);
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief The tool pose of the known joint angles.
+ *
+ */
+void test_kinematics_forward()
+{
+  const float REACH = UPPER_ARM + FOREARM + TOOL;
+
+  // Stretched forward.
+  check_pose(REACH, 0.0F, BASE_HEIGHT, 0.0F, 0.0F, forward(0.0F, 0.0F, 0.0F, 0.0F, 0.0F));
+
+  // Stretched up.
+  check_pose(0.0F, 0.0F, BASE_HEIGHT + REACH, 90.0F, 0.0F, forward(0.0F, 90.0F, 0.0F, 0.0F, 0.0F));
+
+  // Upper arm up, forearm and tool forward.
+  check_pose(FOREARM + TOOL, 0.0F, BASE_HEIGHT + UPPER_ARM, 0.0F, 0.0F, forward(0.0F, 90.0F, -90.0F, 0.0F, 0.0F));
+
+  // Tool down.
+  check_pose(FOREARM, 0.0F, BASE_HEIGHT + UPPER_ARM - TOOL, -90.0F, 0.0F, forward(0.0F, 90.0F, -90.0F, -90.0F, 0.0F));
+
+  // Base turned left, the roll does not move the tool point.
+  check_pose(0.0F, REACH, BASE_HEIGHT, 0.0F, 30.0F, forward(90.0F, 0.0F, 0.0F, 0.0F, 30.0F));
+}
+
+/**
+ * @brief The pose of the joint steps, zero steps are the zero angles.
+ *
+ */
+void test_kinematics_steps()
+{
+  const long ZERO[KINEMATICS_JOINTS] = {0, 0, 0, 0, 0};
+  check_pose(FOREARM + TOOL, 0.0F, BASE_HEIGHT + UPPER_ARM, 0.0F, 0.0F, Kinematics_g.pose(ZERO));
+
+  // The base turned 90 degrees, the steps are negative.
+  const long BASE[KINEMATICS_JOINTS] = {-59800, 0, 0, 0, 0};
+  check_pose(0.0F, FOREARM + TOOL, BASE_HEIGHT + UPPER_ARM, 0.0F, 0.0F, Kinematics_g.pose(BASE));
+
+  // The steps of the angles are back the same.
+  float AnglesL[KINEMATICS_JOINTS];
+  long StepsL[KINEMATICS_JOINTS];
+  Kinematics_g.angles(BASE, AnglesL);
+  Kinematics_g.steps(AnglesL, StepsL);
+  for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+  {
+    TEST_ASSERT_EQUAL_INT32(BASE[index], StepsL[index]);
+  }
+}
+
+/**
+ * @brief The pose is computed again only after the steps change.
+ *
+ */
+void test_kinematics_cache()
+{
+  long StepsL[KINEMATICS_JOINTS] = {0, 0, 0, 0, 0};
+  const KinematicsPose &PoseL = Kinematics_g.pose(StepsL);
+  TEST_ASSERT_FLOAT_WITHIN(POSITION_TOLERANCE, FOREARM + TOOL, PoseL.X);
+
+  // Same steps, same pose.
+  const KinematicsPose &CachedL = Kinematics_g.pose(StepsL);
+  TEST_ASSERT_TRUE(&PoseL == &CachedL);
+  TEST_ASSERT_FLOAT_WITHIN(POSITION_TOLERANCE, FOREARM + TOOL, CachedL.X);
+
+  // Any joint moves, the pose follows.
+  StepsL[0] = -59800;
+  TEST_ASSERT_FLOAT_WITHIN(POSITION_TOLERANCE, 0.0F, Kinematics_g.pose(StepsL).X);
+  TEST_ASSERT_FLOAT_WITHIN(POSITION_TOLERANCE, FOREARM + TOOL, Kinematics_g.pose(StepsL).Y);
+}
+
+/**
+ * @brief The joint angles of a pose give the pose back.
+ *
+ */
+void test_kinematics_inverse()
+{
+  const float POSES[][KINEMATICS_JOINTS] = {
+      {0.0F, 90.0F, -90.0F, 0.0F, 0.0F},
+      {30.0F, 60.0F, -45.0F, -30.0F, 10.0F},
+      {-45.0F, 20.0F, -100.0F, 45.0F, -20.0F},
+      {120.0F, 45.0F, -30.0F, -60.0F, 90.0F},
+  };
+
+  for (size_t pose = 0; pose < (sizeof(POSES) / sizeof(POSES[0])); pose++)
+  {
+    KinematicsPose PoseL;
+    Kinematics_g.forward(POSES[pose], PoseL);
+
+    // Start from the zero angles, the elbow on the same side.
+    float AnglesL[KINEMATICS_JOINTS] = {0.0F, 90.0F, -90.0F, 0.0F, 0.0F};
+    TEST_ASSERT_TRUE(Kinematics_g.inverse(PoseL, AnglesL));
+    for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+    {
+      TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE, POSES[pose][index], AnglesL[index]);
+    }
+  }
+
+  // Out of reach.
+  KinematicsPose FarL = {1000.0F, 0.0F, BASE_HEIGHT, 0.0F, 0.0F};
+  float AnglesL[KINEMATICS_JOINTS] = {0.0F, 90.0F, -90.0F, 0.0F, 0.0F};
+  TEST_ASSERT_FALSE(Kinematics_g.inverse(FarL, AnglesL));
+}
+
+/**
+ * @brief A computed pose is in the budget, a cached one is faster.
+ *
+ */
+void test_kinematics_timing()
+{
+  long StepsL[KINEMATICS_JOINTS] = {0, 0, 0, 0, 0};
+  volatile float SumL = 0.0F;
+
+  clock_t StartL = clock();
+  for (long pose = 0; pose < BENCH_POSES; pose++)
+  {
+    StepsL[pose % KINEMATICS_JOINTS] += 1;
+    SumL += Kinematics_g.pose(StepsL).X;
+  }
+  double ComputedL = (double)(clock() - StartL) / CLOCKS_PER_SEC / BENCH_POSES;
+
+  StartL = clock();
+  for (long pose = 0; pose < BENCH_POSES; pose++)
+  {
+    SumL += Kinematics_g.pose(StepsL).X;
+  }
+  double CachedL = (double)(clock() - StartL) / CLOCKS_PER_SEC / BENCH_POSES;
+
+  TEST_ASSERT_LESS_THAN_FLOAT((float)(POSE_BUDGET_US / 1e6), (float)ComputedL);
+  TEST_ASSERT_LESS_THAN_FLOAT((float)ComputedL, (float)CachedL);
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_kinematics_forward);
+  RUN_TEST(test_kinematics_steps);
+  RUN_TEST(test_kinematics_cache);
+  RUN_TEST(test_kinematics_inverse);
+  RUN_TEST(test_kinematics_timing);
+
+  return UNITY_END();
+}
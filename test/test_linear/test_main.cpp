@@ -0,0 +1,321 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <unity.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "Kinematics.h"
+#include "LinearPath.h"
+#include "PvtStream.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Step timer period of the firmware. [us]
+ *
+ */
+#define TIMER_PERIOD_US 20
+
+/**
+ * @brief Time between the points of the line, as LINEAR_PERIOD_MS. [s]
+ *
+ */
+#define PERIOD 0.02F
+
+/**
+ * @brief Time of the joint speeds difference, as LINEAR_VELOCITY_DELTA_MS. [s]
+ *
+ */
+#define VELOCITY_DELTA 0.001F
+
+/**
+ * @brief Largest distance of the tool point from the line. [mm]
+ *
+ */
+#define LINE_TOLERANCE 0.1F
+
+/**
+ * @brief Tolerance of the end pose. [mm] [deg]
+ *
+ */
+#define END_TOLERANCE 0.05F
+
+#pragma endregion // Definitions
+
+#pragma region Variables
+
+/**
+ * @brief Kinematics of the arm.
+ *
+ */
+static Kinematics Kinematics_g;
+
+/**
+ * @brief Line under the test.
+ *
+ */
+static LinearPath Linear_g;
+
+/**
+ * @brief Stream of the line.
+ *
+ */
+static PvtStream Pvt_g;
+
+/**
+ * @brief Joint angles of the last solved point. [deg]
+ *
+ */
+static float LinearAngles_g[KINEMATICS_JOINTS];
+
+/**
+ * @brief Positions of the joints. [steps]
+ *
+ */
+static long Positions_g[PVT_AXISES];
+
+#pragma endregion // Variables
+
+#pragma region Functions
+
+/**
+ * @brief Joint steps of a pose.
+ *
+ * @param pose Tool pose.
+ * @param angles Joint angles near the solution in, the solution out. [deg]
+ * @param steps Joint positions. [steps]
+ * @return true Solved.
+ * @return false The pose is out of reach.
+ */
+static bool pose_steps(const KinematicsPose &pose, float *angles, long *steps)
+{
+  if (!Kinematics_g.inverse(pose, angles))
+  {
+    return false;
+  }
+
+  Kinematics_g.steps(angles, steps);
+
+  return true;
+}
+
+/**
+ * @brief Feed the points of the line to the stream, as the firmware.
+ *
+ */
+static void update_linear_move()
+{
+  while (Linear_g.isRunning() && (Pvt_g.available() > 0))
+  {
+    uint16_t PointL = Linear_g.next();
+    float TimeL = Linear_g.time(PointL);
+    KinematicsPose PoseL;
+    long StepsL[KINEMATICS_JOINTS];
+    Linear_g.sample(TimeL, PoseL);
+    TEST_ASSERT_TRUE(pose_steps(PoseL, LinearAngles_g, StepsL));
+
+    PvtPoint ValueL = {{0}, {0}, 0};
+    for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+    {
+      ValueL.Position[index] = StepsL[index];
+    }
+
+    // Joint speeds of the middle points from the poses around them.
+    if (PointL < Linear_g.points())
+    {
+      float AnglesL[KINEMATICS_JOINTS];
+      long BeforeL[KINEMATICS_JOINTS];
+      long AfterL[KINEMATICS_JOINTS];
+      memcpy(AnglesL, LinearAngles_g, sizeof(AnglesL));
+      Linear_g.sample(TimeL - VELOCITY_DELTA, PoseL);
+      TEST_ASSERT_TRUE(pose_steps(PoseL, AnglesL, BeforeL));
+      memcpy(AnglesL, LinearAngles_g, sizeof(AnglesL));
+      Linear_g.sample(TimeL + VELOCITY_DELTA, PoseL);
+      TEST_ASSERT_TRUE(pose_steps(PoseL, AnglesL, AfterL));
+      for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+      {
+        ValueL.Velocity[index] = lroundf((float)(AfterL[index] - BeforeL[index]) / (2.0F * VELOCITY_DELTA));
+      }
+    }
+
+    uint32_t DurationL = lroundf((TimeL - Linear_g.time(PointL - 1)) * 1000.0F);
+    ValueL.Duration = (DurationL > 0) ? DurationL : 1;
+    TEST_ASSERT_TRUE(Pvt_g.push(ValueL));
+    Linear_g.advance();
+  }
+}
+
+/**
+ * @brief Distance of the point from the line.
+ *
+ * @param from Start of the line.
+ * @param to End of the line.
+ * @param pose Point.
+ * @return float Distance. [mm]
+ */
+static float line_distance(const KinematicsPose &from, const KinematicsPose &to, const KinematicsPose &pose)
+{
+  float DXL = to.X - from.X;
+  float DYL = to.Y - from.Y;
+  float DZL = to.Z - from.Z;
+  float PXL = pose.X - from.X;
+  float PYL = pose.Y - from.Y;
+  float PZL = pose.Z - from.Z;
+  float RatioL = (PXL * DXL + PYL * DYL + PZL * DZL) / (DXL * DXL + DYL * DYL + DZL * DZL);
+  RatioL = fminf(fmaxf(RatioL, 0.0F), 1.0F);
+  PXL -= RatioL * DXL;
+  PYL -= RatioL * DYL;
+  PZL -= RatioL * DZL;
+
+  return sqrtf(PXL * PXL + PYL * PYL + PZL * PZL);
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+  // Links and joints as the firmware defaults.
+  Kinematics_g = Kinematics();
+  Kinematics_g.setLinks(190.0F, 178.0F, 178.0F, 100.0F);
+  Kinematics_g.setJoint(0, -59800.0F / 90.0F, 0.0F);
+  Kinematics_g.setJoint(1, 59200.0F / 90.0F, 90.0F);
+  Kinematics_g.setJoint(2, -36100.0F / 90.7F, -90.0F);
+  Kinematics_g.setJoint(3, 55000.0F / 90.0F, 0.0F);
+  Kinematics_g.setJoint(4, 55000.0F / 90.0F, 0.0F);
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief The plan of the line, a trapezoid or a triangle.
+ *
+ */
+void test_linear_plan()
+{
+  const KinematicsPose FROM = {250.0F, 0.0F, 300.0F, 0.0F, 0.0F};
+  KinematicsPose ToL = {250.0F, 300.0F, 300.0F, 0.0F, 0.0F};
+
+  // 300 mm at 100 mm/s, 0.5 s to the speed.
+  TEST_ASSERT_TRUE(Linear_g.begin(FROM, ToL, 100.0F, 200.0F, 45.0F, PERIOD));
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 3.5F, Linear_g.duration());
+  TEST_ASSERT_EQUAL_UINT32(175, Linear_g.points());
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, Linear_g.duration(), Linear_g.time(Linear_g.points()));
+
+  KinematicsPose PoseL;
+  Linear_g.sample(Linear_g.duration() / 2.0F, PoseL);
+  TEST_ASSERT_FLOAT_WITHIN(0.01F, 150.0F, PoseL.Y);
+  Linear_g.sample(Linear_g.duration(), PoseL);
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 300.0F, PoseL.Y);
+
+  // 20 mm, the speed is not reached.
+  ToL.Y = 20.0F;
+  TEST_ASSERT_TRUE(Linear_g.begin(FROM, ToL, 100.0F, 200.0F, 45.0F, PERIOD));
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 2.0F * sqrtf(20.0F / 200.0F), Linear_g.duration());
+
+  // A pure turn of the tool moves too, 90 deg at 45 deg/s.
+  ToL = FROM;
+  ToL.Roll = 90.0F;
+  TEST_ASSERT_TRUE(Linear_g.begin(FROM, ToL, 100.0F, 200.0F, 45.0F, PERIOD));
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 2.0F + 0.5F, Linear_g.duration());
+
+  // Nothing to move.
+  TEST_ASSERT_FALSE(Linear_g.begin(FROM, FROM, 100.0F, 200.0F, 45.0F, PERIOD));
+  TEST_ASSERT_FALSE(Linear_g.isRunning());
+}
+
+/**
+ * @brief The steps of the stream keep the tool on the line to the target.
+ *
+ */
+void test_linear_stream()
+{
+  const KinematicsPose FROM = {250.0F, -150.0F, 300.0F, -30.0F, 0.0F};
+  const KinematicsPose TO = {250.0F, 150.0F, 300.0F, -30.0F, 45.0F};
+
+  // Start on the first pose.
+  float AnglesL[KINEMATICS_JOINTS] = {0.0F, 90.0F, -90.0F, 0.0F, 0.0F};
+  long StepsL[KINEMATICS_JOINTS];
+  TEST_ASSERT_TRUE(pose_steps(FROM, AnglesL, StepsL));
+  memset(Positions_g, 0, sizeof(Positions_g));
+  memcpy(Positions_g, StepsL, sizeof(StepsL));
+  memcpy(LinearAngles_g, AnglesL, sizeof(LinearAngles_g));
+  const KinematicsPose StartL = Kinematics_g.pose(StepsL);
+
+  TEST_ASSERT_TRUE(Linear_g.begin(StartL, TO, 100.0F, 200.0F, 45.0F, PERIOD));
+  Pvt_g.begin(Positions_g, 1000000UL / TIMER_PERIOD_US);
+
+  const uint32_t TICKS_PER_MS = 1000 / TIMER_PERIOD_US;
+  const uint32_t MS = (uint32_t)(Linear_g.duration() * 1000.0F) + 1000;
+  float DeviationL = 0.0F;
+  for (uint32_t tick = 0; tick < (MS * TICKS_PER_MS); tick++)
+  {
+    if ((tick % TICKS_PER_MS) == 0)
+    {
+      update_linear_move();
+      Pvt_g.update();
+      DeviationL = fmaxf(DeviationL, line_distance(StartL, TO, Kinematics_g.pose(Positions_g)));
+    }
+    if (!Pvt_g.tick())
+    {
+      continue;
+    }
+    for (uint8_t index = 0; index < KINEMATICS_JOINTS; index++)
+    {
+      if (Pvt_g.follow(index) == PvtStream::STEP)
+      {
+        Positions_g[index] += Pvt_g.forward(index) ? 1 : -1;
+      }
+    }
+  }
+
+  TEST_ASSERT_FALSE(Linear_g.isRunning());
+  TEST_ASSERT_FALSE(Pvt_g.isRunning());
+  TEST_ASSERT_EQUAL_UINT32(0, Pvt_g.underruns());
+  TEST_ASSERT_LESS_THAN_FLOAT(LINE_TOLERANCE, DeviationL);
+
+  const KinematicsPose &EndL = Kinematics_g.pose(Positions_g);
+  TEST_ASSERT_FLOAT_WITHIN(END_TOLERANCE, TO.X, EndL.X);
+  TEST_ASSERT_FLOAT_WITHIN(END_TOLERANCE, TO.Y, EndL.Y);
+  TEST_ASSERT_FLOAT_WITHIN(END_TOLERANCE, TO.Z, EndL.Z);
+  TEST_ASSERT_FLOAT_WITHIN(END_TOLERANCE, TO.Pitch, EndL.Pitch);
+  TEST_ASSERT_FLOAT_WITHIN(END_TOLERANCE, TO.Roll, EndL.Roll);
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_linear_plan);
+  RUN_TEST(test_linear_stream);
+
+  return UNITY_END();
+}
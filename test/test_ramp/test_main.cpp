@@ -0,0 +1,427 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <unity.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+#include "TimerStepper.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Step timer period of the firmware. [us]
+ *
+ */
+#define TIMER_PERIOD_US 20
+
+/**
+ * @brief Largest deviation of the step times from AccelStepper, part of
+ * the first step interval sqrt(2 / a). The recurrence of AccelStepper is
+ * off most on the first and the last steps of the ramp.
+ *
+ */
+#define TIME_TOLERANCE 0.1
+
+/**
+ * @brief Axises of the benchmark, as on the robot.
+ *
+ */
+#define BENCH_AXISES 6
+
+/**
+ * @brief Steps of each axis in the benchmark.
+ *
+ */
+#define BENCH_STEPS 100000L
+
+/**
+ * @brief Largest part of the CPU for the steps of all axises at the benchmark speed.
+ *
+ */
+#define BENCH_LOAD 0.05
+
+#pragma endregion // Definitions
+
+#pragma region Variables
+
+/**
+ * @brief Axis under the test.
+ *
+ */
+static TimerStepper *Stepper_g = NULL;
+
+/**
+ * @brief Times of the steps of the axis. [s]
+ *
+ */
+static std::vector<double> Steps_g;
+
+/**
+ * @brief Axises of the benchmark.
+ *
+ */
+static TimerStepper *BenchSteppers_g = NULL;
+
+/**
+ * @brief Steps of the benchmark.
+ *
+ */
+static long BenchSteps_g = 0;
+
+#pragma endregion // Variables
+
+#pragma region Functions
+
+/**
+ * @brief Step timer callback, records the step times.
+ *
+ */
+static void isr_step_timer()
+{
+  if (Stepper_g->tick())
+  {
+    Steps_g.push_back((double)StepTimer::ticks() / (double)StepTimer::frequency());
+  }
+}
+
+/**
+ * @brief AccelStepper ramp, the float math of computeNewSpeed().
+ *
+ */
+struct AccelStepperModel
+{
+  long Target;
+  float Acceleration;
+  long Position;
+  long N;
+  float C0;
+  float Cn;
+  float Cmin;
+  bool Forward;
+
+  /**
+   * @brief Start the move from zero.
+   *
+   * @param target Target position from zero. [steps]
+   * @param maxSpeed Maximum speed. [steps/s]
+   * @param acceleration Acceleration. [steps/s^2]
+   */
+  void begin(long target, float maxSpeed, float acceleration)
+  {
+    Target = target;
+    Acceleration = acceleration;
+    Position = 0;
+    N = 0;
+    C0 = 0.676F * sqrtf(2.0F / acceleration) * 1000000.0F;
+    Cn = 0.0F;
+    Cmin = 1000000.0F / maxSpeed;
+    Forward = true;
+  }
+
+  /**
+   * @brief Plan and take the next step.
+   *
+   * @return float Interval before the step, 0 at the target. [us]
+   */
+  float step()
+  {
+    long DistanceL = Target - Position;
+    float SpeedL = (Cn > 0.0F) ? (1000000.0F / Cn) : 0.0F;
+    long StepsToStopL = (long)((SpeedL * SpeedL) / (2.0F * Acceleration));
+
+    if ((DistanceL == 0) && (StepsToStopL <= 1))
+    {
+      return 0.0F;
+    }
+
+    if (DistanceL > 0)
+    {
+      if ((N > 0) && ((StepsToStopL >= DistanceL) || !Forward))
+      {
+        N = -StepsToStopL;
+      }
+      else if ((N < 0) && (StepsToStopL < DistanceL) && Forward)
+      {
+        N = -N;
+      }
+    }
+    else if (DistanceL < 0)
+    {
+      if ((N > 0) && ((StepsToStopL >= -DistanceL) || Forward))
+      {
+        N = -StepsToStopL;
+      }
+      else if ((N < 0) && (StepsToStopL < -DistanceL) && !Forward)
+      {
+        N = -N;
+      }
+    }
+
+    if (N == 0)
+    {
+      Cn = C0;
+      Forward = (DistanceL > 0);
+    }
+    else
+    {
+      Cn = Cn - ((2.0F * Cn) / ((4.0F * N) + 1.0F));
+      if (Cn < Cmin)
+      {
+        Cn = Cmin;
+      }
+    }
+    N++;
+
+    Position += Forward ? 1 : -1;
+    return Cn;
+  }
+};
+
+/**
+ * @brief Step times of AccelStepper.
+ *
+ * @param target Target position from zero. [steps]
+ * @param maxSpeed Maximum speed. [steps/s]
+ * @param acceleration Acceleration. [steps/s^2]
+ * @return std::vector<double> Step times. [s]
+ */
+static std::vector<double> accel_stepper_steps(long target, float maxSpeed, float acceleration)
+{
+  std::vector<double> StepsL;
+  AccelStepperModel ModelL;
+  ModelL.begin(target, maxSpeed, acceleration);
+  double TimeL = 0.0;
+  for (float IntervalL = ModelL.step(); IntervalL > 0.0F; IntervalL = ModelL.step())
+  {
+    TimeL += IntervalL / 1000000.0;
+    StepsL.push_back(TimeL);
+  }
+
+  return StepsL;
+}
+
+/**
+ * @brief Run the move on the step engine and compare it with AccelStepper.
+ *
+ * @param target Target position from zero. [steps]
+ * @param maxSpeed Maximum speed. [steps/s]
+ * @param acceleration Acceleration. [steps/s^2]
+ */
+static void check_move(long target, float maxSpeed, float acceleration)
+{
+  TimerStepper StepperL(TimerStepper::DRIVER, 1, 2);
+  Stepper_g = &StepperL;
+  Steps_g.clear();
+
+  StepTimer::begin(0, TIMER_PERIOD_US, &isr_step_timer);
+  StepperL.setMaxSpeed(maxSpeed);
+  StepperL.setAcceleration(acceleration);
+  StepperL.moveTo(target);
+  while (StepperL.run())
+  {
+    StepTimer::simulate(50);
+  }
+  StepTimer::end();
+
+  std::vector<double> ReferenceL = accel_stepper_steps(target, maxSpeed, acceleration);
+
+  TEST_ASSERT_EQUAL_INT32(target, StepperL.currentPosition());
+  TEST_ASSERT_EQUAL_UINT32(ReferenceL.size(), Steps_g.size());
+
+  // Both start on the first step.
+  double DeviationL = 0.0;
+  for (size_t index = 1; (index < ReferenceL.size()) && (index < Steps_g.size()); index++)
+  {
+    double DeltaL = fabs((Steps_g[index] - Steps_g[0]) - (ReferenceL[index] - ReferenceL[0]));
+    if (DeltaL > DeviationL)
+    {
+      DeviationL = DeltaL;
+    }
+  }
+  TEST_ASSERT_LESS_THAN_FLOAT(TIME_TOLERANCE * sqrtf(2.0F / acceleration), (float)DeviationL);
+}
+
+/**
+ * @brief Step timer callback of the benchmark, all axises as the firmware.
+ *
+ */
+static void isr_bench_timer()
+{
+  for (uint8_t index = 0; index < BENCH_AXISES; index++)
+  {
+    if (BenchSteppers_g[index].tick())
+    {
+      BenchSteps_g++;
+    }
+  }
+}
+
+/**
+ * @brief CPU time of the step engine for the benchmark moves.
+ *
+ * @param maxSpeed Maximum speed. [steps/s]
+ * @param acceleration Acceleration. [steps/s^2]
+ * @return double CPU time per step. [s]
+ */
+static double bench_timer_stepper(float maxSpeed, float acceleration)
+{
+  TimerStepper SteppersL[BENCH_AXISES];
+  BenchSteppers_g = SteppersL;
+  BenchSteps_g = 0;
+
+  StepTimer::begin(0, TIMER_PERIOD_US, &isr_bench_timer);
+  for (uint8_t index = 0; index < BENCH_AXISES; index++)
+  {
+    SteppersL[index].setMaxSpeed(maxSpeed);
+    SteppersL[index].setAcceleration(acceleration);
+    SteppersL[index].moveTo(BENCH_STEPS);
+  }
+  clock_t StartL = clock();
+  for (bool MovingL = true; MovingL;)
+  {
+    MovingL = false;
+    for (uint8_t index = 0; index < BENCH_AXISES; index++)
+    {
+      MovingL = SteppersL[index].run() || MovingL;
+    }
+    StepTimer::simulate(50);
+  }
+  clock_t TimeL = clock() - StartL;
+  StepTimer::end();
+
+  TEST_ASSERT_EQUAL_INT32(BENCH_AXISES * BENCH_STEPS, BenchSteps_g);
+  return (double)TimeL / CLOCKS_PER_SEC / (double)BenchSteps_g;
+}
+
+/**
+ * @brief CPU time of the AccelStepper ramp for the benchmark moves.
+ *
+ * Only the ramp of each step is counted, not the polls of run().
+ *
+ * @param maxSpeed Maximum speed. [steps/s]
+ * @param acceleration Acceleration. [steps/s^2]
+ * @return double CPU time per step. [s]
+ */
+static double bench_accel_stepper(float maxSpeed, float acceleration)
+{
+  AccelStepperModel ModelsL[BENCH_AXISES];
+  for (uint8_t index = 0; index < BENCH_AXISES; index++)
+  {
+    ModelsL[index].begin(BENCH_STEPS, maxSpeed, acceleration);
+  }
+
+  long StepsL = 0;
+  volatile float SumL = 0.0F;
+  clock_t StartL = clock();
+  for (bool MovingL = true; MovingL;)
+  {
+    MovingL = false;
+    for (uint8_t index = 0; index < BENCH_AXISES; index++)
+    {
+      float IntervalL = ModelsL[index].step();
+      if (IntervalL > 0.0F)
+      {
+        SumL = SumL + IntervalL;
+        StepsL++;
+        MovingL = true;
+      }
+    }
+  }
+  clock_t TimeL = clock() - StartL;
+
+  TEST_ASSERT_EQUAL_INT32(BENCH_AXISES * BENCH_STEPS, StepsL);
+  return (double)TimeL / CLOCKS_PER_SEC / (double)StepsL;
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief Slow move of the firmware limits.
+ *
+ */
+void test_ramp_slow()
+{
+  check_move(500, 100.0F, 75.0F);
+}
+
+/**
+ * @brief Fast move, most of the ramp comes from the recurrence.
+ *
+ */
+void test_ramp_fast()
+{
+  check_move(20000, 5000.0F, 20000.0F);
+}
+
+/**
+ * @brief Backward move.
+ *
+ */
+void test_ramp_backward()
+{
+  check_move(-700, 400.0F, 300.0F);
+}
+
+/**
+ * @brief Aggregate step rate and CPU time of six axises against AccelStepper.
+ *
+ */
+void test_ramp_throughput()
+{
+  const float SPEED = 5000.0F;
+  double TimerL = bench_timer_stepper(SPEED, 20000.0F);
+  double AccelL = bench_accel_stepper(SPEED, 20000.0F);
+  printf("Step engine: %.1f ns/step, %.0f steps/s\n", TimerL * 1e9, 1.0 / TimerL);
+  printf("AccelStepper: %.1f ns/step, %.0f steps/s\n", AccelL * 1e9, 1.0 / AccelL);
+
+  // The idle periods of the interrupt are counted too.
+  TEST_ASSERT_LESS_THAN_FLOAT(BENCH_LOAD, (float)(TimerL * SPEED * BENCH_AXISES));
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_ramp_slow);
+  RUN_TEST(test_ramp_fast);
+  RUN_TEST(test_ramp_backward);
+  RUN_TEST(test_ramp_throughput);
+
+  return UNITY_END();
+}
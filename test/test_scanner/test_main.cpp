@@ -0,0 +1,178 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <unity.h>
+
+#include "InputScanner.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Scans of the debounce.
+ *
+ */
+#define DEBOUNCE_SCANS 4
+
+#pragma endregion // Definitions
+
+#pragma region Functions
+
+/**
+ * @brief Scan the same sample a number of times.
+ *
+ * @param scanner Scanner under the test.
+ * @param sample Active inputs, bit per input.
+ * @param count Number of the scans.
+ * @return uint8_t Inputs changed by the scans, bit per input.
+ */
+static uint8_t update_times(InputScanner &scanner, uint8_t sample, uint8_t count)
+{
+  uint8_t ChangedL = 0;
+  for (uint8_t scan = 0; scan < count; scan++)
+  {
+    ChangedL |= scanner.update(sample);
+  }
+
+  return ChangedL;
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief An input changes on the fourth scan with the new level.
+ *
+ */
+void test_scanner_debounce()
+{
+  InputScanner ScannerL;
+  ScannerL.begin();
+  TEST_ASSERT_EQUAL_UINT8(0, ScannerL.state());
+
+  // Pressed.
+  TEST_ASSERT_EQUAL_UINT8(0, update_times(ScannerL, 0x01, DEBOUNCE_SCANS - 1));
+  TEST_ASSERT_EQUAL_UINT8(0, ScannerL.state());
+  TEST_ASSERT_EQUAL_UINT8(0x01, ScannerL.update(0x01));
+  TEST_ASSERT_EQUAL_UINT8(0x01, ScannerL.state());
+
+  // Held, no change.
+  TEST_ASSERT_EQUAL_UINT8(0, update_times(ScannerL, 0x01, 10));
+  TEST_ASSERT_EQUAL_UINT8(0x01, ScannerL.state());
+
+  // Released.
+  TEST_ASSERT_EQUAL_UINT8(0, update_times(ScannerL, 0x00, DEBOUNCE_SCANS - 1));
+  TEST_ASSERT_EQUAL_UINT8(0x01, ScannerL.state());
+  TEST_ASSERT_EQUAL_UINT8(0x01, ScannerL.update(0x00));
+  TEST_ASSERT_EQUAL_UINT8(0, ScannerL.state());
+}
+
+/**
+ * @brief A scan with the old level starts the count again.
+ *
+ */
+void test_scanner_glitch()
+{
+  InputScanner ScannerL;
+  ScannerL.begin();
+
+  // One sample glitches are ignored.
+  for (uint8_t glitch = 0; glitch < 10; glitch++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(0, ScannerL.update(0x80));
+    TEST_ASSERT_EQUAL_UINT8(0, update_times(ScannerL, 0x00, 2));
+  }
+  TEST_ASSERT_EQUAL_UINT8(0, ScannerL.state());
+
+  // Three scans, a bounce, then four more.
+  TEST_ASSERT_EQUAL_UINT8(0, update_times(ScannerL, 0x80, DEBOUNCE_SCANS - 1));
+  TEST_ASSERT_EQUAL_UINT8(0, ScannerL.update(0x00));
+  TEST_ASSERT_EQUAL_UINT8(0, update_times(ScannerL, 0x80, DEBOUNCE_SCANS - 1));
+  TEST_ASSERT_EQUAL_UINT8(0x80, ScannerL.update(0x80));
+  TEST_ASSERT_EQUAL_UINT8(0x80, ScannerL.state());
+}
+
+/**
+ * @brief Every input counts on its own, the ones of the same scan change together.
+ *
+ */
+void test_scanner_inputs()
+{
+  InputScanner ScannerL;
+  ScannerL.begin();
+
+  // Two inputs from the same scan, a third one a scan later.
+  TEST_ASSERT_EQUAL_UINT8(0, ScannerL.update(0x03));
+  TEST_ASSERT_EQUAL_UINT8(0, update_times(ScannerL, 0x07, DEBOUNCE_SCANS - 2));
+  TEST_ASSERT_EQUAL_UINT8(0x03, ScannerL.update(0x07));
+  TEST_ASSERT_EQUAL_UINT8(0x03, ScannerL.state());
+  TEST_ASSERT_EQUAL_UINT8(0x04, ScannerL.update(0x07));
+  TEST_ASSERT_EQUAL_UINT8(0x07, ScannerL.state());
+
+  // One released while the others are held.
+  TEST_ASSERT_EQUAL_UINT8(0x02, update_times(ScannerL, 0x05, DEBOUNCE_SCANS));
+  TEST_ASSERT_EQUAL_UINT8(0x05, ScannerL.state());
+}
+
+/**
+ * @brief The inputs without a level on the host are released.
+ *
+ */
+void test_scanner_sample()
+{
+  InputScanner ScannerL;
+  ScannerL.setInput(3, 34);
+  ScannerL.setInput(4, 35);
+  ScannerL.setInput(INPUT_SCANNER_INPUTS, 36);
+  ScannerL.begin();
+
+  TEST_ASSERT_EQUAL_UINT8(0, ScannerL.sample());
+  TEST_ASSERT_EQUAL_UINT8(0, ScannerL.state());
+  for (uint8_t scan = 0; scan < (2 * DEBOUNCE_SCANS); scan++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(0, ScannerL.scan());
+  }
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_scanner_debounce);
+  RUN_TEST(test_scanner_glitch);
+  RUN_TEST(test_scanner_inputs);
+  RUN_TEST(test_scanner_sample);
+
+  return UNITY_END();
+}
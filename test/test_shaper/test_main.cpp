@@ -0,0 +1,222 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <unity.h>
+
+#include <math.h>
+
+#include "TimerStepper.h"
+#include "InputShaper.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Step timer period of the firmware. [us]
+ *
+ */
+#define TIMER_PERIOD_US 20
+
+/**
+ * @brief Natural frequency of the modelled joint. [Hz]
+ *
+ */
+#define JOINT_FREQUENCY 4.0F
+
+/**
+ * @brief Damping ratio of the modelled joint.
+ *
+ */
+#define JOINT_DAMPING 0.05F
+
+/**
+ * @brief Simulated time. [s]
+ *
+ */
+#define SIMULATION_TIME 4
+
+/**
+ * @brief Tolerance of the residual vibration. [steps]
+ *
+ */
+#define RESIDUAL_TOLERANCE 0.02F
+
+#pragma endregion // Definitions
+
+#pragma region Variables
+
+/**
+ * @brief Planner of the move.
+ *
+ */
+static TimerStepper *Stepper_g = NULL;
+
+/**
+ * @brief Shaper of the planned steps.
+ *
+ */
+static InputShaper *Shaper_g = NULL;
+
+/**
+ * @brief Position of the motor after the shaper. [steps]
+ *
+ */
+static long Output_g = 0;
+
+#pragma endregion // Variables
+
+#pragma region Functions
+
+/**
+ * @brief Step timer callback, shapes the planned steps.
+ *
+ */
+static void isr_step_timer()
+{
+  bool StepL = Stepper_g->tick();
+  if (Shaper_g->shape(StepL, Stepper_g->dirLevel()))
+  {
+    Output_g += Shaper_g->dirLevel() ? 1 : -1;
+  }
+}
+
+/**
+ * @brief Move 1000 steps and measure the vibration of the joint after the motor stopped.
+ *
+ * The joint is a damped spring mass driven by the motor position.
+ *
+ * @param type Shaper type.
+ * @param frequency Frequency of the shaper. [Hz]
+ * @return float Largest deviation from the target after the stop. [steps]
+ */
+static float residual_vibration(InputShaper::Type type, float frequency)
+{
+  TimerStepper StepperL(TimerStepper::DRIVER, 1, 2);
+  InputShaper ShaperL;
+  Stepper_g = &StepperL;
+  Shaper_g = &ShaperL;
+  Output_g = 0;
+
+  StepTimer::begin(0, TIMER_PERIOD_US, &isr_step_timer);
+  StepperL.setMaxSpeed(800.0F);
+  StepperL.setAcceleration(4000.0F);
+  TEST_ASSERT_TRUE(ShaperL.set(type, frequency, JOINT_DAMPING, StepTimer::frequency()));
+  StepperL.moveTo(1000);
+
+  double W = 2.0 * M_PI * JOINT_FREQUENCY;
+  double DtL = 1.0 / (double)StepTimer::frequency();
+  double PositionL = 0.0;
+  double SpeedL = 0.0;
+  bool StoppedL = false;
+  double ResidualL = 0.0;
+  uint32_t TicksL = SIMULATION_TIME * StepTimer::frequency();
+  for (uint32_t tick = 0; tick < TicksL; tick++)
+  {
+    if ((tick % 50) == 0)
+    {
+      StepperL.run();
+    }
+    StepTimer::simulate(1);
+
+    double AccelerationL = -W * W * (PositionL - (double)Output_g) - 2.0 * JOINT_DAMPING * W * SpeedL;
+    SpeedL += AccelerationL * DtL;
+    PositionL += SpeedL * DtL;
+
+    if (!StoppedL)
+    {
+      StoppedL = !StepperL.isRunning() && !ShaperL.isRunning();
+      continue;
+    }
+    ResidualL = fmax(ResidualL, fabs(PositionL - 1000.0));
+  }
+  StepTimer::end();
+
+  TEST_ASSERT_TRUE(StoppedL);
+  TEST_ASSERT_EQUAL_INT32(1000, Output_g);
+
+  return (float)ResidualL;
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief The joint rings after the trapezoidal move.
+ *
+ */
+void test_shaper_none()
+{
+  TEST_ASSERT_FLOAT_WITHIN(RESIDUAL_TOLERANCE, 4.34F, residual_vibration(InputShaper::NONE, JOINT_FREQUENCY));
+}
+
+/**
+ * @brief ZV shaper on the joint frequency.
+ *
+ */
+void test_shaper_zv()
+{
+  TEST_ASSERT_FLOAT_WITHIN(RESIDUAL_TOLERANCE, 0.17F, residual_vibration(InputShaper::ZV, JOINT_FREQUENCY));
+}
+
+/**
+ * @brief ZVD shaper on the joint frequency.
+ *
+ */
+void test_shaper_zvd()
+{
+  TEST_ASSERT_FLOAT_WITHIN(RESIDUAL_TOLERANCE, 0.23F, residual_vibration(InputShaper::ZVD, JOINT_FREQUENCY));
+}
+
+/**
+ * @brief With 10% error of the frequency ZVD is the robust one.
+ *
+ */
+void test_shaper_frequency_error()
+{
+  float ZvL = residual_vibration(InputShaper::ZV, JOINT_FREQUENCY * 1.1F);
+  float ZvdL = residual_vibration(InputShaper::ZVD, JOINT_FREQUENCY * 1.1F);
+  TEST_ASSERT_FLOAT_WITHIN(RESIDUAL_TOLERANCE, 0.37F, ZvL);
+  TEST_ASSERT_FLOAT_WITHIN(RESIDUAL_TOLERANCE, 0.13F, ZvdL);
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_shaper_none);
+  RUN_TEST(test_shaper_zv);
+  RUN_TEST(test_shaper_zvd);
+  RUN_TEST(test_shaper_frequency_error);
+
+  return UNITY_END();
+}
@@ -0,0 +1,299 @@
+/*
+
+    Robko 01 - ESP32 Control Software
+
+    Copyright (C) [2025] [Orlin Dimitrov]
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <unity.h>
+
+#include <math.h>
+#include <vector>
+
+#include "TimerStepper.h"
+#include "CoordinatedMotion.h"
+#include "PvtStream.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Step timer period of the firmware. [us]
+ *
+ */
+#define TIMER_PERIOD_US 20
+
+/**
+ * @brief Axises of the test.
+ *
+ */
+#define AXISES 2
+
+/**
+ * @brief Window of the measured velocities. [s]
+ *
+ */
+#define WINDOW 0.05
+
+/**
+ * @brief Tolerance of the measured deceleration, part of the acceleration.
+ *
+ */
+#define DECELERATION_TOLERANCE 0.1
+
+#pragma endregion // Definitions
+
+#pragma region Variables
+
+/**
+ * @brief Coordinated move under the test.
+ *
+ */
+static CoordinatedMotion *Coordinated_g = NULL;
+
+/**
+ * @brief Positions of the axises. [steps]
+ *
+ */
+static long Positions_g[AXISES];
+
+/**
+ * @brief Positions of the axises every millisecond. [steps]
+ *
+ */
+static std::vector<long> Track_g[AXISES];
+
+#pragma endregion // Variables
+
+#pragma region Functions
+
+/**
+ * @brief Step timer callback of the coordinated move, as the firmware.
+ *
+ */
+static void isr_coordinated()
+{
+  if (Coordinated_g->tick())
+  {
+    for (uint8_t index = 0; index < AXISES; index++)
+    {
+      if (Coordinated_g->follow(index))
+      {
+        Positions_g[index] += Coordinated_g->forward(index) ? 1 : -1;
+      }
+    }
+  }
+
+  if ((StepTimer::ticks() % (StepTimer::frequency() / 1000)) == 0)
+  {
+    for (uint8_t index = 0; index < AXISES; index++)
+    {
+      Track_g[index].push_back(Positions_g[index]);
+    }
+  }
+}
+
+/**
+ * @brief Clear the positions.
+ *
+ */
+static void clear_track()
+{
+  for (uint8_t index = 0; index < AXISES; index++)
+  {
+    Positions_g[index] = 0;
+    Track_g[index].clear();
+  }
+}
+
+/**
+ * @brief Largest velocity change of the track after the sample.
+ *
+ * The velocities are measured over WINDOW, a step more or less in a window
+ * is an error of 2 / WINDOW^2 in the deceleration.
+ *
+ * @param track Positions every millisecond. [steps]
+ * @param from First sample.
+ * @return double Deceleration. [steps/s^2]
+ */
+static double max_deceleration(const std::vector<long> &track, size_t from)
+{
+  const size_t WINDOW_SAMPLES = (size_t)(WINDOW * 1000.0);
+  double DecelerationL = 0.0;
+  for (size_t index = from; (index + (2 * WINDOW_SAMPLES)) < track.size(); index++)
+  {
+    double FirstL = (double)(track[index + WINDOW_SAMPLES] - track[index]) / WINDOW;
+    double SecondL = (double)(track[index + (2 * WINDOW_SAMPLES)] - track[index + WINDOW_SAMPLES]) / WINDOW;
+    double ChangeL = fabs(SecondL - FirstL) / WINDOW;
+    if (ChangeL > DecelerationL)
+    {
+      DecelerationL = ChangeL;
+    }
+  }
+
+  return DecelerationL;
+}
+
+/**
+ * @brief Check the deceleration of the axis after the stop.
+ *
+ * @param track Positions every millisecond. [steps]
+ * @param from Sample of the stop.
+ * @param acceleration Acceleration of the axis. [steps/s^2]
+ */
+static void check_deceleration(const std::vector<long> &track, size_t from, float acceleration)
+{
+  double LimitL = (acceleration * (1.0 + DECELERATION_TOLERANCE)) + (2.0 / (WINDOW * WINDOW));
+  TEST_ASSERT_LESS_THAN_FLOAT((float)LimitL, (float)max_deceleration(track, from));
+}
+
+#pragma endregion // Functions
+
+#pragma region Tests
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+  StepTimer::end();
+}
+
+/**
+ * @brief The stream stops every axis with its own acceleration.
+ *
+ */
+void test_stop_stream()
+{
+  const int32_t SPEEDS[AXISES] = {4000, -2000};
+  const float ACCELERATIONS[AXISES] = {8000.0F, 2000.0F};
+  PvtStream StreamL;
+  clear_track();
+
+  long StartL[PVT_AXISES] = {0};
+  StreamL.begin(StartL, 1000000UL / TIMER_PERIOD_US);
+  for (uint8_t index = 0; index < AXISES; index++)
+  {
+    StreamL.setAcceleration(index, ACCELERATIONS[index]);
+  }
+  for (uint8_t point = 1; point <= 20; point++)
+  {
+    PvtPoint PointL = {{0}, {0}, PVT_POINT_PERIOD_MS};
+    for (uint8_t index = 0; index < AXISES; index++)
+    {
+      PointL.Position[index] = SPEEDS[index] * PVT_POINT_PERIOD_MS * point / 1000;
+      PointL.Velocity[index] = SPEEDS[index];
+    }
+    TEST_ASSERT_TRUE(StreamL.push(PointL));
+  }
+
+  // Stop in the middle of the points, on the full speed.
+  const uint32_t TICKS_PER_MS = 1000 / TIMER_PERIOD_US;
+  size_t StopL = 0;
+  for (uint32_t tick = 0; tick < (2000 * TICKS_PER_MS); tick++)
+  {
+    if ((tick % TICKS_PER_MS) == 0)
+    {
+      StreamL.update();
+      for (uint8_t index = 0; index < AXISES; index++)
+      {
+        Track_g[index].push_back(Positions_g[index]);
+      }
+      if (tick == (250 * TICKS_PER_MS))
+      {
+        StopL = Track_g[0].size();
+        StreamL.stop();
+      }
+    }
+    if (!StreamL.tick())
+    {
+      continue;
+    }
+    for (uint8_t index = 0; index < AXISES; index++)
+    {
+      if (StreamL.follow(index) == PvtStream::STEP)
+      {
+        Positions_g[index] += StreamL.forward(index) ? 1 : -1;
+      }
+    }
+  }
+  TEST_ASSERT_FALSE(StreamL.isRunning());
+
+  for (uint8_t index = 0; index < AXISES; index++)
+  {
+    check_deceleration(Track_g[index], StopL - (size_t)(2.0 * WINDOW * 1000.0), ACCELERATIONS[index]);
+
+    // From the full speed, v^2 / 2a.
+    float SpeedL = (float)SPEEDS[index];
+    float DistanceL = SpeedL * SpeedL / (2.0F * ACCELERATIONS[index]);
+    float StoppedL = (float)(Positions_g[index] - Track_g[index][StopL - 1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05F * DistanceL, DistanceL, fabsf(StoppedL));
+  }
+}
+
+/**
+ * @brief The coordinated move stops on the path in the limits of every axis.
+ *
+ */
+void test_stop_coordinated()
+{
+  const float ACCELERATIONS[AXISES] = {8000.0F, 2000.0F};
+  CoordinatedMotion MotionL;
+  Coordinated_g = &MotionL;
+  clear_track();
+
+  StepTimer::begin(0, TIMER_PERIOD_US, &isr_coordinated);
+  MotionL.setAxis(0, 20000, 4000.0F, ACCELERATIONS[0]);
+  MotionL.setAxis(1, -8000, 4000.0F, ACCELERATIONS[1]);
+  TEST_ASSERT_TRUE(MotionL.start());
+
+  size_t StopL = 0;
+  for (uint32_t ms = 0; ms < 6000; ms++)
+  {
+    if (ms == 2000)
+    {
+      StopL = Track_g[0].size();
+      MotionL.stop();
+    }
+    MotionL.run();
+    StepTimer::simulate(1000 / TIMER_PERIOD_US);
+  }
+  TEST_ASSERT_FALSE(MotionL.run());
+
+  for (uint8_t index = 0; index < AXISES; index++)
+  {
+    check_deceleration(Track_g[index], StopL - (size_t)(2.0 * WINDOW * 1000.0), ACCELERATIONS[index]);
+  }
+
+  // Stopped before the end, on the path.
+  TEST_ASSERT_TRUE(Positions_g[0] < 20000);
+  TEST_ASSERT_FLOAT_WITHIN(2.0F, -8000.0F / 20000.0F * Positions_g[0], (float)Positions_g[1]);
+}
+
+#pragma endregion // Tests
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_stop_stream);
+  RUN_TEST(test_stop_coordinated);
+
+  return UNITY_END();
+}